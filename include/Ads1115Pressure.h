@@ -0,0 +1,125 @@
+#ifndef ADS1115_PRESSURE_H
+#define ADS1115_PRESSURE_H
+
+#include <Arduino.h>
+#include <Adafruit_I2CDevice.h>
+#include <Adafruit_BusIO_Register.h>
+#include "Config.h"
+#include "PressureMath.h"
+
+// ========================================
+// FRENTE DE PRESIÓN ADS1115 (I2C)
+// ========================================
+// Alternativa al HX710B para máquinas con ruido en los cables del puente:
+// transductor analógico en AIN0 y un ADS1115 en conversión continua. El pin
+// ALERT/RDY pulsa en LOW (~8 µs) al terminar cada conversión y dispara la
+// misma interrupción que DOUT del HX710B. Misma interfaz que HX710B para
+// PressureAcquisition y SensorManager; las lecturas salen en cuentas
+// equivalentes del HX710B (PressureMath::rawFromAds1115).
+//
+// Cada lectura es una sola transacción I2C de 2 bytes: el puntero queda fijo
+// en el registro de conversión y los cambios de configuración se aplican
+// desde la misma tarea que lee, nunca a mitad de otra transacción.
+//
+// Comparación por lectura (test_native_ads1115: los dos drivers reales sobre
+// los modelos de test/mock; el costo del driver I2C es estimado, confirmar
+// en placa con PressureAcquisition::Stats::maxReadUs):
+//                      HX710B (bit-banging)      ADS1115 (I2C 400 kHz)
+//   Tasa de datos      10 / 40 SPS               8 .. 860 SPS (16 / 64 usadas)
+//   Lectura            27 pulsos, 64 µs          29 bits de bus + driver, 112 µs
+//   CPU por lectura    64 µs, 61 µs con IRQ off  40 µs, sin IRQ off (la tarea
+//                                                espera bloqueada el bus)
+//   A 40 / 64 SPS      2.6 ms/s de CPU           2.6 ms/s de CPU
+//   Resolución         24 bits (ruido del puente) 16 bits, 62.5 µV por código
+//                                                (±2.048 V): 0.14 Pa
+
+class Ads1115Pressure {
+public:
+    // Bits DR del registro de configuración
+    enum DataRate : uint8_t {
+        RATE_8_SPS = 0,
+        RATE_16_SPS,
+        RATE_32_SPS,
+        RATE_64_SPS,
+        RATE_128_SPS,
+        RATE_250_SPS,
+        RATE_475_SPS,
+        RATE_860_SPS
+    };
+
+    static constexpr uint32_t periodUs(DataRate rate) {
+        return rate == RATE_8_SPS ? 125000 : rate == RATE_16_SPS ? 62500 :
+               rate == RATE_32_SPS ? 31250 : rate == RATE_64_SPS ? 15625 :
+               rate == RATE_128_SPS ? 7813 : rate == RATE_250_SPS ? 4000 :
+               rate == RATE_475_SPS ? 2105 : 1163;
+    }
+
+    explicit Ads1115Pressure(uint8_t address = SensorConfig::ADS1115_ADDRESS, TwoWire* wire = &Wire);
+
+    // Configura umbrales (modo "conversión lista"), PGA, AIN0 y conversión continua
+    bool begin(uint8_t alertPin, uint8_t sdaPin, uint8_t sclPin, DataRate rate = RATE_16_SPS);
+
+    // Tasa para las próximas conversiones: se escribe en la próxima lectura
+    // (como HX710B::set_mode, que se aplica al leer)
+    void set_data_rate(DataRate rate);
+
+    // ALERT/RDY es un pulso: sin interrupción se decide por tiempo (el
+    // registro de conversión siempre tiene el último resultado)
+    bool is_ready();
+
+    // Lee el registro de conversión (false = error de I2C)
+    bool read_conversion(long& value);
+
+    // Lee solo si hay una conversión nueva; nunca espera
+    bool read_if_ready(long& value);
+
+    // Ventana de promedios (misma semántica que HX710B)
+    bool sampler_add(long value);
+    void set_sampler_window(byte samples = 10);
+    long sampler_average() const { return samplerLast; }
+    bool sampler_ready() const { return samplerValid; }
+    void sampler_reset();
+
+    uint32_t getErrors() const { return errors; }
+
+private:
+    // Registros
+    static constexpr uint8_t REG_CONVERSION = 0x00;
+    static constexpr uint8_t REG_CONFIG = 0x01;
+    static constexpr uint8_t REG_LO_THRESH = 0x02;
+    static constexpr uint8_t REG_HI_THRESH = 0x03;
+
+    // Configuración: AIN0-GND, PGA según el span del transductor, continuo,
+    // comparador en modo "conversión lista" (ALERT activo en LOW tras cada conversión)
+    static constexpr uint16_t CONFIG_MUX_AIN0 = 0x4000;
+    static constexpr uint16_t CONFIG_CONTINUOUS = 0x0000;
+    static constexpr uint16_t CONFIG_QUEUE_1 = 0x0000;
+    static constexpr uint8_t CONFIG_DR_SHIFT = 5;
+
+    // Bits PGA (11:9) del rango elegido en PressureMath::ADS1115_FSR_MV
+    static constexpr uint16_t CONFIG_PGA =
+        PressureMath::ADS1115_FSR_MV == 6144 ? 0x0000 : PressureMath::ADS1115_FSR_MV == 4096 ? 0x0200 :
+        PressureMath::ADS1115_FSR_MV == 2048 ? 0x0400 : PressureMath::ADS1115_FSR_MV == 1024 ? 0x0600 :
+        PressureMath::ADS1115_FSR_MV == 512 ? 0x0800 : 0x0A00;
+
+    TwoWire* bus;
+    Adafruit_I2CDevice device;
+    Adafruit_BusIO_Register configRegister;
+    uint8_t alert;
+
+    volatile uint8_t pendingRate;   // Escrito por SensorManager, aplicado al leer
+    uint8_t currentRate;
+    uint32_t lastReadUs;
+    uint32_t errors;
+
+    // Ventana de promedios
+    byte samplerWindow;
+    byte samplerCount;
+    long samplerSum;
+    long samplerLast;
+    bool samplerValid;
+
+    bool writeConfig(uint8_t rate);
+};
+
+#endif // ADS1115_PRESSURE_H
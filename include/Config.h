@@ -3,6 +3,12 @@
 
 #include <Arduino.h>
 
+// Frente de presión: HX710B (por defecto) o ADS1115 por I2C con
+// PRESSURE_USE_ADS1115=1 en platformio.ini (ver PressureSensor.h)
+#ifndef PRESSURE_USE_ADS1115
+#define PRESSURE_USE_ADS1115 0
+#endif
+
 // ========================================
 // CONFIGURACIÓN DE PINES HARDWARE
 // ========================================
@@ -31,6 +37,11 @@ namespace HardwarePins
     constexpr uint8_t PRESSURE_DOUT = 5;
     constexpr uint8_t PRESSURE_SCLK = 4;
     constexpr uint8_t TEMPERATURE = 23;
+
+    // ADS1115 (PRESSURE_USE_ADS1115): I2C propio; ALERT/RDY va al pin de
+    // DOUT (PRESSURE_DOUT), así la interrupción de adquisición no cambia
+    constexpr uint8_t PRESSURE_SDA = 21;
+    constexpr uint8_t PRESSURE_SCL = 22;
 }
 
 // ========================================
@@ -40,11 +51,40 @@ namespace HardwarePins
 namespace SensorConfig
 {
     // Temperatura DS18B20
-    constexpr uint8_t TEMP_RESOLUTION = 9; // 0.5°C precisión
+    constexpr uint8_t TEMP_RESOLUTION = 9; // 0.5°C precisión (lejos de la consigna o sin consigna)
+
+    // Resolución adaptativa: más bits (conversión más lenta) cerca de la consigna
+    constexpr uint8_t TEMP_RESOLUTION_MID = 11;  // 0.125°C, 375 ms
+    constexpr uint8_t TEMP_RESOLUTION_NEAR = 12; // 0.0625°C, 750 ms
+    constexpr uint8_t TEMP_BAND_MID_C = 6;       // |T - consigna| para 11 bits
+    constexpr uint8_t TEMP_BAND_NEAR_C = 2;      // |T - consigna| para 12 bits
     constexpr uint8_t TEMP_TOLERANCE = 2;  // ±2°C rango de control
+    constexpr bool TEMP_VERIFY_CRC = true; // false = leer solo los 2 bytes de temperatura
+
+    // Alarmas por hardware: TH/TL en el scratchpad de cada DS18B20 y una
+    // búsqueda de alarmas (0xEC) por ronda. Solo el tambor se lee siempre;
+    // los demás sensores se leen si alarman o cada TEMP_SLOW_READ_ROUNDS
+    constexpr uint8_t TEMP_ALARM_MARGIN_C = 10;   // TH = consigna del proceso + margen
+    constexpr int8_t TEMP_ALARM_MAX_C = 95;       // TH del agua sin programa (y tope)
+    constexpr int8_t TEMP_MOTOR_ALARM_C = 80;     // TH de la carcasa del motor
+    constexpr int8_t TEMP_ALARM_LOW_C = -55;      // TL: sin alarma por baja temperatura
+    constexpr uint8_t TEMP_SLOW_READ_ROUNDS = 20; // Lectura de control de los sensores sin alarma
     const uint8_t TEMP_SENSOR_ADDR[8] = {0x28, 0xFF, 0x64, 0x1E, 0x0C, 0x31, 0x18, 0x66};
     // const uint8_t TEMP_SENSOR_ADDR[8] = {0x28, 0xFF, 0x07, 0x03, 0x93, 0x16, 0x04, 0x7A};
 
+    // Sensores DS18B20 del bus (direcciones guardadas en Storage; TEMP_SENSOR_ADDR
+    // es la del tambor en el primer arranque). Las sondas nuevas se asignan a su
+    // puesto desde la página de calibración, calentando la sonda.
+    constexpr uint8_t TEMP_SENSOR_COUNT = 3;
+    enum TempSensorId : uint8_t {
+        TEMP_DRUM = 0,   // Agua del tambor (control del programa)
+        TEMP_INLET = 1,  // Entrada de agua
+        TEMP_MOTOR = 2   // Carcasa del motor
+    };
+    const char* const TEMP_SENSOR_NAMES[TEMP_SENSOR_COUNT] = {"tambor", "entrada", "motor"};
+    constexpr float TEMP_IDENTIFY_RISE_C = 3.0;          // Suba sobre la mínima (mano en la sonda)
+    constexpr uint32_t TEMP_IDENTIFY_TIMEOUT_MS = 120000;
+
     // Sensor de presión HX710B - Calibración MANUAL (sin tare)
     // PASO 1: Con tanque VACÍO, anotar valor pascal() del monitor serial
     // PASO 2: Configurar PRESSURE_OFFSET = valor_vacio
@@ -58,6 +98,124 @@ namespace SensorConfig
     constexpr uint16_t PRESSURE_LEVEL_2 = 63; // 628 - 565 = ~63
     constexpr uint16_t PRESSURE_LEVEL_3 = 80; // 645 - 565 = ~80
     constexpr uint16_t PRESSURE_LEVEL_4 = 98; // 663 - 565 = ~98
+
+    // Muestreo no bloqueante: conversiones promediadas por lectura publicada
+    // (a 10 Hz, 10 muestras = una lectura nueva por segundo)
+    constexpr uint8_t PRESSURE_SAMPLE_WINDOW = 10;
+
+    // Filtro de presión (por muestra): mediana -> EMA -> histéresis por nivel
+    constexpr uint8_t PRESSURE_MEDIAN_SIZE = 5;     // Rechazo de picos (1 = sin mediana, máx. 9)
+    constexpr uint8_t PRESSURE_EMA_SHIFT = 2;       // alpha = 1/2^shift (0 = sin EMA)
+    constexpr uint8_t PRESSURE_LEVEL_HYSTERESIS = 3; // Pa bajo el umbral para bajar de nivel
+
+    // Muestreo sincronizado con la agitación: durante el lavado solo se usan
+    // muestras tomadas tras este tiempo dentro de cada pausa del motor (3 s)
+    constexpr uint16_t SLOSH_SETTLE_MS = 1500;
+
+    // Seguimiento automático del cero (tanque vacío al final del drenaje y
+    // del centrifugado). El offset avanza 1/2^shift del error por drenaje,
+    // limitado por paso y en total; un error grande indica agua remanente.
+    constexpr uint8_t ZERO_TRACK_SHIFT = 2;
+    constexpr int16_t ZERO_TRACK_MAX_STEP_PA = 1;     // Paso máximo por drenaje
+    constexpr int16_t ZERO_TRACK_MAX_ERROR_PA = 20;   // Por encima se descarta (< PRESSURE_LEVEL_1)
+    constexpr int16_t ZERO_TRACK_MAX_OFFSET_PA = 60;  // Corrección total máxima
+    // Término de temperatura opcional (0 = deshabilitado)
+    constexpr int16_t ZERO_TEMP_COEFF_CPA = 0;        // Centésimas de Pa por °C
+    constexpr int8_t ZERO_TEMP_REF_C = 25;
+
+    // Corte predictivo de llenado
+    constexpr uint8_t FILL_RATE_WINDOW = 16;           // Muestras de la regresión (~1.6 s a 10 Hz)
+    constexpr int32_t FILL_MIN_RATE = 1000;            // Cuentas/s mínimas para confiar en la estimación
+    constexpr uint16_t FILL_LATENCY_DEFAULT_MS = 800;  // Latencia válvula + sensado inicial
+    constexpr uint16_t FILL_LATENCY_MIN_MS = 200;      // Límites de la latencia aprendida
+    constexpr uint16_t FILL_LATENCY_MAX_MS = 5000;
+    constexpr uint8_t FILL_CUTOFF_MAX_LEAD_PCT = 50;   // Corte predictivo a menos de medio nivel del objetivo
+    constexpr uint16_t FILL_SETTLE_MS = 5000;          // Espera tras el corte para medir el sobrepaso
+    constexpr uint32_t FILL_MEASURE_WINDOW_MS = 60000; // Sin pausa del motor asentada: no se mide
+    constexpr uint16_t FILL_RATE_MIN_INTERVAL_MS = 90; // Regresión a ~10 Hz aunque el HX710B vaya a 40 Hz
+
+    // Adquisición por interrupción: tarea FreeRTOS dedicada que lee el HX710B
+    // en cada flanco de bajada de DOUT (false = muestreo desde loop())
+    constexpr bool PRESSURE_ACQ_TASK = true;
+#if PRESSURE_USE_ADS1115
+    constexpr uint32_t PRESSURE_SAMPLE_PERIOD_US = 62500;  // ADS1115 a 16 SPS
+    constexpr uint32_t PRESSURE_FAST_PERIOD_US = 15625;    // 64 SPS (Sampling::Profile::pressureFast)
+#else
+    constexpr uint32_t PRESSURE_SAMPLE_PERIOD_US = 100000; // 10 Hz nominal
+    constexpr uint32_t PRESSURE_FAST_PERIOD_US = 25000;    // 40 Hz (Sampling::Profile::pressureFast)
+#endif
+    constexpr uint16_t PRESSURE_QUEUE_SIZE = 32;           // Potencia de 2
+    constexpr uint16_t PRESSURE_TASK_STACK = 2048;
+    constexpr uint8_t PRESSURE_TASK_PRIORITY = 3;
+    constexpr uint8_t PRESSURE_TASK_CORE = 0;              // loop() corre en core 1
+    constexpr uint16_t PRESSURE_TASK_TIMEOUT_MS = 250;     // Reintento si se pierde un flanco
+
+    // Tarea de adquisición con periodo fijo: rondas DS18B20, consumo de la
+    // cola del HX710B y publicación de SensorSnapshot (false = desde loop())
+    constexpr bool SENSOR_TASK = true;
+    constexpr uint16_t SENSOR_TASK_PERIOD_MS = 20;
+    constexpr uint16_t SENSOR_TASK_STACK = 4096;
+    constexpr uint8_t SENSOR_TASK_PRIORITY = 2;            // Debajo de la tarea del HX710B
+    constexpr uint8_t SENSOR_TASK_CORE = 0;
+
+    // Frente ADS1115: transductor analógico en AIN0 (p.ej. MPX5010DP a 5 V:
+    // 0.04 x Vs a 0 Pa, 0.09 x Vs por kPa). Las lecturas se entregan en
+    // cuentas equivalentes del HX710B (PressureMath::rawFromAds1115): el span
+    // de trabajo ocupa un cuarto del rango de 24 bits (PASCAL_ZERO a
+    // PASCAL_ZERO + 250 en pascalFromRaw), así la calibración y el
+    // seguimiento del cero no cambian; los límites de FaultMonitor tienen
+    // sus propios valores (los umbrales PRESSURE_LEVEL_* de fábrica son del
+    // HX710B: calibrar).
+    // La ganancia del PGA sale de la salida máxima del transductor
+    // (PressureMath::ADS1115_FSR_MV).
+    constexpr uint8_t ADS1115_ADDRESS = 0x48;        // ADDR a GND
+    constexpr uint32_t ADS1115_I2C_HZ = 400000;
+    constexpr uint16_t ADS1115_ZERO_MV = 200;        // Salida del transductor a 0 Pa
+    constexpr uint16_t ADS1115_MV_PER_KPA = 450;     // Sensibilidad
+    constexpr uint16_t ADS1115_SPAN_PA = 4000;       // Presión máxima de trabajo (~40 cm de agua)
+
+    // Detección de fallas (FaultMonitor). Las muestras de presión se revisan
+    // todas, antes de la decimación del plan de muestreo. Latencia de peor
+    // caso desde el inicio de la falla hasta el código (+1 ciclo de la tarea,
+    // SENSOR_TASK_PERIOD_MS, y +1 vuelta de loop() hasta STATE_ERROR):
+    //   Presión sin datos    FAULT_PRESSURE_TIMEOUT_MS              = 1.0 s
+    //   Presión fuera rango  FAULT_RANGE_SAMPLES x periodo HX710B   = 300 ms (75 ms a 40 Hz)
+    //   Presión congelada    FAULT_STUCK_SAMPLES x periodo HX710B   = 2.0 s (0.5 s a 40 Hz)
+    //                        (ADS1115: 200 x 62.5 ms                = 12.5 s)
+    //   Presión a saltos     FAULT_RATE_HITS x periodo HX710B       = 400 ms (100 ms a 40 Hz)
+    //   Temp. sin lectura    FAULT_TEMP_ROUNDS x ronda              = 3 x (intervalo + 750 ms)
+    //   Temp. fuera rango    FAULT_RANGE_ROUNDS x ronda             = 2 x (intervalo + 750 ms)
+    //   Temp. a saltos       FAULT_TEMP_RATE_HITS x ronda           = 3 x (intervalo + 750 ms)
+    // En marcha el intervalo más largo es el de MODE_SPIN (5 s): una ronda
+    // tarda como mucho ~5.8 s, 17.3 s sin lectura en el peor caso. En pausa
+    // el monitoreo está detenido y rige MODE_IDLE (10 s): ~10.8 s por ronda,
+    // 32.3 s en el peor caso (con las válvulas cerradas y el motor parado).
+    // No hay prueba de valor congelado para el DS18B20: con el agua estable
+    // una lectura constante es normal; un sensor colgado falla el CRC.
+    constexpr uint32_t FAULT_PRESSURE_TIMEOUT_MS = 1000;  // 10 periodos a 10 Hz
+    constexpr uint8_t FAULT_RANGE_SAMPLES = 3;            // Consecutivas fuera de rango
+#if PRESSURE_USE_ADS1115
+    // Escala de rawFromAds1115: 0 Pa en 500, ADS1115_SPAN_PA en ~750. 0 V en
+    // la entrada (cable cortado) da ~472 y el tope del PGA ~757 (verificado
+    // en FaultMonitor.h)
+    constexpr int16_t FAULT_PRESSURE_MIN_PA = 480;
+    constexpr int16_t FAULT_PRESSURE_MAX_PA = 755;
+    // 16 bits con poco ruido repiten códigos legítimamente; un cable cortado
+    // o el bus I2C caído los detectan el rango y la falta de datos
+    constexpr uint8_t FAULT_STUCK_SAMPLES = 200;
+#else
+    constexpr int16_t FAULT_PRESSURE_MIN_PA = 450;        // Vacío ~565 Pa; saturación en 0 Pa
+    constexpr int16_t FAULT_PRESSURE_MAX_PA = 800;        // Lleno ~663 Pa; saturación en 1000 Pa
+    constexpr uint8_t FAULT_STUCK_SAMPLES = 20;           // Cuentas idénticas consecutivas
+#endif
+    constexpr uint16_t FAULT_MAX_RATE_PA_S = 1000;        // Más que cualquier llenado u oleaje
+    constexpr uint8_t FAULT_RATE_HITS = 4;                // Saltos en las últimas 32 muestras
+    constexpr int8_t FAULT_TEMP_MIN_C = -5;
+    constexpr int8_t FAULT_TEMP_MAX_C = 105;
+    constexpr uint8_t FAULT_TEMP_ROUNDS = 3;              // Rondas seguidas sin lectura válida
+    constexpr uint8_t FAULT_RANGE_ROUNDS = 2;             // Rondas seguidas fuera de rango
+    constexpr uint8_t FAULT_TEMP_MAX_STEP_C = 10;         // Por ronda
+    constexpr uint8_t FAULT_TEMP_RATE_HITS = 3;           // Saltos en las últimas 8 rondas
 }
 
 // ========================================
@@ -87,18 +245,74 @@ namespace Timing
     constexpr uint16_t COOLING_TIME_SEC = 60;         // Tiempo de enfriamiento
     constexpr uint16_t CENTRIFUGE_TIME_SEC = 45;      // Tiempo de centrifugado
     constexpr uint16_t REST_BETWEEN_PROCESS_SEC = 10; // Tiempo de reposo entre tandas (P24)
+    constexpr uint16_t CALIBRATION_FILL_MAX_SEC = 240; // Llenado continuo máximo en calibración
 
-    constexpr uint16_t SENSOR_READ_INTERVAL_MS = 500; // Intervalo de lectura de sensores
+    constexpr uint16_t SENSOR_READ_INTERVAL_MS = 500; // Intervalo de lectura de sensores (por defecto)
     constexpr uint16_t UI_UPDATE_INTERVAL_MS = 1000;  // Intervalo de actualización de UI
 }
 
+// ========================================
+// PLAN DE MUESTREO POR ESTADO
+// ========================================
+// SensorManager sigue el perfil del modo vigente y StateMachine elige el modo
+// según el estado (tabla en StateMachine.cpp). Sin monitoreo se usa
+// MODE_IDLE: un latido lento para que las pantallas fuera de programa no
+// muestren datos viejos.
+
+namespace Sampling
+{
+    enum Mode : uint8_t {
+        MODE_IDLE = 0,      // Fuera de programa (selección, pausa, error...)
+        MODE_FILL,          // Llenado lejos del nivel objetivo
+        MODE_FILL_NEAR,     // Llenado a menos de FILL_NEAR_MS del objetivo
+        MODE_WASH,          // Lavado: nivel estable, importa la temperatura
+        MODE_DRAIN,         // Drenaje: detectar el tanque vacío
+        MODE_SPIN,          // Centrifugado, reposo y enfriamiento
+        MODE_CALIBRATION,   // Captura de puntos de nivel
+        MODE_COUNT
+    };
+
+    struct Profile {
+        bool pressureFast;              // HX710B a 40 Hz (si no, 10 Hz)
+        uint8_t pressureWindow;         // Muestras por publicación de nivel
+        uint16_t pressureIntervalMs;    // Separación mínima entre muestras usadas (0 = todas)
+        uint16_t temperatureIntervalMs; // Entre rondas DS18B20
+    };
+
+    constexpr Profile PROFILES[MODE_COUNT] = {
+        //                      40 Hz  ventana  presión  temperatura
+        /* MODE_IDLE        */ {false,  1,      1000,    10000},  // Latido: nivel a 1 Hz
+        /* MODE_FILL        */ {false, 10,         0,     1000},  // Nivel cada 1 s
+        /* MODE_FILL_NEAR   */ {true,   4,         0,     1000},  // Nivel cada 100 ms
+        /* MODE_WASH        */ {false,  4,       500,      500},  // Nivel cada 2 s
+        /* MODE_DRAIN       */ {false, 10,         0,     2000},
+        /* MODE_SPIN        */ {false,  4,       500,     5000},
+        /* MODE_CALIBRATION */ {false, 10,         0,     5000},
+    };
+
+    constexpr uint32_t FILL_NEAR_MS = 8000;    // ETA de llenado para pasar a MODE_FILL_NEAR
+    constexpr uint16_t RATE_WINDOW_MS = 5000;  // Ventana de medición de las tasas logradas
+}
+
 // ========================================
 // CONFIGURACIÓN NEXTION
 // ========================================
 
 namespace NextionConfig
 {
-    constexpr uint32_t BAUD_RATE = 115200;
+    constexpr uint32_t BAUD_RATE = 115200;  // Velocidad del panel al encender
+
+    // Velocidades a negociar con "baud=" (de mayor a menor, ver NextionBaud.h)
+    constexpr uint32_t BAUD_CANDIDATES[] = {921600, 512000, 256000, 230400};
+    constexpr uint8_t BAUD_PROBES = 3;              // Sondeos seguidos para aceptar una velocidad
+    constexpr uint8_t BAUD_FALLBACK_ATTEMPTS = 3;   // Pedidos de volver a la velocidad anterior
+    constexpr uint32_t BAUD_SETTLE_MS = 20;         // Espera tras cambiar de velocidad
+    constexpr uint32_t PROBE_TIMEOUT_MS = 50;       // Respuesta a "get <nonce>"
+
+    // Enlace en marcha: un panel que se reinicia vuelve a BAUD_RATE (ver NextionBaud::LinkMonitor)
+    constexpr uint32_t LINK_SILENCE_MS = 5000;      // Sin mensajes: sondear a la velocidad actual
+    constexpr uint8_t LINK_LOST_TIMEOUTS = 3;       // Timeouts seguidos de confirmaciones o consultas
+    constexpr uint32_t LINK_RETRY_MS = 30000;       // Panel sin responder: próximo intento
 
     // Colores Nextion (RGB565)
     constexpr uint16_t COLOR_ACTIVE = 1024;    // Color para botón activo/seleccionado
@@ -112,6 +326,28 @@ namespace NextionConfig
     constexpr uint8_t PAGE_EDIT = 3;
     constexpr uint8_t PAGE_ERROR = 4;
     constexpr uint8_t PAGE_EMERGENCY = 5;
+    constexpr uint8_t PAGE_CALIBRATION = 6;
+    constexpr uint8_t PAGE_COUNT = 7;
+
+    // Atributos recordados por página para no reenviar valores sin cambios
+    constexpr uint8_t SHADOW_MAX_COMPONENTS = 32;
+
+    // Trama de TX: página de ejecución completa (~13 comandos) en una escritura
+    constexpr size_t TX_FRAME_SIZE = 512;
+    constexpr size_t MAX_COMMAND_LEN = 128;  // Comando más largo (mensaje de error)
+
+    // Confirmación de comandos (bkcmd=3). Desactivada: bkcmd=0, sin respuestas.
+    constexpr bool ACK_COMMANDS = false;
+    constexpr uint8_t ACK_QUEUE_SIZE = 4;          // Confirmados pendientes
+    constexpr uint8_t ACK_RING_SIZE = 16;          // Escrituras pendientes de respuesta
+    constexpr uint32_t ACK_TIMEOUT_US = 250000;
+    constexpr uint8_t ACK_MAX_RETRIES = 2;
+
+    // Recepción (ver NextionParser.h / NextionQuery.h)
+    constexpr size_t RX_MESSAGE_SIZE = 64;         // Texto más largo de un get
+    constexpr size_t RX_READ_CHUNK = 64;           // Bytes leídos del UART por llamada
+    constexpr uint8_t QUERY_QUEUE_SIZE = 4;        // Consultas get pendientes
+    constexpr uint32_t QUERY_TIMEOUT_US = 100000;
 
     // IDs de botones (página selección)
     constexpr uint8_t BTN_PROGRAM1 = 1;
@@ -119,6 +355,7 @@ namespace NextionConfig
     constexpr uint8_t BTN_PROGRAM3 = 3;
     constexpr uint8_t BTN_START = 22;
     constexpr uint8_t BTN_EDIT = 21;
+    constexpr uint8_t BTN_CALIBRATE = 25;
 
     // IDs de botones (página ejecución)
     constexpr uint8_t BTN_PAUSE = 21;
@@ -142,6 +379,19 @@ namespace NextionConfig
     constexpr uint8_t BTN_PANEL_TIEMPO = 20;
     constexpr uint8_t BTN_PANEL_CENTRIF = 23;
     constexpr uint8_t BTN_PANEL_AGUA = 24;
+
+    // IDs de botones (página calibración)
+    constexpr uint8_t BTN_CAL_MINUS = 2;
+    constexpr uint8_t BTN_CAL_PLUS = 3;
+    constexpr uint8_t BTN_CAL_CAPTURE = 4;
+    constexpr uint8_t BTN_CAL_FILL = 5;
+    constexpr uint8_t BTN_CAL_CLEAR = 6;
+    constexpr uint8_t BTN_CAL_SAVE = 7;
+    constexpr uint8_t BTN_CAL_EXIT = 8;
+    constexpr uint8_t BTN_CAL_TEMP = 9;    // Asignar la sonda del tambor (calentándola)
+
+    // Paso del nivel de referencia en calibración (centésimas de nivel)
+    constexpr uint8_t CAL_STEP_CENTI = 25;
 }
 
 // ========================================
@@ -0,0 +1,162 @@
+#ifndef DS18B20_READER_H
+#define DS18B20_READER_H
+
+#include <Arduino.h>
+#include "OneWireBus.h"
+
+// ========================================
+// LECTURA DS18B20 POR PLAZO (SIN SONDEAR EL BUS)
+// ========================================
+// DallasTemperature::isConversionComplete() lee un time slot del bus (con
+// interrupciones deshabilitadas) en cada llamada. Aquí la conversión se da por
+// terminada por tiempo, según la resolución, y recién entonces se lee el
+// scratchpad: una sola transacción por conversión.
+
+class Ds18b20Reader {
+public:
+    enum ReadResult : uint8_t {
+        READ_OK = 0,
+        READ_NO_DEVICE,   // Sin pulso de presencia
+        READ_CRC_ERROR    // Scratchpad corrupto o bus flotante
+    };
+
+    // Comandos DS18B20
+    static constexpr uint8_t CMD_CONVERT_T = 0x44;
+    static constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
+    static constexpr uint8_t CMD_WRITE_SCRATCHPAD = 0x4E;
+    static constexpr uint8_t SCRATCHPAD_SIZE = 9;
+    static constexpr uint8_t SCRATCHPAD_TEMP_BYTES = 2;
+
+    // Mismos valores que DallasTemperature::millisToWaitForConversion()
+    static constexpr uint16_t conversionTimeMs(uint8_t resolution) {
+        return resolution >= 12 ? 750 :
+               resolution == 11 ? 375 :
+               resolution == 10 ? 188 : 94;
+    }
+
+    // Cuentas de 1/16 °C a grados
+    static float toCelsius(int16_t raw) { return raw * 0.0625f; }
+
+    // Misma condición que el sensor usa para la búsqueda de alarmas: solo la
+    // parte entera (bits 11..4, hacia -inf) contra TH/TL, inclusive
+    static bool isAlarm(int16_t raw, int8_t th, int8_t tl) {
+        int16_t t = raw >> 4;
+        return t >= th || t <= tl;
+    }
+
+    explicit Ds18b20Reader(OneWireBus& bus, uint8_t resolution = 12, bool verifyCrc = true)
+        : bus(bus),
+          resolution(resolution),
+          verifyCrc(verifyCrc),
+          converting(false),
+          conversionStartMs(0) {}
+
+    void setResolution(uint8_t bits) { resolution = bits; }
+    uint8_t getResolution() const { return resolution; }
+
+    // Inicia la conversión en todos los sensores (Skip ROM). No espera.
+    bool startConversion(unsigned long nowMs) {
+        if (!bus.reset()) {
+            converting = false;
+            return false;
+        }
+        bus.skip();
+        bus.write(CMD_CONVERT_T);
+        conversionStartMs = nowMs;
+        converting = true;
+        return true;
+    }
+
+    bool isConverting() const { return converting; }
+    unsigned long getConversionStartMs() const { return conversionStartMs; }
+
+    // true cuando se cumplió el plazo de conversión (no toca el bus)
+    bool conversionDue(unsigned long nowMs) const {
+        return converting && nowMs - conversionStartMs >= conversionTimeMs(resolution);
+    }
+
+    // Fin de la ronda: llamar tras leer todos los sensores de la conversión
+    void cancel() { converting = false; }
+
+    // Lee la temperatura (1/16 °C) del sensor indicado.
+    // Con CRC se leen los 9 bytes (el CRC los cubre a todos); sin CRC solo los
+    // 2 de temperatura y se corta la transacción con un reset.
+    ReadResult readTemperature(const uint8_t* addr, int16_t& raw) {
+        uint8_t data[SCRATCHPAD_SIZE];
+        if (verifyCrc) {
+            ReadResult result = readScratchpad(addr, data);
+            if (result != READ_OK) return result;
+        } else {
+            if (!bus.reset()) return READ_NO_DEVICE;
+            bus.select(addr);
+            bus.write(CMD_READ_SCRATCHPAD);
+            bus.read_bytes(data, SCRATCHPAD_TEMP_BYTES);
+            bus.reset();  // Terminar la lectura sin transferir el resto
+            if (data[0] == 0xFF && data[1] == 0xFF) return READ_CRC_ERROR;
+        }
+
+        // Los bits bajos no definidos a menor resolución se descartan
+        int16_t value = (int16_t)(((uint16_t)data[1] << 8) | data[0]);
+        uint8_t undefinedBits = (resolution < 12) ? (12 - resolution) : 0;
+        raw = value & ~((1 << undefinedBits) - 1);
+        return READ_OK;
+    }
+
+    // Escribe TH, TL y la resolución en el scratchpad del sensor (sin copiar a
+    // EEPROM: no hay espera de 10 ms; se reescribe en cada arranque en frío)
+    bool writeConfig(const uint8_t* addr, int8_t th, int8_t tl, uint8_t bits) {
+        if (!bus.reset()) return false;
+        bus.select(addr);
+        uint8_t data[4] = {CMD_WRITE_SCRATCHPAD, (uint8_t)th, (uint8_t)tl,
+                           (uint8_t)(((bits - 9) << 5) | 0x1F)};
+        bus.write_bytes(data, sizeof(data));
+        return true;
+    }
+
+    // TH, TL y resolución que tiene hoy el sensor
+    bool readConfig(const uint8_t* addr, int8_t& th, int8_t& tl, uint8_t& bits) {
+        uint8_t data[SCRATCHPAD_SIZE];
+        if (readScratchpad(addr, data) != READ_OK) return false;
+        th = (int8_t)data[2];
+        tl = (int8_t)data[3];
+        bits = 9 + ((data[4] >> 5) & 0x03);
+        return true;
+    }
+
+    // Escribe solo si el sensor no tiene ya esa configuración (tras un reinicio
+    // del ESP32 sin corte de alimentación el scratchpad la conserva).
+    // true = hubo escritura.
+    bool updateConfig(const uint8_t* addr, int8_t th, int8_t tl, uint8_t bits) {
+        int8_t currentTh, currentTl;
+        uint8_t currentBits;
+        if (readConfig(addr, currentTh, currentTl, currentBits) &&
+            currentTh == th && currentTl == tl && currentBits == bits) {
+            return false;
+        }
+        return writeConfig(addr, th, tl, bits);
+    }
+
+private:
+    // Los 9 bytes del scratchpad, validados
+    ReadResult readScratchpad(const uint8_t* addr, uint8_t* data) {
+        if (!bus.reset()) return READ_NO_DEVICE;
+        bus.select(addr);
+        bus.write(CMD_READ_SCRATCHPAD);
+        bus.read_bytes(data, SCRATCHPAD_SIZE);
+        // Todo en 0 pasa el CRC: validar también los bits fijos del registro
+        // de configuración (byte 4 = 0b0RR11111)
+        if (OneWireBus::crc8(data, SCRATCHPAD_SIZE - 1) != data[SCRATCHPAD_SIZE - 1] ||
+            (data[4] & 0x9F) != 0x1F) {
+            return READ_CRC_ERROR;
+        }
+        return READ_OK;
+    }
+
+    OneWireBus& bus;
+    uint8_t resolution;
+    bool verifyCrc;
+    bool converting;
+    unsigned long conversionStartMs;
+};
+
+#endif // DS18B20_READER_H
@@ -0,0 +1,177 @@
+#ifndef FAULT_MONITOR_H
+#define FAULT_MONITOR_H
+
+#include <stdint.h>
+#include "Config.h"
+#include "PressureMath.h"
+
+// ========================================
+// DETECCIÓN DE FALLAS DE SENSORES
+// ========================================
+// Pruebas de plausibilidad sobre cada muestra cruda del HX710B y cada ronda
+// del DS18B20 del tambor: rango, valor congelado, velocidad de cambio y
+// ausencia de datos. La primera falla queda retenida hasta reset() (inicio
+// de un programa). Latencias de peor caso documentadas en Config.h.
+
+namespace Fault {
+    enum Code : uint8_t {
+        NONE = 0,
+        PRESSURE_TIMEOUT = 10,  // HX710B sin conversiones (DOUT nunca en LOW)
+        PRESSURE_RANGE = 11,    // Saturado o fuera de la presión física posible
+        PRESSURE_STUCK = 12,    // Cuentas idénticas (sin ruido: línea pegada)
+        PRESSURE_RATE = 13,     // Saltos imposibles repetidos (conexión intermitente)
+        TEMP_TIMEOUT = 20,      // Tambor sin lectura válida (desconectado o CRC)
+        TEMP_RANGE = 21,
+        TEMP_RATE = 22
+    };
+
+    // Texto para NextionUI::showError() (ASCII, con el código)
+    inline const char* describe(Code code) {
+        switch (code) {
+            case PRESSURE_TIMEOUT: return "E10 Presion sin datos";
+            case PRESSURE_RANGE:   return "E11 Presion fuera de rango";
+            case PRESSURE_STUCK:   return "E12 Presion congelada";
+            case PRESSURE_RATE:    return "E13 Presion inestable";
+            case TEMP_TIMEOUT:     return "E20 Sensor temp. sin lectura";
+            case TEMP_RANGE:       return "E21 Temp. fuera de rango";
+            case TEMP_RATE:        return "E22 Temp. inestable";
+            default:               return "Error del sistema";
+        }
+    }
+}
+
+class FaultMonitor {
+public:
+    FaultMonitor() { reset(0); }
+
+    // Borra la falla retenida y el historial (nowUs = inicio del plazo sin datos)
+    void reset(uint32_t nowUs) {
+        fault = Fault::NONE;
+        lastPressureUs = nowUs;
+        hasPressure = false;
+        lastRaw = 0;
+        rangeCount = 0;
+        stuckCount = 0;
+        rateHistory = 0;
+        hasTemperature = false;
+        lastCelsius = 0;
+        invalidRounds = 0;
+        tempRangeRounds = 0;
+        tempRateHistory = 0;
+    }
+
+    Fault::Code getFault() const { return fault; }
+
+    // ----- Presión: cada muestra cruda con la marca de tiempo del flanco -----
+    void checkPressureSample(int32_t raw, uint32_t timestampUs) {
+        // Rango: saturación del ADC o presión imposible para el tanque
+        int32_t pa = PressureMath::pascalFromRaw(raw);
+        bool outOfRange = raw >= RAW_FULL_SCALE || raw <= -RAW_FULL_SCALE ||
+                          pa < SensorConfig::FAULT_PRESSURE_MIN_PA ||
+                          pa > SensorConfig::FAULT_PRESSURE_MAX_PA;
+        rangeCount = outOfRange ? saturatingIncrement(rangeCount) : 0;
+        if (rangeCount >= SensorConfig::FAULT_RANGE_SAMPLES) raise(Fault::PRESSURE_RANGE);
+
+        if (hasPressure) {
+            // Congelado: un ADC de 24 bits sano nunca repite el código tantas veces
+            stuckCount = (raw == lastRaw) ? saturatingIncrement(stuckCount) : 0;
+            if (stuckCount + 1 >= SensorConfig::FAULT_STUCK_SAMPLES) raise(Fault::PRESSURE_STUCK);
+
+            // Velocidad: los picos aislados los absorbe la mediana; varios en
+            // las últimas 32 muestras indican una conexión intermitente
+            uint32_t dtUs = timestampUs - lastPressureUs;
+            int64_t maxDelta = (int64_t)MAX_RATE_COUNTS_PER_S * dtUs / 1000000;
+            int64_t delta = (int64_t)raw - lastRaw;
+            if (delta < 0) delta = -delta;
+            rateHistory = (rateHistory << 1) | (delta > maxDelta ? 1 : 0);
+            if (countBits(rateHistory) >= SensorConfig::FAULT_RATE_HITS) raise(Fault::PRESSURE_RATE);
+        }
+
+        lastRaw = raw;
+        lastPressureUs = timestampUs;
+        hasPressure = true;
+    }
+
+    // Sin muestras durante FAULT_PRESSURE_TIMEOUT_MS (llamar en cada ciclo)
+    void checkPressureTimeout(uint32_t nowUs) {
+        if (nowUs - lastPressureUs > SensorConfig::FAULT_PRESSURE_TIMEOUT_MS * 1000) {
+            raise(Fault::PRESSURE_TIMEOUT);
+        }
+    }
+
+    // ----- Temperatura: una llamada por ronda terminada del bus -----
+    void checkTemperatureRound(bool valid, float celsius) {
+        if (!valid) {
+            invalidRounds = saturatingIncrement(invalidRounds);
+            if (invalidRounds >= SensorConfig::FAULT_TEMP_ROUNDS) raise(Fault::TEMP_TIMEOUT);
+            return;
+        }
+        invalidRounds = 0;
+
+        bool outOfRange = celsius < SensorConfig::FAULT_TEMP_MIN_C ||
+                          celsius > SensorConfig::FAULT_TEMP_MAX_C;
+        tempRangeRounds = outOfRange ? saturatingIncrement(tempRangeRounds) : 0;
+        if (tempRangeRounds >= SensorConfig::FAULT_RANGE_ROUNDS) raise(Fault::TEMP_RANGE);
+
+        if (hasTemperature) {
+            float step = celsius - lastCelsius;
+            if (step < 0) step = -step;
+            tempRateHistory = (tempRateHistory << 1) | (step > SensorConfig::FAULT_TEMP_MAX_STEP_C ? 1 : 0);
+            if (countBits(tempRateHistory) >= SensorConfig::FAULT_TEMP_RATE_HITS) raise(Fault::TEMP_RATE);
+        }
+        lastCelsius = celsius;
+        hasTemperature = true;
+    }
+
+private:
+    static constexpr int32_t RAW_FULL_SCALE = (1L << 23) - 1;
+
+#if PRESSURE_USE_ADS1115
+    // El span completo no es falla; 0 V y el tope del PGA sí
+    static constexpr int16_t SPAN_CODE = (int32_t)PressureMath::ADS1115_MAX_MV * 32768 / PressureMath::ADS1115_FSR_MV;
+    static_assert(PressureMath::pascalFromRaw(PressureMath::rawFromAds1115(SPAN_CODE)) < SensorConfig::FAULT_PRESSURE_MAX_PA &&
+                  PressureMath::pascalFromRaw(PressureMath::rawFromAds1115(INT16_MAX)) > SensorConfig::FAULT_PRESSURE_MAX_PA,
+                  "FAULT_PRESSURE_MAX_PA entre el final del span y el tope del ADS1115");
+    static_assert(PressureMath::pascalFromRaw(PressureMath::rawFromAds1115(0)) < SensorConfig::FAULT_PRESSURE_MIN_PA &&
+                  PressureMath::pascalFromRaw(0) > SensorConfig::FAULT_PRESSURE_MIN_PA,
+                  "FAULT_PRESSURE_MIN_PA entre 0 V y 0 Pa");
+#endif
+    static constexpr int32_t MAX_RATE_COUNTS_PER_S =
+        PressureMath::rawFromPascalDelta(SensorConfig::FAULT_MAX_RATE_PA_S);
+
+    Fault::Code fault;
+
+    // Presión
+    uint32_t lastPressureUs;
+    bool hasPressure;
+    int32_t lastRaw;
+    uint8_t rangeCount;
+    uint8_t stuckCount;       // Repeticiones del último código (muestras iguales - 1)
+    uint32_t rateHistory;     // Bit = salto implausible (últimas 32 muestras)
+
+    // Temperatura
+    bool hasTemperature;
+    float lastCelsius;
+    uint8_t invalidRounds;
+    uint8_t tempRangeRounds;
+    uint8_t tempRateHistory;  // Últimas 8 rondas
+
+    void raise(Fault::Code code) {
+        if (fault == Fault::NONE) fault = code;  // Se retiene la primera
+    }
+
+    static uint8_t saturatingIncrement(uint8_t value) {
+        return (value < UINT8_MAX) ? value + 1 : value;
+    }
+
+    static uint8_t countBits(uint32_t bits) {
+        uint8_t count = 0;
+        while (bits) {
+            bits &= bits - 1;
+            count++;
+        }
+        return count;
+    }
+};
+
+#endif // FAULT_MONITOR_H
@@ -0,0 +1,105 @@
+#ifndef FILL_RATE_ESTIMATOR_H
+#define FILL_RATE_ESTIMATOR_H
+
+#include <stdint.h>
+#include "Config.h"
+
+// ========================================
+// ESTIMADOR DE VELOCIDAD DE LLENADO
+// ========================================
+// Regresión lineal (mínimos cuadrados) sobre las últimas N muestras filtradas
+// de presión (cuentas) y su marca de tiempo. Devuelve la pendiente en cuentas
+// por segundo y el tiempo estimado hasta alcanzar unas cuentas objetivo.
+// Todo entero y con buffer fijo.
+
+class FillRateEstimator {
+public:
+    static constexpr uint8_t WINDOW = SensorConfig::FILL_RATE_WINDOW;
+
+    FillRateEstimator() : index(0), count(0), rate(0) {}
+
+    void add(int32_t raw, uint32_t timestampMs) {
+        ring[index].raw = raw;
+        ring[index].timeMs = timestampMs;
+        index = (index + 1) % WINDOW;
+        if (count < WINDOW) count++;
+        rate = computeRate();
+    }
+
+    void reset() {
+        index = 0;
+        count = 0;
+        rate = 0;
+    }
+
+    // Pendiente en cuentas/s (0 hasta tener la ventana llena)
+    int32_t getRate() const { return rate; }
+    bool isReady() const { return count == WINDOW; }
+
+    // Milisegundos estimados hasta alcanzar targetRaw desde currentRaw.
+    // Devuelve UINT32_MAX si no sube lo suficiente para estimar.
+    uint32_t msToReach(int32_t currentRaw, int32_t targetRaw) const {
+        return estimateMs(isReady() ? rate : 0, currentRaw, targetRaw);
+    }
+
+    // Misma estimación con una pendiente ya publicada (p.ej. en un SensorSnapshot)
+    static uint32_t estimateMs(int32_t rate, int32_t currentRaw, int32_t targetRaw) {
+        if (currentRaw >= targetRaw) return 0;
+        if (rate < SensorConfig::FILL_MIN_RATE) return UINT32_MAX;
+        int64_t ms = ((int64_t)(targetRaw - currentRaw) * 1000) / rate;
+        return (ms > (int64_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)ms;
+    }
+
+    // Corte predictivo: el nivel llega antes de que el cierre tenga efecto
+    // (latencyMs). Nunca a más de maxLeadRaw del objetivo: una latencia o
+    // pendiente equivocada no deja el tanque un nivel por debajo.
+    static bool shouldCutOff(int32_t rate, int32_t currentRaw, int32_t targetRaw,
+                             int32_t maxLeadRaw, uint32_t latencyMs) {
+        if (currentRaw >= targetRaw) return true;
+        if (targetRaw - currentRaw > maxLeadRaw) return false;
+        return estimateMs(rate, currentRaw, targetRaw) <= latencyMs;
+    }
+
+    static uint16_t clampLatency(uint32_t latencyMs) {
+        if (latencyMs < SensorConfig::FILL_LATENCY_MIN_MS) return SensorConfig::FILL_LATENCY_MIN_MS;
+        if (latencyMs > SensorConfig::FILL_LATENCY_MAX_MS) return SensorConfig::FILL_LATENCY_MAX_MS;
+        return (uint16_t)latencyMs;
+    }
+
+private:
+    struct Sample {
+        int32_t raw;
+        uint32_t timeMs;
+    };
+
+    Sample ring[WINDOW];
+    uint8_t index;
+    uint8_t count;
+    int32_t rate;
+
+    int32_t computeRate() const {
+        if (count < 2) return 0;
+
+        // Coordenadas relativas a la muestra más antigua (evita desbordes)
+        uint8_t oldest = (count < WINDOW) ? 0 : index;
+        uint32_t t0 = ring[oldest].timeMs;
+        int32_t x0 = ring[oldest].raw;
+
+        int64_t sumT = 0, sumX = 0, sumTT = 0, sumTX = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            int64_t t = (int32_t)(ring[i].timeMs - t0);
+            int64_t x = ring[i].raw - x0;
+            sumT += t;
+            sumX += x;
+            sumTT += t * t;
+            sumTX += t * x;
+        }
+
+        int64_t den = count * sumTT - sumT * sumT;
+        if (den <= 0) return 0;
+        int64_t num = count * sumTX - sumT * sumX;
+        return (int32_t)((num * 1000) / den);
+    }
+};
+
+#endif // FILL_RATE_ESTIMATOR_H
@@ -24,6 +24,10 @@ public:
     void stopMotor();
     void toggleMotorDirection();  // Alterna izquierda/derecha
 
+    // Estado de agitación (para sincronizar el muestreo de presión)
+    bool isMotorRunning() const { return motorRunning; }
+    bool isMotorSettled(uint16_t settleMs) const;  // En pausa desde hace settleMs o más
+
     // Control de centrifugado
     void startCentrifuge();
     void stopCentrifuge();
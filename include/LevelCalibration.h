@@ -0,0 +1,175 @@
+#ifndef LEVEL_CALIBRATION_H
+#define LEVEL_CALIBRATION_H
+
+#include <stdint.h>
+#include "Config.h"
+#include "PressureMath.h"
+
+// ========================================
+// CALIBRACIÓN DE NIVEL POR TRAMOS (hasta 16 puntos)
+// ========================================
+// Cada punto asocia cuentas crudas filtradas del HX710B con un nivel en
+// centésimas (0..400 = nivel 0.00..4.00). Entre puntos se interpola linealmente;
+// fuera del rango se extrapola con el tramo extremo. Los puntos se capturan en
+// el equipo mientras el tanque se llena y se guardan con Storage.
+
+struct CalibrationPoint {
+    int32_t raw;          // Cuentas filtradas del HX710B
+    uint16_t levelCenti;  // Nivel de referencia x100
+};
+
+class LevelCalibration {
+public:
+    static constexpr uint8_t MAX_POINTS = 16;
+    static constexpr uint16_t MAX_LEVEL_CENTI = Limits::MAX_WATER_LEVEL * 100;
+
+    LevelCalibration() : count(0) {}
+
+    // Puntos equivalentes a las constantes de Config.h (vacío = nivel 0)
+    static LevelCalibration fromConfig() {
+        LevelCalibration cal;
+        const PressureMath::LevelTable& table = PressureMath::DEFAULT_LEVEL_TABLE;
+        cal.addPoint(PressureMath::rawThresholdForPascal(SensorConfig::PRESSURE_OFFSET), 0);
+        for (uint8_t i = 0; i < PressureMath::LEVEL_COUNT; i++) {
+            cal.addPoint(table.raw[i], (i + 1) * 100);
+        }
+        return cal;
+    }
+
+    void clear() { count = 0; }
+    uint8_t size() const { return count; }
+    const CalibrationPoint& point(uint8_t index) const { return points[index]; }
+    const CalibrationPoint* data() const { return points; }
+
+    // Inserta un punto ordenado por cuentas. Un nivel ya capturado se reemplaza.
+    // Devuelve false si la tabla está llena o el punto rompe la monotonía; en
+    // ese caso la tabla (y el punto que se iba a reemplazar) queda intacta.
+    bool addPoint(int32_t raw, uint16_t levelCenti) {
+        uint8_t existing = count;
+        for (uint8_t i = 0; i < count; i++) {
+            if (points[i].levelCenti == levelCenti) {
+                existing = i;
+                break;
+            }
+        }
+        if (existing == count && count >= MAX_POINTS) {
+            return false;
+        }
+
+        uint8_t pos = 0;
+        while (pos < count && points[pos].raw < raw) {
+            pos++;
+        }
+
+        // Vecinos sin contar el punto reemplazado: cuentas y nivel crecen juntos
+        uint8_t next = (pos == existing) ? pos + 1 : pos;
+        int16_t prev = (pos > 0 && pos - 1 == existing) ? pos - 2 : pos - 1;
+        if (next < count && (points[next].raw == raw || points[next].levelCenti <= levelCenti)) {
+            return false;
+        }
+        if (prev >= 0 && points[prev].levelCenti >= levelCenti) {
+            return false;
+        }
+
+        // Mismo nivel: entre los mismos vecinos, el orden no cambia
+        if (existing < count) {
+            points[existing].raw = raw;
+            return true;
+        }
+
+        for (uint8_t i = count; i > pos; i--) {
+            points[i] = points[i - 1];
+        }
+        points[pos].raw = raw;
+        points[pos].levelCenti = levelCenti;
+        count++;
+        return true;
+    }
+
+    // Carga una tabla completa (p.ej. desde Storage); false si no es válida
+    bool load(const CalibrationPoint* source, uint8_t n) {
+        if (n > MAX_POINTS) {
+            return false;
+        }
+        LevelCalibration candidate;
+        for (uint8_t i = 0; i < n; i++) {
+            candidate.points[i] = source[i];
+        }
+        candidate.count = n;
+        if (!candidate.isValid()) {
+            return false;
+        }
+        *this = candidate;
+        return true;
+    }
+
+    // Al menos 2 puntos, cuentas y nivel estrictamente crecientes
+    bool isValid() const {
+        if (count < 2) {
+            return false;
+        }
+        for (uint8_t i = 1; i < count; i++) {
+            if (points[i].raw <= points[i - 1].raw ||
+                points[i].levelCenti <= points[i - 1].levelCenti) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Nivel continuo (x100) para unas cuentas dadas, limitado a 0..MAX_LEVEL_CENTI
+    uint16_t levelCentiFromRaw(int32_t raw) const {
+        if (!isValid()) {
+            return 0;
+        }
+        uint8_t seg = segmentForRaw(raw);
+        const CalibrationPoint& a = points[seg];
+        const CalibrationPoint& b = points[seg + 1];
+        int64_t level = a.levelCenti +
+            ((int64_t)(raw - a.raw) * (b.levelCenti - a.levelCenti)) / (b.raw - a.raw);
+        if (level < 0) return 0;
+        if (level > MAX_LEVEL_CENTI) return MAX_LEVEL_CENTI;
+        return (uint16_t)level;
+    }
+
+    // Cuentas mínimas para alcanzar un nivel (inversa de levelCentiFromRaw)
+    int32_t rawForLevelCenti(uint16_t levelCenti) const {
+        uint8_t seg = 0;
+        while (seg + 2 < count && points[seg + 1].levelCenti < levelCenti) {
+            seg++;
+        }
+        const CalibrationPoint& a = points[seg];
+        const CalibrationPoint& b = points[seg + 1];
+        int64_t num = (int64_t)((int32_t)levelCenti - a.levelCenti) * (b.raw - a.raw);
+        int32_t den = b.levelCenti - a.levelCenti;
+        // Redondeo hacia arriba: el nivel entero se alcanza en esa cuenta o después
+        int64_t offset = (num >= 0) ? (num + den - 1) / den : -((-num) / den);
+        return (int32_t)(a.raw + offset);
+    }
+
+    // Umbrales enteros (niveles 1..4) para la histéresis de PressureFilter
+    bool buildLevelTable(PressureMath::LevelTable& table) const {
+        if (!isValid()) {
+            return false;
+        }
+        for (uint8_t i = 0; i < PressureMath::LEVEL_COUNT; i++) {
+            table.raw[i] = rawForLevelCenti((i + 1) * 100);
+        }
+        return true;
+    }
+
+private:
+    CalibrationPoint points[MAX_POINTS];
+    uint8_t count;
+
+    // Tramo [seg, seg+1] que contiene raw (o el extremo para extrapolar)
+    uint8_t segmentForRaw(int32_t raw) const {
+        uint8_t seg = 0;
+        while (seg + 2 < count && points[seg + 1].raw <= raw) {
+            seg++;
+        }
+        return seg;
+    }
+};
+
+#endif // LEVEL_CALIBRATION_H
@@ -0,0 +1,373 @@
+#ifndef NEXTION_ACK_QUEUE_H
+#define NEXTION_ACK_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Config.h"
+
+// ========================================
+// COLA DE COMANDOS CONFIRMADOS (bkcmd=3)
+// ========================================
+// Con bkcmd=3 el Nextion responde a cada comando, en orden, con 0x01 (éxito)
+// o un código de error. Cada escritura al UART queda en un anillo, en orden:
+//   - tramas sin confirmación: solo la cantidad de comandos; no se guardan
+//     ni se espera por ellas (salen como siempre)
+//   - comandos confirmados: copia del texto (acotados a ACK_QUEUE_SIZE)
+//     hasta su respuesta
+// Con el anillo lleno, los comandos sin confirmación que siguen se cuentan
+// aparte y entran como una trama en cuanto se libera un lugar: ninguna
+// respuesta queda sin escritura y las de los confirmados no se corren.
+// Respuesta de un confirmado:
+//   0x01           confirmado
+//   0x24           buffer del panel lleno: se reintenta
+//   0x1A, 0x1B...  variable u operación inválida: se descarta (no mejora
+//                  reintentando)
+//   sin respuesta  en ACK_TIMEOUT_US se reintenta todo lo pendiente
+// Un reintento se descarta si ya se envió un comando más nuevo al mismo
+// atributo (no se vuelve a "page 2" después de "page 4"). La latencia se
+// mide desde cada escritura hasta la respuesta a su último comando.
+
+namespace NextionReturn {
+    constexpr uint8_t INVALID_INSTRUCTION = 0x00;
+    constexpr uint8_t SUCCESS = 0x01;
+    constexpr uint8_t INVALID_COMPONENT = 0x02;
+    constexpr uint8_t INVALID_PAGE = 0x03;
+    constexpr uint8_t INVALID_VARIABLE = 0x1A;
+    constexpr uint8_t INVALID_OPERATION = 0x1B;
+    constexpr uint8_t ASSIGNMENT_FAILED = 0x1C;
+    constexpr uint8_t INVALID_QUANTITY = 0x1E;
+    constexpr uint8_t INVALID_ESCAPE = 0x20;
+    constexpr uint8_t NAME_TOO_LONG = 0x23;
+    constexpr uint8_t BUFFER_OVERFLOW = 0x24;
+
+    // Respuesta de bkcmd (éxito o error de un comando)
+    inline bool isCommandResult(uint8_t code) {
+        return code <= INVALID_PAGE || (code >= INVALID_VARIABLE && code <= BUFFER_OVERFLOW);
+    }
+
+    // Errores que pueden no repetirse al reenviar
+    inline bool isTransient(uint8_t code) {
+        return code == BUFFER_OVERFLOW;
+    }
+}
+
+// Histograma de latencias en pasos de WIDTH_US (el último cubre el resto)
+class LatencyHistogram {
+public:
+    static constexpr uint32_t WIDTH_US = 250;
+    static constexpr uint8_t BUCKETS = 64;  // Hasta 16 ms
+
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        memset(counts, 0, sizeof(counts));
+        total = 0;
+        maxUs = 0;
+    }
+
+    void add(uint32_t us) {
+        uint32_t bucket = us / WIDTH_US;
+        counts[bucket < BUCKETS ? bucket : BUCKETS]++;
+        total++;
+        if (us > maxUs) maxUs = us;
+    }
+
+    // Cota superior del percentil (1..100), nunca mayor que el máximo medido
+    uint32_t percentileUs(uint8_t percent) const {
+        if (total == 0) return 0;
+        uint32_t target = (total * percent + 99) / 100;
+        if (target == 0) target = 1;
+
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= target) {
+                uint32_t upper = (i + 1) * WIDTH_US;
+                return upper < maxUs ? upper : maxUs;
+            }
+        }
+        return maxUs;
+    }
+
+    uint32_t count() const { return total; }
+    uint32_t max() const { return maxUs; }
+
+private:
+    uint32_t counts[BUCKETS + 1];
+    uint32_t total;
+    uint32_t maxUs;
+};
+
+class NextionAckQueue {
+public:
+    static constexpr uint8_t CAPACITY = NextionConfig::ACK_QUEUE_SIZE;
+    static constexpr uint8_t RING_SIZE = NextionConfig::ACK_RING_SIZE;
+    static constexpr size_t MAX_COMMAND = NextionConfig::MAX_COMMAND_LEN;
+
+    struct Stats {
+        uint32_t acked;          // Confirmados con 0x01
+        uint32_t retries;        // Reenvíos (0x24 o sin respuesta)
+        uint32_t dropped;        // Descartados (error permanente, sin reintentos o reemplazados)
+        uint32_t timeouts;       // Respuestas que no llegaron
+        uint32_t rejected;       // Cola llena al enviar
+        uint32_t plainErrors;    // Errores de comandos sin confirmación
+        uint32_t unexpected;     // Respuestas sin comando pendiente
+        uint32_t deferred;       // Tramas escritas con el anillo lleno
+        uint8_t lastError;       // Último código de error recibido
+    };
+
+    NextionAckQueue() { reset(); }
+
+    void reset() {
+        head = 0;
+        count = 0;
+        retryMask = 0;
+        untracked = 0;
+        sequence = 0;
+        lastProgressUs = 0;
+        memset(&stats, 0, sizeof(stats));
+        latency.reset();
+        for (uint8_t i = 0; i < CAPACITY; i++) slots[i].used = false;
+    }
+
+    // Trama de comandos sin confirmación escrita al UART
+    void trackPlain(uint16_t commands, uint32_t nowUs) {
+        if (commands == 0) return;
+        if (count == 0) lastProgressUs = nowUs;
+
+        // Anillo lleno: se suma a la última trama (sin muestra de latencia)
+        if (count == RING_SIZE) {
+            Entry& tail = at(count - 1);
+            if (tail.slot == PLAIN) {
+                tail.remaining += commands;
+                tail.sampled = false;
+                return;
+            }
+        }
+        if (count < RING_SIZE) {
+            push({PLAIN, commands, true, nowUs});
+            return;
+        }
+        // Anillo lleno con un confirmado al final: se agrega al liberarse un lugar
+        stats.deferred++;
+        untracked = (untracked > UINT16_MAX - commands) ? UINT16_MAX : untracked + commands;
+    }
+
+    // true si hay lugar para un comando confirmado (y la trama que lo precede)
+    bool canTrackAcked() const {
+        return freeSlot() < CAPACITY && count < RING_SIZE - 1;
+    }
+
+    // Comando confirmado escrito al UART (len sin terminador). false = cola
+    // llena o demasiado largo: enviarlo sin confirmación.
+    bool trackAcked(const char* cmd, size_t len, uint32_t nowUs) {
+        uint8_t slot = freeSlot();
+        if (len > MAX_COMMAND || slot == CAPACITY || count == RING_SIZE) {
+            stats.rejected++;
+            return false;
+        }
+
+        memcpy(slots[slot].cmd, cmd, len);
+        slots[slot].len = (uint8_t)len;
+        slots[slot].attempts = 0;
+        slots[slot].sequence = ++sequence;
+        slots[slot].used = true;
+
+        // Reintentos pendientes del mismo atributo: quedaron viejos
+        for (uint8_t i = 0; i < CAPACITY; i++) {
+            if ((retryMask & (1u << i)) && sameKey(i, slot)) {
+                retryMask &= ~(1u << i);
+                slots[i].used = false;
+                stats.dropped++;
+            }
+        }
+
+        if (count == 0) lastProgressUs = nowUs;
+        push({slot, 1, true, nowUs});
+        return true;
+    }
+
+    // Respuesta de bkcmd recibida. true si se perdió un comando por un error
+    // transitorio (0x24 de uno sin confirmación, o confirmado sin más
+    // reintentos): reenviar los valores puede arreglarlo. Los errores
+    // permanentes (componente inexistente) se repetirían igual.
+    bool onReturn(uint8_t code, uint32_t nowUs) {
+        lastProgressUs = nowUs;
+        if (code != NextionReturn::SUCCESS) stats.lastError = code;
+
+        if (count == 0) {
+            stats.unexpected++;
+            return false;
+        }
+
+        Entry& entry = at(0);
+        if (entry.slot == PLAIN) {
+            bool lost = NextionReturn::isTransient(code);
+            if (code != NextionReturn::SUCCESS) stats.plainErrors++;
+            if (--entry.remaining == 0) {
+                if (entry.sampled) latency.add(nowUs - entry.sentUs);
+                pop();
+            }
+            return lost;
+        }
+
+        uint8_t slot = entry.slot;
+        bool lost = false;
+        if (code == NextionReturn::SUCCESS) {
+            latency.add(nowUs - entry.sentUs);
+            stats.acked++;
+            slots[slot].used = false;
+        } else {
+            bool transient = NextionReturn::isTransient(code);
+            lost = !settle(slot, transient) && transient;
+        }
+        pop();
+        return lost;
+    }
+
+    // Sin respuestas durante ACK_TIMEOUT_US: se perdieron. Los confirmados
+    // se reintentan (o descartan) y se vuelve a sincronizar desde cero.
+    // true si hubo timeout (los comandos sin confirmación pudieron perderse).
+    bool checkTimeout(uint32_t nowUs) {
+        if (count == 0 || nowUs - lastProgressUs < NextionConfig::ACK_TIMEOUT_US) {
+            return false;
+        }
+        stats.timeouts++;
+        resynchronize();
+        return true;
+    }
+
+    // Nada de lo pendiente va a tener respuesta (timeout o panel reiniciado):
+    // los confirmados se reintentan (o descartan) y se empieza desde cero
+    void resynchronize() {
+        untracked = 0;
+        while (count > 0) {
+            if (at(0).slot != PLAIN) settle(at(0).slot, true);
+            pop();
+        }
+    }
+
+    // Próximo comando a reenviar (false = ninguno). Al escribirlo, trackResent().
+    bool nextRetry(const char*& cmd, size_t& len, uint8_t& slot) const {
+        if (count == RING_SIZE) return false;
+        for (uint8_t i = 0; i < CAPACITY; i++) {
+            if (retryMask & (1u << i)) {
+                cmd = slots[i].cmd;
+                len = slots[i].len;
+                slot = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void trackResent(uint8_t slot, uint32_t nowUs) {
+        retryMask &= ~(1u << slot);
+        stats.retries++;
+        if (count == 0) lastProgressUs = nowUs;
+        push({slot, 1, true, nowUs});
+    }
+
+    bool hasPending() const { return count > 0; }
+    uint8_t pendingWrites() const { return count; }
+    const Stats& getStats() const { return stats; }
+    const LatencyHistogram& getLatency() const { return latency; }
+
+private:
+    static constexpr uint8_t PLAIN = 0xFF;
+
+    struct Slot {
+        char cmd[MAX_COMMAND];
+        uint8_t len;
+        uint8_t attempts;
+        uint32_t sequence;
+        bool used;
+    };
+
+    // Escritura al UART pendiente de respuesta
+    struct Entry {
+        uint8_t slot;          // PLAIN = trama sin confirmación
+        uint16_t remaining;    // Respuestas que faltan
+        bool sampled;          // Medir latencia al completarse
+        uint32_t sentUs;
+    };
+
+    static_assert(CAPACITY <= 8, "retryMask es de 8 bits");
+    static_assert(MAX_COMMAND <= 255, "Slot::len es de 8 bits");
+
+    Slot slots[CAPACITY];
+    Entry ring[RING_SIZE];
+    uint8_t head;
+    uint8_t count;
+    uint8_t retryMask;
+    uint16_t untracked;        // Comandos sin confirmación que no entraron al anillo
+    uint32_t sequence;
+    uint32_t lastProgressUs;
+    Stats stats;
+    LatencyHistogram latency;
+
+    Entry& at(uint8_t index) { return ring[(head + index) % RING_SIZE]; }
+
+    void push(const Entry& entry) {
+        ring[(head + count) % RING_SIZE] = entry;
+        count++;
+    }
+
+    // untracked > 0 solo con el anillo lleno: entra detrás de todo lo pendiente
+    void pop() {
+        head = (head + 1) % RING_SIZE;
+        count--;
+        if (untracked > 0) {
+            push({PLAIN, untracked, false, 0});
+            untracked = 0;
+        }
+    }
+
+    uint8_t freeSlot() const {
+        for (uint8_t i = 0; i < CAPACITY; i++) {
+            if (!slots[i].used) return i;
+        }
+        return CAPACITY;
+    }
+
+    // Atributo del comando: "t0.txt=", "tsw 24," o la instrucción ("page")
+    static size_t keyLength(const Slot& slot) {
+        const char* eq = static_cast<const char*>(memchr(slot.cmd, '=', slot.len));
+        if (eq != nullptr) return eq - slot.cmd;
+        for (size_t i = slot.len; i > 0; i--) {
+            if (slot.cmd[i - 1] == ',') return i - 1;
+        }
+        const char* space = static_cast<const char*>(memchr(slot.cmd, ' ', slot.len));
+        return space != nullptr ? (size_t)(space - slot.cmd) : slot.len;
+    }
+
+    bool sameKey(uint8_t a, uint8_t b) const {
+        size_t len = keyLength(slots[a]);
+        return len == keyLength(slots[b]) && memcmp(slots[a].cmd, slots[b].cmd, len) == 0;
+    }
+
+    // Hay un confirmado más nuevo para el mismo atributo
+    bool superseded(uint8_t slot) const {
+        for (uint8_t i = 0; i < CAPACITY; i++) {
+            if (i != slot && slots[i].used && slots[i].sequence > slots[slot].sequence && sameKey(i, slot)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Error o sin respuesta: reintentar si se puede (true), si no descartar
+    bool settle(uint8_t slot, bool retry) {
+        if (retry && slots[slot].attempts < NextionConfig::ACK_MAX_RETRIES && !superseded(slot)) {
+            slots[slot].attempts++;
+            retryMask |= (1u << slot);
+            return true;
+        }
+        slots[slot].used = false;
+        stats.dropped++;
+        return false;
+    }
+};
+
+#endif // NEXTION_ACK_QUEUE_H
@@ -0,0 +1,461 @@
+#ifndef NEXTION_BAUD_H
+#define NEXTION_BAUD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Config.h"
+#include "NextionFormat.h"
+
+// ========================================
+// NEGOCIACIÓN DE VELOCIDAD CON EL NEXTION
+// ========================================
+// El panel arranca a NextionConfig::BAUD_RATE. "baud=N" cambia la velocidad
+// hasta que se apaga (no se graba en el panel, a diferencia de "bauds=").
+// Cada cambio se confirma con un sondeo de ida y vuelta: "get <nonce>" debe
+// volver como 0x71 + nonce (4 bytes LE) + FF FF FF, bytes exactos. Si no
+// vuelve, se pide la velocidad anterior y se prueba la siguiente más baja.
+//
+// Con una velocidad guardada (Storage) no se recorre la escalera:
+//   - arranque en caliente (el panel no se apagó): un sondeo a la guardada
+//   - el panel se reinició: un sondeo a BAUD_RATE y un cambio a la guardada
+//
+// En marcha, un panel que se reinicia (alimentación, watchdog) vuelve a
+// BAUD_RATE y a la velocidad negociada no llega nada legible, ni su 0x88.
+// LinkMonitor decide cuándo sondear y LinkRecovery lo vuelve a buscar desde
+// BAUD_RATE sin bloquear el loop.
+
+namespace NextionBaud {
+
+// Respuesta esperada a "get <nonce>", byte a byte
+class ProbeMatcher {
+public:
+    explicit ProbeMatcher(uint32_t value) : nonce(value), matched(0) {}
+
+    // true al completar la respuesta
+    bool feed(uint8_t byte) {
+        if (byte == expected(matched)) {
+            if (++matched == LENGTH) {
+                matched = 0;
+                return true;
+            }
+            return false;
+        }
+        // El nonce no tiene 0x71 ni 0xFF: solo puede reiniciar en 0x71
+        matched = (byte == 0x71) ? 1 : 0;
+        return false;
+    }
+
+private:
+    static constexpr uint8_t LENGTH = 8;
+    uint32_t nonce;
+    uint8_t matched;
+
+    uint8_t expected(uint8_t index) const {
+        if (index == 0) return 0x71;
+        if (index <= 4) return (uint8_t)(nonce >> (8 * (index - 1)));
+        return 0xFF;
+    }
+};
+
+// Nonce con bytes en 0x20..0x6F (sin 0x71 ni 0xFF, positivo como int32)
+inline uint32_t makeNonce(uint32_t seed) {
+    uint32_t nonce = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        seed = seed * 1103515245u + 12345u;
+        nonce |= (uint32_t)(0x20 + (seed >> 16) % 0x50) << (8 * i);
+    }
+    return nonce;
+}
+
+inline bool isCandidate(uint32_t baud) {
+    if (baud == NextionConfig::BAUD_RATE) return true;
+    for (uint32_t candidate : NextionConfig::BAUD_CANDIDATES) {
+        if (baud == candidate) return true;
+    }
+    return false;
+}
+
+// Enlace a revisar: LINK_LOST_TIMEOUTS timeouts seguidos (confirmaciones o
+// consultas) o ningún mensaje del panel en silenceMs. Con bkcmd=0 y sin
+// toques el silencio es normal: el sondeo a la velocidad actual lo descarta.
+class LinkMonitor {
+public:
+    LinkMonitor() { reset(0); }
+
+    void reset(uint32_t nowMs, uint32_t silence = NextionConfig::LINK_SILENCE_MS) {
+        lastMessageMs = nowMs;
+        silenceMs = silence;
+        timeouts = 0;
+    }
+
+    void onMessage(uint32_t nowMs) {
+        lastMessageMs = nowMs;
+        timeouts = 0;
+    }
+
+    void onTimeout() {
+        if (timeouts < UINT8_MAX) timeouts++;
+    }
+
+    bool needsCheck(uint32_t nowMs) const {
+        return timeouts >= NextionConfig::LINK_LOST_TIMEOUTS || nowMs - lastMessageMs >= silenceMs;
+    }
+
+private:
+    uint32_t lastMessageMs;
+    uint32_t silenceMs;
+    uint8_t timeouts;
+};
+
+// Link: setBaud(uint32_t) (cambia el UART propio), sendCommand(const char*)
+// y probe() (sondeo de ida y vuelta a la velocidad actual).
+template <class Link>
+class Negotiator {
+public:
+    explicit Negotiator(Link& l) : link(l), current(0) {}
+
+    // Velocidad final; 0 si el panel no respondió (el UART queda en BAUD_RATE)
+    uint32_t run(uint32_t savedBaud) {
+        bool saved = isCandidate(savedBaud);
+
+        // Arranque en caliente: el panel sigue a la velocidad guardada
+        if (saved && savedBaud != NextionConfig::BAUD_RATE && tryRate(savedBaud)) {
+            return current;
+        }
+
+        // Panel recién encendido (o a alguna velocidad de una negociación previa)
+        if (!tryRate(NextionConfig::BAUD_RATE) && !scan()) {
+            link.setBaud(NextionConfig::BAUD_RATE);
+            return 0;
+        }
+
+        // Velocidad ya negociada antes: sin escalera
+        if (saved && (current == savedBaud || switchTo(savedBaud))) {
+            return current;
+        }
+
+        for (uint32_t candidate : NextionConfig::BAUD_CANDIDATES) {
+            if (current == 0 || candidate <= current) break;
+            if (candidate != savedBaud && switchTo(candidate)) {
+                return current;
+            }
+        }
+
+        if (current == 0) {
+            link.setBaud(NextionConfig::BAUD_RATE);
+        }
+        return current;
+    }
+
+private:
+    Link& link;
+    uint32_t current;
+
+    bool tryRate(uint32_t baud) {
+        link.setBaud(baud);
+        if (!confirm()) return false;
+        current = baud;
+        return true;
+    }
+
+    // Varios sondeos seguidos: una velocidad al límite falla alguno
+    bool confirm() {
+        for (uint8_t i = 0; i < NextionConfig::BAUD_PROBES; i++) {
+            if (!link.probe()) return false;
+        }
+        return true;
+    }
+
+    bool switchTo(uint32_t baud) {
+        uint32_t previous = current;
+        sendBaud(baud);
+        if (tryRate(baud)) {
+            return true;
+        }
+
+        // Volver: el pedido puede llegar mal a la velocidad nueva, se repite
+        for (uint8_t i = 0; i < NextionConfig::BAUD_FALLBACK_ATTEMPTS; i++) {
+            sendBaud(previous);
+            if (tryRate(previous)) {
+                return false;
+            }
+            link.setBaud(baud);
+        }
+
+        // El panel quedó inalcanzable: buscarlo en todas las velocidades
+        current = 0;
+        scan();
+        return false;
+    }
+
+    bool scan() {
+        if (tryRate(NextionConfig::BAUD_RATE)) return true;
+        for (uint32_t candidate : NextionConfig::BAUD_CANDIDATES) {
+            if (tryRate(candidate)) return true;
+        }
+        return false;
+    }
+
+    void sendBaud(uint32_t baud) {
+        char cmd[16];
+        NextionFormat::Writer writer(cmd, sizeof(cmd));
+        writer.text("baud=").number(baud);
+        link.sendCommand(writer.c_str());
+    }
+};
+
+template <class Link>
+uint32_t negotiate(Link& link, uint32_t savedBaud) {
+    Negotiator<Link> negotiator(link);
+    return negotiator.run(savedBaud);
+}
+
+// Revisión del enlace en marcha, un paso por llamada a update(): cambiar de
+// velocidad, enviar un sondeo o mirar si volvió. BAUD_SETTLE_MS y
+// PROBE_TIMEOUT_MS se miden con marcas de tiempo, sin esperas. Los bytes
+// recibidos pasan por feed(); solo la respuesta al sondeo es suya, el resto
+// sigue al parser.
+//
+// Primero un sondeo a la velocidad del enlace (el silencio puede ser
+// normal). Si no vuelve, el panel se busca desde BAUD_RATE y se sube a esa
+// velocidad (o por la escalera si nunca respondió), con los mismos
+// sondeos y vueltas atrás que Negotiator.
+//
+// Link: setBaud(uint32_t) sin espera y sendCommand(const char*).
+class LinkRecovery {
+public:
+    enum Result : uint8_t {
+        BUSY,    // Seguir llamando a update()
+        LINKED,  // Panel a getBaud()
+        LOST     // Sin respuesta: el UART queda en BAUD_RATE
+    };
+
+    LinkRecovery()
+        : matcher(0), phase(IDLE), step(BEGIN), target(0), current(0), trying(0),
+          switching(0), previous(0), index(0), attempts(0), probesOk(0), probesNeeded(0),
+          targetTried(false), replied(false), stepMs(0), seed(0) {}
+
+    bool isActive() const { return phase != IDLE; }
+
+    // El UART no está a la velocidad del enlace: lo que se envíe se pierde
+    bool isSearching() const { return phase != IDLE && phase != CHECK; }
+
+    uint32_t getBaud() const { return current; }
+
+    // baud = velocidad del enlace (0 = el panel no respondió: buscarlo)
+    void start(uint32_t baud, uint32_t nowMs) {
+        target = isCandidate(baud) ? baud : 0;
+        current = 0;
+        phase = (target != 0) ? CHECK : FIND;
+        step = BEGIN;
+        seed += nowMs;
+    }
+
+    // true si el byte completa la respuesta al sondeo (no es del parser)
+    bool feed(uint8_t byte) {
+        if (phase == IDLE || step != WAIT || !matcher.feed(byte)) return false;
+        replied = true;
+        return true;
+    }
+
+    template <class Link>
+    Result update(Link& link, uint32_t nowMs) {
+        switch (step) {
+            case BEGIN:
+                if (phase == CHECK) {
+                    trying = target;
+                    probesNeeded = 1;
+                    probesOk = 0;
+                    sendProbe(link, nowMs);
+                } else {
+                    find(link, nowMs);
+                }
+                return BUSY;
+
+            case SETTLE:
+                if (nowMs - stepMs >= NextionConfig::BAUD_SETTLE_MS) {
+                    sendProbe(link, nowMs);
+                }
+                return BUSY;
+
+            case WAIT:
+                if (replied) {
+                    replied = false;
+                    if (++probesOk < probesNeeded) {
+                        sendProbe(link, nowMs);
+                        return BUSY;
+                    }
+                    return onRate(link, true, nowMs);
+                }
+                if (nowMs - stepMs < NextionConfig::PROBE_TIMEOUT_MS) return BUSY;
+                return onRate(link, false, nowMs);
+        }
+        return BUSY;
+    }
+
+private:
+    enum Phase : uint8_t {
+        IDLE,
+        CHECK,     // Un sondeo a la velocidad del enlace
+        FIND,      // BAUD_RATE y después cada candidata
+        SWITCH,    // "baud=" pedido, sondeos a la nueva
+        FALLBACK   // La nueva falló: pedir la anterior
+    };
+    enum Step : uint8_t { BEGIN, SETTLE, WAIT };
+
+    static constexpr uint8_t CANDIDATE_COUNT =
+        sizeof(NextionConfig::BAUD_CANDIDATES) / sizeof(NextionConfig::BAUD_CANDIDATES[0]);
+
+    ProbeMatcher matcher;
+    Phase phase;
+    Step step;
+    uint32_t target;     // Velocidad del enlace al empezar (0 = escalera)
+    uint32_t current;    // Última confirmada
+    uint32_t trying;     // A la que se sondea
+    uint32_t switching;  // Pedida con "baud="
+    uint32_t previous;   // Confirmada antes del pedido
+    uint8_t index;       // Candidata siguiente (FIND y escalera)
+    uint8_t attempts;
+    uint8_t probesOk;
+    uint8_t probesNeeded;
+    bool targetTried;
+    bool replied;
+    uint32_t stepMs;     // Cambio de velocidad o sondeo enviado
+    uint32_t seed;
+
+    template <class Link>
+    Result onRate(Link& link, bool ok, uint32_t nowMs) {
+        switch (phase) {
+            case CHECK:
+                if (ok) return finish(link, target);
+                phase = FIND;
+                find(link, nowMs);
+                return BUSY;
+
+            case FIND:
+                if (ok) {
+                    current = trying;
+                    index = 0;
+                    targetTried = false;
+                    return climb(link, nowMs);
+                }
+                if (index >= CANDIDATE_COUNT) return finish(link, 0);
+                tryRate(link, NextionConfig::BAUD_CANDIDATES[index++], nowMs);
+                return BUSY;
+
+            case SWITCH:
+                if (ok) return finish(link, trying);
+                attempts = 0;
+                fallBack(link, nowMs);
+                return BUSY;
+
+            case FALLBACK:
+                if (ok) {
+                    current = previous;
+                    return climb(link, nowMs);
+                }
+                // El pedido puede llegar mal a la velocidad nueva: se repite
+                if (++attempts < NextionConfig::BAUD_FALLBACK_ATTEMPTS) {
+                    link.setBaud(switching);
+                    fallBack(link, nowMs);
+                    return BUSY;
+                }
+                // Inalcanzable: otro intento tras LINK_RETRY_MS
+                return finish(link, 0);
+
+            case IDLE:
+                break;
+        }
+        return finish(link, current);
+    }
+
+    // Desde current: primero la velocidad del enlace, después la escalera
+    template <class Link>
+    Result climb(Link& link, uint32_t nowMs) {
+        if (!targetTried && target != 0) {
+            targetTried = true;
+            if (current == target) return finish(link, current);
+            switchTo(link, target, nowMs);
+            return BUSY;
+        }
+        while (index < CANDIDATE_COUNT) {
+            uint32_t candidate = NextionConfig::BAUD_CANDIDATES[index++];
+            if (candidate <= current) break;
+            if (candidate != target) {
+                switchTo(link, candidate, nowMs);
+                return BUSY;
+            }
+        }
+        return finish(link, current);
+    }
+
+    template <class Link>
+    Result finish(Link& link, uint32_t baud) {
+        if (baud == 0) {
+            link.setBaud(NextionConfig::BAUD_RATE);
+        }
+        current = baud;
+        phase = IDLE;
+        step = BEGIN;
+        return (baud != 0) ? LINKED : LOST;
+    }
+
+    template <class Link>
+    void find(Link& link, uint32_t nowMs) {
+        index = 0;
+        tryRate(link, NextionConfig::BAUD_RATE, nowMs);
+    }
+
+    template <class Link>
+    void switchTo(Link& link, uint32_t baud, uint32_t nowMs) {
+        phase = SWITCH;
+        previous = current;
+        switching = baud;
+        sendBaud(link, baud);
+        tryRate(link, baud, nowMs);
+    }
+
+    // El UART está a switching
+    template <class Link>
+    void fallBack(Link& link, uint32_t nowMs) {
+        phase = FALLBACK;
+        sendBaud(link, previous);
+        tryRate(link, previous, nowMs);
+    }
+
+    template <class Link>
+    void tryRate(Link& link, uint32_t baud, uint32_t nowMs) {
+        link.setBaud(baud);
+        trying = baud;
+        probesNeeded = NextionConfig::BAUD_PROBES;
+        probesOk = 0;
+        step = SETTLE;
+        stepMs = nowMs;
+    }
+
+    template <class Link>
+    void sendProbe(Link& link, uint32_t nowMs) {
+        uint32_t nonce = makeNonce(seed++);
+        matcher = ProbeMatcher(nonce);
+        replied = false;
+
+        char cmd[16];
+        NextionFormat::Writer writer(cmd, sizeof(cmd));
+        writer.text("get ").number(nonce);
+        link.sendCommand(writer.c_str());
+        step = WAIT;
+        stepMs = nowMs;
+    }
+
+    template <class Link>
+    void sendBaud(Link& link, uint32_t baud) {
+        char cmd[16];
+        NextionFormat::Writer writer(cmd, sizeof(cmd));
+        writer.text("baud=").number(baud);
+        link.sendCommand(writer.c_str());
+    }
+};
+
+} // namespace NextionBaud
+
+#endif // NEXTION_BAUD_H
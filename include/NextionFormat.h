@@ -0,0 +1,141 @@
+#ifndef NEXTION_FORMAT_H
+#define NEXTION_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ========================================
+// FORMATEO DE COMANDOS NEXTION SIN snprintf
+// ========================================
+// Los prefijos de cada componente ("fase_ejec.txt=\"", "tanda1.bco=") se
+// arman en tiempo de compilación; los valores se escriben a mano (enteros,
+// punto fijo, mm:ss) directamente en el destino, normalmente el espacio
+// reservado al final de la trama de TX.
+
+namespace NextionFormat {
+
+// Texto constante de largo conocido en compilación (N caracteres + '\0')
+template <size_t N>
+struct Prefix {
+    char text[N + 1];
+    static constexpr size_t length = N;
+};
+
+// "componente" + "sufijo" en tiempo de compilación
+template <size_t C, size_t S>
+constexpr Prefix<C + S - 2> attribute(const char (&component)[C], const char (&suffix)[S]) {
+    Prefix<C + S - 2> prefix{};
+    for (size_t i = 0; i < C - 1; i++) prefix.text[i] = component[i];
+    for (size_t i = 0; i < S - 1; i++) prefix.text[C - 1 + i] = suffix[i];
+    prefix.text[C + S - 2] = '\0';
+    return prefix;
+}
+
+template <size_t C>
+constexpr Prefix<C + 5> txt(const char (&component)[C]) { return attribute(component, ".txt=\""); }
+
+template <size_t C>
+constexpr Prefix<C + 4> val(const char (&component)[C]) { return attribute(component, ".val="); }
+
+template <size_t C>
+constexpr Prefix<C + 4> bco(const char (&component)[C]) { return attribute(component, ".bco="); }
+
+// Escritor acotado: al llenarse deja de escribir y marca overflow
+class Writer {
+public:
+    Writer() : out(nullptr), capacity(0), length(0), overflow(false) {}
+    Writer(char* buffer, size_t size) : out(buffer), capacity(size), length(0), overflow(false) {}
+
+    template <size_t N>
+    Writer& prefix(const Prefix<N>& p) { return raw(p.text, N); }
+
+    Writer& text(const char* s) {
+        while (*s != '\0') put(*s++);
+        return *this;
+    }
+
+    Writer& put(char c) {
+        if (length < capacity) {
+            out[length++] = c;
+        } else {
+            overflow = true;
+        }
+        return *this;
+    }
+
+    Writer& quote() { return put('"'); }
+
+    Writer& number(uint32_t value) {
+        char digits[10];
+        uint8_t count = 0;
+        do {
+            digits[count++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        while (count > 0) put(digits[--count]);
+        return *this;
+    }
+
+    Writer& integer(int32_t value) {
+        if (value < 0) {
+            put('-');
+            return number(0u - (uint32_t)value);
+        }
+        return number((uint32_t)value);
+    }
+
+    // Punto fijo: fixed(405, 1) -> "40.5", fixed(-5, 1) -> "-0.5", fixed(207, 2) -> "2.07"
+    Writer& fixed(int32_t scaled, uint8_t decimals) {
+        uint32_t magnitude = scaled < 0 ? 0u - (uint32_t)scaled : (uint32_t)scaled;
+        uint32_t divisor = 1;
+        for (uint8_t i = 0; i < decimals; i++) divisor *= 10;
+
+        if (scaled < 0) put('-');
+        number(magnitude / divisor);
+        if (decimals == 0) return *this;
+
+        put('.');
+        uint32_t fraction = magnitude % divisor;
+        for (divisor /= 10; divisor > 0; divisor /= 10) {
+            put((char)('0' + fraction / divisor));
+            fraction %= divisor;
+        }
+        return *this;
+    }
+
+    // "mm:ss" (los minutos crecen si pasan de 99, como "%02d:%02d")
+    Writer& mmss(uint32_t seconds) {
+        uint32_t minutes = seconds / 60;
+        if (minutes < 10) put('0');
+        number(minutes);
+        put(':');
+        put((char)('0' + (seconds % 60) / 10));
+        return put((char)('0' + seconds % 10));
+    }
+
+    // Termina en '\0' (para buffers de texto; trunca si está lleno)
+    const char* c_str() {
+        if (capacity == 0) return "";
+        out[length < capacity ? length : capacity - 1] = '\0';
+        return out;
+    }
+
+    const char* data() const { return out; }
+    size_t size() const { return length; }
+    bool overflowed() const { return overflow; }
+
+private:
+    char* out;
+    size_t capacity;
+    size_t length;
+    bool overflow;
+
+    Writer& raw(const char* s, size_t len) {
+        for (size_t i = 0; i < len; i++) put(s[i]);
+        return *this;
+    }
+};
+
+} // namespace NextionFormat
+
+#endif // NEXTION_FORMAT_H
@@ -0,0 +1,125 @@
+#ifndef NEXTION_FRAME_H
+#define NEXTION_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Config.h"
+
+// ========================================
+// TRAMA DE COMANDOS NEXTION
+// ========================================
+// Junta varios comandos terminados (0xFF 0xFF 0xFF) en un solo buffer para
+// enviarlos con una sola escritura al UART. En una trama "atómica" el primer
+// comando va precedido de ref_stop y finish() agrega ref_star: el panel
+// aplica todos los cambios y redibuja una sola vez. Una trama atómica sin
+// comandos no envía nada. Los comandos se pueden formatear directamente en
+// la trama con reserve()/commit().
+
+class NextionFrame {
+public:
+    static constexpr size_t CAPACITY = NextionConfig::TX_FRAME_SIZE;
+    static constexpr uint8_t TERMINATOR_BYTES = 3;  // 0xFF 0xFF 0xFF
+
+    NextionFrame() : length(0), commands(0), buffered(0), atomic(false), finished(false) {}
+
+    void begin(bool atomicFrame) {
+        length = 0;
+        commands = 0;
+        buffered = 0;
+        atomic = atomicFrame;
+        finished = false;
+    }
+
+    // Agrega un comando (len sin terminador). false = no entra: vaciar con
+    // drain() y reintentar. Siempre queda lugar para el ref_star final.
+    bool add(const char* cmd, size_t len) {
+        char* out = reserve(len);
+        if (out == nullptr) {
+            return false;
+        }
+        memcpy(out, cmd, len);
+        commit(len);
+        return true;
+    }
+
+    // Lugar para escribir un comando de hasta maxLen bytes en la trama
+    // (nullptr = no entra). Solo queda en la trama si se llama a commit().
+    char* reserve(size_t maxLen) {
+        size_t offset = length + refStopBytes();
+        if (offset + maxLen + TERMINATOR_BYTES + reserved() > CAPACITY) {
+            return nullptr;
+        }
+        return reinterpret_cast<char*>(buffer + offset);
+    }
+
+    // Confirma los len bytes escritos en reserve(): ref_stop delante si es el
+    // primero de una trama atómica (su lugar ya estaba reservado) y terminador
+    void commit(size_t len) {
+        if (refStopBytes() > 0) {
+            memcpy(buffer + length, REF_STOP, sizeof(REF_STOP) - 1);
+            length += sizeof(REF_STOP) - 1;
+            terminate();
+        }
+        length += len;
+        terminate();
+        commands++;
+    }
+
+    // Cierra la trama: ref_star si se envió ref_stop
+    void finish() {
+        if (atomic && commands > 0 && !finished) {
+            put(REF_STAR, sizeof(REF_STAR) - 1);
+        }
+        finished = true;
+    }
+
+    // Bytes ya escritos al UART: la trama sigue abierta (el ref_star pendiente
+    // se agrega igual en finish())
+    void drain() {
+        length = 0;
+        buffered = 0;
+    }
+
+    const uint8_t* data() const { return buffer; }
+    size_t size() const { return length; }
+    uint16_t getCommands() const { return commands; }
+
+    // Comandos en el buffer, con ref_stop/ref_star (uno por terminador)
+    uint16_t getBuffered() const { return buffered; }
+    bool isAtomic() const { return atomic; }
+
+private:
+    static constexpr char REF_STOP[] = "ref_stop";
+    static constexpr char REF_STAR[] = "ref_star";
+
+    uint8_t buffer[CAPACITY];
+    size_t length;
+    uint16_t commands;
+    uint16_t buffered;
+    bool atomic;
+    bool finished;
+
+    size_t reserved() const {
+        return atomic ? sizeof(REF_STAR) - 1 + TERMINATOR_BYTES : 0;
+    }
+
+    size_t refStopBytes() const {
+        return (atomic && commands == 0) ? sizeof(REF_STOP) - 1 + TERMINATOR_BYTES : 0;
+    }
+
+    void put(const char* cmd, size_t len) {
+        memcpy(buffer + length, cmd, len);
+        length += len;
+        terminate();
+    }
+
+    void terminate() {
+        buffered++;
+        buffer[length++] = 0xFF;
+        buffer[length++] = 0xFF;
+        buffer[length++] = 0xFF;
+    }
+};
+
+#endif // NEXTION_FRAME_H
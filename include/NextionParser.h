@@ -0,0 +1,242 @@
+#ifndef NEXTION_PARSER_H
+#define NEXTION_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Config.h"
+#include "NextionAckQueue.h"
+
+// ========================================
+// DECODIFICADOR DE RESPUESTAS NEXTION
+// ========================================
+// Incremental, un byte por vez: los mensajes pueden llegar partidos entre
+// lecturas del UART. El primer byte dice cuántos bytes de datos siguen:
+//   0x65 página, componente, evento         (touch)
+//   0x66 página                             (respuesta a sendme)
+//   0x67/0x68 x (2), y (2), evento          (coordenadas; 0x68 dormido)
+//   0x71 número int32 little endian         (respuesta a get)
+//   0x70 texto hasta FF FF FF               (respuesta a get)
+//   0x86/0x87 dormido/despierto, 0x88 listo, 0x00-0x24 resultado de comando
+// Los de largo fijo no buscan el terminador en los datos (un 0x71 de -1 es
+// FF FF FF FF). Un mensaje que no termina donde debe se descarta y el byte
+// inesperado empieza el siguiente. Los bytes quedan en el buffer del parser
+// y el evento apunta a ellos: sin copias ni limpiezas entre mensajes.
+
+namespace NextionReturn {
+    constexpr uint8_t TOUCH_EVENT = 0x65;
+    constexpr uint8_t CURRENT_PAGE = 0x66;
+    constexpr uint8_t TOUCH_COORDINATE = 0x67;
+    constexpr uint8_t SLEEP_TOUCH = 0x68;
+    constexpr uint8_t STRING_DATA = 0x70;
+    constexpr uint8_t NUMERIC_DATA = 0x71;
+    constexpr uint8_t AUTO_SLEEP = 0x86;
+    constexpr uint8_t AUTO_WAKE = 0x87;
+    constexpr uint8_t READY = 0x88;
+    constexpr uint8_t SD_UPGRADE = 0x89;
+    constexpr uint8_t TRANSPARENT_FINISHED = 0xFD;
+    constexpr uint8_t TRANSPARENT_READY = 0xFE;
+}
+
+class NextionParser {
+public:
+    static constexpr size_t CAPACITY = NextionConfig::RX_MESSAGE_SIZE;
+
+    enum EventType : uint8_t {
+        EVENT_TOUCH = 0,         // page, component, touch
+        EVENT_PAGE,              // page
+        EVENT_COORDINATE,        // x, y, touch
+        EVENT_SLEEP_COORDINATE,  // x, y, touch (despierta al panel)
+        EVENT_STRING,            // text, length
+        EVENT_NUMBER,            // number
+        EVENT_SLEEP,
+        EVENT_WAKE,
+        EVENT_READY,
+        EVENT_STARTUP,           // 00 00 00 FF FF FF al encender
+        EVENT_RESULT,            // code: resultado de comando (bkcmd)
+        EVENT_OTHER              // code: tarjeta SD, modo transparente o desconocido
+    };
+
+    struct Event {
+        EventType type;
+        uint8_t code;          // Primer byte del mensaje
+        uint8_t page;
+        uint8_t component;
+        uint8_t touch;         // 1 = presionado, 0 = soltado
+        uint16_t x;
+        uint16_t y;
+        int32_t number;
+        const char* text;      // Terminado en '\0', válido hasta el próximo feed()
+        uint8_t length;
+        bool truncated;        // Texto más largo que el buffer
+    };
+
+    struct Stats {
+        uint32_t messages;     // Mensajes completos
+        uint32_t malformed;    // Descartados por no terminar donde debían
+        uint32_t unknown;      // Primer byte desconocido (saltado hasta FF FF FF)
+        uint32_t truncated;    // Textos recortados
+    };
+
+    NextionParser() { reset(); }
+
+    void reset() {
+        state = IDLE;
+        length = 0;
+        expected = 0;
+        terminators = 0;
+        overflow = false;
+        stats = Stats{};
+    }
+
+    // true al completar un mensaje: queda en event() hasta el próximo byte
+    bool feed(uint8_t byte) {
+        switch (state) {
+            case IDLE:
+                if (byte == 0xFF) return false;  // Resto de un mensaje descartado
+                start(byte);
+                return false;
+
+            case FIXED:
+                if (length < expected) {
+                    buffer[length++] = (char)byte;
+                    return false;
+                }
+                if (byte == 0xFF) {
+                    return ++terminators == 3 ? complete() : false;
+                }
+                // Se esperaba el terminador: empieza otro mensaje
+                stats.malformed++;
+                start(byte);
+                return false;
+
+            case VARIABLE:
+                if (byte == 0xFF) {
+                    return ++terminators == 3 ? complete() : false;
+                }
+                // Los 0xFF sueltos eran datos
+                for (; terminators > 0; terminators--) store(0xFF);
+                store(byte);
+                return false;
+        }
+        return false;
+    }
+
+    const Event& event() const { return current; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    enum State : uint8_t { IDLE, FIXED, VARIABLE };
+    static constexpr uint8_t UNTIL_TERMINATOR = 0xFF;
+
+    static_assert(CAPACITY >= 8 && CAPACITY <= 255, "Event::length es de 8 bits");
+
+    char buffer[CAPACITY + 1];  // + '\0' del texto
+    Event current;
+    Stats stats;
+    State state;
+    uint8_t code;
+    uint8_t length;
+    uint8_t expected;
+    uint8_t terminators;
+    bool overflow;
+
+    // Bytes de datos de cada mensaje (UNTIL_TERMINATOR = hasta FF FF FF)
+    static uint8_t payloadLength(uint8_t code) {
+        switch (code) {
+            case NextionReturn::TOUCH_EVENT:      return 3;
+            case NextionReturn::CURRENT_PAGE:     return 1;
+            case NextionReturn::TOUCH_COORDINATE:
+            case NextionReturn::SLEEP_TOUCH:      return 5;
+            case NextionReturn::NUMERIC_DATA:     return 4;
+            case NextionReturn::AUTO_SLEEP:
+            case NextionReturn::AUTO_WAKE:
+            case NextionReturn::READY:
+            case NextionReturn::SD_UPGRADE:
+            case NextionReturn::TRANSPARENT_FINISHED:
+            case NextionReturn::TRANSPARENT_READY: return 0;
+            case NextionReturn::INVALID_INSTRUCTION: return UNTIL_TERMINATOR;  // O 00 00 00 al encender
+            default:
+                return NextionReturn::isCommandResult(code) ? 0 : UNTIL_TERMINATOR;
+        }
+    }
+
+    void start(uint8_t byte) {
+        code = byte;
+        length = 0;
+        terminators = 0;
+        overflow = false;
+        expected = payloadLength(byte);
+        state = (expected == UNTIL_TERMINATOR) ? VARIABLE : FIXED;
+    }
+
+    void store(uint8_t byte) {
+        if (length < CAPACITY) {
+            buffer[length++] = (char)byte;
+        } else {
+            overflow = true;
+        }
+    }
+
+    static uint16_t word(const char* data) {
+        return (uint16_t)(((uint8_t)data[0] << 8) | (uint8_t)data[1]);
+    }
+
+    bool complete() {
+        state = IDLE;
+        stats.messages++;
+        current.code = code;
+        current.truncated = false;
+
+        switch (code) {
+            case NextionReturn::TOUCH_EVENT:
+                current.type = EVENT_TOUCH;
+                current.page = (uint8_t)buffer[0];
+                current.component = (uint8_t)buffer[1];
+                current.touch = (uint8_t)buffer[2];
+                break;
+            case NextionReturn::CURRENT_PAGE:
+                current.type = EVENT_PAGE;
+                current.page = (uint8_t)buffer[0];
+                break;
+            case NextionReturn::TOUCH_COORDINATE:
+            case NextionReturn::SLEEP_TOUCH:
+                current.type = (code == NextionReturn::SLEEP_TOUCH) ? EVENT_SLEEP_COORDINATE : EVENT_COORDINATE;
+                current.x = word(buffer);
+                current.y = word(buffer + 2);
+                current.touch = (uint8_t)buffer[4];
+                break;
+            case NextionReturn::NUMERIC_DATA:
+                current.type = EVENT_NUMBER;
+                current.number = (int32_t)((uint32_t)(uint8_t)buffer[0] |
+                                           ((uint32_t)(uint8_t)buffer[1] << 8) |
+                                           ((uint32_t)(uint8_t)buffer[2] << 16) |
+                                           ((uint32_t)(uint8_t)buffer[3] << 24));
+                break;
+            case NextionReturn::STRING_DATA:
+                current.type = EVENT_STRING;
+                buffer[length] = '\0';
+                current.text = buffer;
+                current.length = length;
+                current.truncated = overflow;
+                if (overflow) stats.truncated++;
+                break;
+            case NextionReturn::AUTO_SLEEP: current.type = EVENT_SLEEP; break;
+            case NextionReturn::AUTO_WAKE:  current.type = EVENT_WAKE; break;
+            case NextionReturn::READY:      current.type = EVENT_READY; break;
+            case NextionReturn::INVALID_INSTRUCTION:
+                current.type = (length == 0) ? EVENT_RESULT : EVENT_STARTUP;
+                break;
+            default:
+                if (NextionReturn::isCommandResult(code)) {
+                    current.type = EVENT_RESULT;
+                } else {
+                    current.type = EVENT_OTHER;
+                    if (expected == UNTIL_TERMINATOR) stats.unknown++;
+                }
+                break;
+        }
+        return true;
+    }
+};
+
+#endif // NEXTION_PARSER_H
@@ -0,0 +1,59 @@
+#ifndef NEXTION_PREFIXES_H
+#define NEXTION_PREFIXES_H
+
+#include "NextionFormat.h"
+
+// ========================================
+// PREFIJOS DE COMANDOS NEXTION (en tiempo de compilación)
+// ========================================
+// Un solo lugar para los nombres de componentes del HMI: NextionUI y
+// main.cpp escriben los mismos campos y un renombre en el editor del
+// Nextion se corrige acá.
+
+namespace NextionPrefix {
+    using NextionFormat::Prefix;
+    using NextionFormat::txt;
+    using NextionFormat::val;
+    using NextionFormat::bco;
+
+    // Página de selección
+    inline constexpr Prefix<17> BCO_PROGRAMA[3] = {
+        bco("btnPrograma1"), bco("btnPrograma2"), bco("btnPrograma3")
+    };
+    inline constexpr Prefix<11> BCO_TANDA[4] = {bco("tanda1"), bco("tanda2"), bco("tanda3"), bco("tanda4")};
+    inline constexpr Prefix<11> VAL_TANDA[4] = {val("tanda1"), val("tanda2"), val("tanda3"), val("tanda4")};
+
+    inline constexpr auto TXT_PROGR_SEL = txt("progr_sel");
+    inline constexpr auto TXT_VAL_NIVEL = txt("val_nivel");
+    inline constexpr auto TXT_VAL_TEMP = txt("val_temp");
+    inline constexpr auto TXT_VAL_TIEMPO = txt("val_tiempo");
+    inline constexpr auto TXT_VAL_CENTRIF = txt("val_centrif");
+    inline constexpr auto TXT_VAL_AGUA = txt("val_agua");
+
+    // Página de ejecución
+    inline constexpr auto TXT_PROGR_EJEC = txt("progr_ejec");
+    inline constexpr auto TXT_FASE_EJEC = txt("fase_ejec");
+    inline constexpr auto TXT_TANDA_EJEC = txt("tanda_ejec");
+    inline constexpr auto TXT_TIEMPO_EJEC = txt("tiempo_ejec");
+    inline constexpr auto TXT_TIEMPO_TOTAL = txt("tiempo_total");
+    inline constexpr auto TXT_TEMP_EJEC = txt("temp_ejec");
+    inline constexpr auto TXT_NIVEL_EJEC = txt("nivel_ejec");
+    inline constexpr auto VAL_BARRA_NIVEL = val("barra_nivel");
+    inline constexpr auto VAL_BARRA_TEMP = val("barra_temp");
+    inline constexpr auto TXT_CENTRIF_EJEC = txt("centrif_ejec");
+    inline constexpr auto TXT_AGUA_EJEC = txt("agua_ejec");
+
+    // Página de calibración
+    inline constexpr auto TXT_CAL_REF = txt("cal_ref");
+    inline constexpr auto TXT_CAL_NIVEL = txt("cal_nivel");
+    inline constexpr auto TXT_CAL_PRES = txt("cal_pres");
+    inline constexpr auto TXT_CAL_PUNTOS = txt("cal_puntos");
+    inline constexpr auto TXT_BTN_LLENAR = txt("btnLlenar");
+    inline constexpr auto TXT_CAL_ESTADO = txt("cal_estado");
+
+    // Página de edición
+    inline constexpr auto TXT_PARAM = txt("param");
+    inline constexpr auto TXT_PARAM_VALUE = txt("param_value");
+}
+
+#endif // NEXTION_PREFIXES_H
@@ -0,0 +1,127 @@
+#ifndef NEXTION_QUERY_H
+#define NEXTION_QUERY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Config.h"
+
+// ========================================
+// CONSULTAS "get" PENDIENTES
+// ========================================
+// El panel responde los get en orden, con 0x71 (número) o 0x70 (texto): cada
+// respuesta es de la consulta más antigua. Si la respuesta no es del tipo
+// pedido, o no llega en QUERY_TIMEOUT_US (variable inexistente: con bkcmd=0
+// el panel no avisa), el callback recibe ok = false. Una respuesta sin
+// consulta pendiente (prints del HMI) no se toma como de ninguna.
+
+class NextionQueryQueue {
+public:
+    static constexpr uint8_t CAPACITY = NextionConfig::QUERY_QUEUE_SIZE;
+
+    typedef void (*NumberCallback)(bool ok, int32_t value);
+    typedef void (*TextCallback)(bool ok, const char* text);
+
+    struct Stats {
+        uint32_t answered;    // Respuestas del tipo pedido
+        uint32_t failed;      // Tipo equivocado o sin respuesta
+        uint32_t timeouts;
+        uint32_t rejected;    // Cola llena al consultar
+    };
+
+    NextionQueryQueue() { reset(); }
+
+    void reset() {
+        head = 0;
+        count = 0;
+        stats = Stats{};
+    }
+
+    bool canPush() const { return count < CAPACITY; }
+
+    bool pushNumber(NumberCallback callback, uint32_t nowUs) {
+        return push(Query{NUMBER, callback, nullptr, nowUs});
+    }
+
+    bool pushText(TextCallback callback, uint32_t nowUs) {
+        return push(Query{TEXT, nullptr, callback, nowUs});
+    }
+
+    // Respuesta 0x71 / 0x70. false = no había consulta pendiente.
+    bool onNumber(int32_t value) {
+        if (count == 0) return false;
+        Query query = pop();
+        if (query.kind == NUMBER) {
+            stats.answered++;
+            if (query.onNumber != nullptr) query.onNumber(true, value);
+        } else {
+            fail(query);
+        }
+        return true;
+    }
+
+    bool onText(const char* text) {
+        if (count == 0) return false;
+        Query query = pop();
+        if (query.kind == TEXT) {
+            stats.answered++;
+            if (query.onText != nullptr) query.onText(true, text);
+        } else {
+            fail(query);
+        }
+        return true;
+    }
+
+    // Consultas sin respuesta a tiempo: fallan en orden
+    void checkTimeout(uint32_t nowUs) {
+        while (count > 0 && nowUs - queries[head].sentUs >= NextionConfig::QUERY_TIMEOUT_US) {
+            stats.timeouts++;
+            fail(pop());
+        }
+    }
+
+    bool hasPending() const { return count > 0; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    enum Kind : uint8_t { NUMBER, TEXT };
+
+    struct Query {
+        Kind kind;
+        NumberCallback onNumber;
+        TextCallback onText;
+        uint32_t sentUs;
+    };
+
+    Query queries[CAPACITY];
+    uint8_t head;
+    uint8_t count;
+    Stats stats;
+
+    bool push(const Query& query) {
+        if (count == CAPACITY) {
+            stats.rejected++;
+            return false;
+        }
+        queries[(head + count) % CAPACITY] = query;
+        count++;
+        return true;
+    }
+
+    Query pop() {
+        Query query = queries[head];
+        head = (head + 1) % CAPACITY;
+        count--;
+        return query;
+    }
+
+    void fail(const Query& query) {
+        stats.failed++;
+        if (query.kind == NUMBER) {
+            if (query.onNumber != nullptr) query.onNumber(false, 0);
+        } else if (query.onText != nullptr) {
+            query.onText(false, "");
+        }
+    }
+};
+
+#endif // NEXTION_QUERY_H
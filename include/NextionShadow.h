@@ -0,0 +1,140 @@
+#ifndef NEXTION_SHADOW_H
+#define NEXTION_SHADOW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Config.h"
+
+// ========================================
+// MODELO ESPEJO DE LA PÁGINA NEXTION
+// ========================================
+// Último valor enviado a cada atributo de la página visible ("comp.txt",
+// "comp.val", "tsw 24", "vis comp"...). Un comando con el mismo valor que el
+// espejo no se envía. Al cambiar de página el Nextion recarga los valores del
+// HMI, así que el espejo se vacía. Los atributos .val que el panel cambia
+// solo al tocarlos (botones dual-state) se olvidan en cada evento táctil.
+// Guarda hashes FNV-1a (clave y valor), sin copiar textos.
+
+class NextionShadow {
+public:
+    static constexpr uint8_t MAX_ENTRIES = NextionConfig::SHADOW_MAX_COMPONENTS;
+    static constexpr uint8_t MAX_PAGES = NextionConfig::PAGE_COUNT;
+    static constexpr uint8_t TERMINATOR_BYTES = 3;  // 0xFF 0xFF 0xFF
+
+    // Tráfico por página (bytes con el terminador)
+    struct PageStats {
+        uint32_t sentCommands;
+        uint32_t skippedCommands;
+        uint32_t sentBytes;
+        uint32_t savedBytes;
+    };
+
+    NextionShadow() : page(0), count(0), stats{} {}
+
+    // Página nueva: el panel muestra los valores del HMI
+    void setPage(uint8_t newPage) {
+        page = (newPage < MAX_PAGES) ? newPage : 0;
+        count = 0;
+    }
+
+    uint8_t getPage() const { return page; }
+
+    // El panel pudo cambiar (reinicio, comando sin espejo): reenviar todo
+    void invalidate() { count = 0; }
+
+    // Evento táctil: olvidar los .val (estado de botones dual-state)
+    void invalidateTouchable() {
+        uint8_t kept = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            if (!entries[i].touchable) entries[kept++] = entries[i];
+        }
+        count = kept;
+    }
+
+    // true si hay que enviar el comando (len sin terminador). Los comandos sin
+    // atributo reconocible ("page 2", "bkcmd=...") se envían siempre.
+    bool shouldSend(const char* cmd, size_t len) {
+        size_t keyLen = splitKey(cmd, len);
+        if (keyLen == 0) {
+            recordSent(len);
+            return true;
+        }
+
+        uint32_t key = hash(cmd, keyLen);
+        uint32_t value = hash(cmd + keyLen, len - keyLen);
+        for (uint8_t i = 0; i < count; i++) {
+            if (entries[i].key != key) continue;
+            if (entries[i].value == value) {
+                stats[page].skippedCommands++;
+                stats[page].savedBytes += len + TERMINATOR_BYTES;
+                return false;
+            }
+            entries[i].value = value;
+            recordSent(len);
+            return true;
+        }
+
+        // Atributo nuevo (con el espejo lleno se envía sin registrar)
+        if (count < MAX_ENTRIES) {
+            entries[count++] = {key, value, isTouchable(cmd, keyLen)};
+        }
+        recordSent(len);
+        return true;
+    }
+
+    // Comando enviado sin pasar por el espejo
+    void recordSent(size_t len) {
+        stats[page].sentCommands++;
+        stats[page].sentBytes += len + TERMINATOR_BYTES;
+    }
+
+    const PageStats& getStats(uint8_t statsPage) const {
+        return stats[statsPage < MAX_PAGES ? statsPage : 0];
+    }
+
+    uint8_t size() const { return count; }
+
+private:
+    struct Entry {
+        uint32_t key;
+        uint32_t value;
+        bool touchable;
+    };
+
+    uint8_t page;
+    uint8_t count;
+    Entry entries[MAX_ENTRIES];
+    PageStats stats[MAX_PAGES];
+
+    // Largo de la clave: hasta el '=' ("comp.txt=") o la última ',' ("tsw 24,"); 0 = sin clave
+    static size_t splitKey(const char* cmd, size_t len) {
+        const char* eq = static_cast<const char*>(memchr(cmd, '=', len));
+        if (eq != nullptr) {
+            // Asignación de un atributo de componente (no variables de sistema)
+            const char* dot = static_cast<const char*>(memchr(cmd, '.', eq - cmd));
+            return dot != nullptr ? (eq - cmd) + 1 : 0;
+        }
+        if (strncmp(cmd, "tsw ", 4) != 0 && strncmp(cmd, "vis ", 4) != 0) {
+            return 0;
+        }
+        for (size_t i = len; i > 0; i--) {
+            if (cmd[i - 1] == ',') return i;
+        }
+        return 0;
+    }
+
+    static bool isTouchable(const char* cmd, size_t keyLen) {
+        return keyLen >= 5 && memcmp(cmd + keyLen - 5, ".val=", 5) == 0;
+    }
+
+    static uint32_t hash(const char* data, size_t len) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < len; i++) {
+            h = (h ^ (uint8_t)data[i]) * 16777619u;
+        }
+        return h;
+    }
+};
+
+#endif // NEXTION_SHADOW_H
@@ -4,6 +4,13 @@
 #include <Arduino.h>
 #include <HardwareSerial.h>
 #include "Config.h"
+#include "NextionShadow.h"
+#include "NextionFrame.h"
+#include "NextionFormat.h"
+#include "NextionAckQueue.h"
+#include "NextionParser.h"
+#include "NextionQuery.h"
+#include "NextionBaud.h"
 
 // Forward declaration
 struct ProgramConfig;
@@ -12,7 +19,10 @@ class NextionUI {
 public:
     NextionUI();
 
-    void begin();
+    // Sube el enlace a la velocidad guardada o a la más alta que el panel
+    // confirme; devuelve la velocidad final (0 = el panel no respondió).
+    // update() lo vigila y renegocia si el panel se reinicia en marcha.
+    uint32_t begin(uint32_t savedBaud = 0);
     void update();
 
     // Navegación de páginas
@@ -22,6 +32,7 @@ public:
     void showEdit();
     void showError(const char* message);
     void showEmergency();
+    void showCalibration();
 
     // Actualización de página de selección
     void updateSelectionDisplay(const ProgramConfig& config);
@@ -34,11 +45,21 @@ public:
         uint16_t phaseTime,
         uint16_t totalTime,
         float temperature,
-        uint8_t waterLevel,
+        uint16_t waterLevelCenti,
         bool centrifuge,
         WaterType waterType
     );
 
+    // Actualización de página de calibración
+    void updateCalibrationDisplay(
+        uint16_t referenceCenti,
+        uint16_t levelCenti,
+        long pressure,
+        uint8_t points,
+        bool filling,
+        const char* status
+    );
+
     // Actualización de página de edición
     void updateEditDisplay(
         uint8_t process,
@@ -49,31 +70,99 @@ public:
     // Callbacks de eventos (se configuran desde main)
     void setButtonCallback(void (*callback)(uint8_t pageId, uint8_t componentId, uint8_t eventType));
 
-    // Utilidades
+    // Todos los mensajes del panel, ya procesados (coordenadas, prints del HMI...)
+    void setEventCallback(void (*callback)(const NextionParser::Event& event));
+
+    // Consultas "get": el callback se llama desde update() con la respuesta
+    // (ok = false si no llegó o no era del tipo pedido). false = cola llena.
+    bool getNumber(const char* variable, NextionQueryQueue::NumberCallback callback);
+    bool getText(const char* variable, NextionQueryQueue::TextCallback callback);
+
+    // Utilidades (solo se envían si el valor cambió en la página visible)
     void setText(const char* component, const char* text);
     void setNumber(const char* component, uint32_t value);
     void setEnabled(const char* component, bool enabled);
     void setEnabledById(uint8_t componentId, bool enabled);
     void setBackgroundColor(const char* component, uint16_t color);
+    void setVisible(const char* component, bool visible);
+
+    // Comando formateado en el lugar, sin snprintf: se escribe con el Writer
+    // devuelto (directo en la trama de TX) y endValue() lo confirma, o lo
+    // descarta si el espejo ya tiene ese valor
+    NextionFormat::Writer& beginValue();
+    void endValue();
+
+    // Comando crudo, siempre enviado. Si cambia un valor que las utilidades
+    // de arriba recuerdan, llamar a invalidateShadow().
     void sendCommand(const char* cmd);
+    void invalidateShadow() { shadow.invalidate(); }
+
+    // Comando crudo que espera confirmación con ACK_COMMANDS (bkcmd=3): se
+    // reintenta si el panel no lo pudo ejecutar. Sin ACK_COMMANDS o con la
+    // cola llena sale como sendCommand().
+    void sendCommandAcked(const char* cmd);
+
+    // Confirmaciones y latencia de ida y vuelta (solo con ACK_COMMANDS)
+    const NextionAckQueue::Stats& getAckStats() const { return acks.getStats(); }
+    const LatencyHistogram& getAckLatency() const { return acks.getLatency(); }
+
+    // Mensajes recibidos y consultas
+    const NextionParser::Stats& getParserStats() const { return parser.getStats(); }
+    const NextionQueryQueue::Stats& getQueryStats() const { return queries.getStats(); }
+
+    // Trama: los comandos entre beginFrame() y endFrame() salen en una sola
+    // escritura; atomic los envuelve en ref_stop/ref_star para que el panel
+    // redibuje una vez. Se pueden anidar (manda la trama más externa).
+    void beginFrame(bool atomic = true);
+    void endFrame();
+
+    // Bytes enviados y ahorrados por el espejo en cada página
+    const NextionShadow::PageStats& getShadowStats(uint8_t page) const { return shadow.getStats(page); }
 
 private:
     HardwareSerial* serial;
     void (*buttonCallback)(uint8_t, uint8_t, uint8_t);
+    void (*eventCallback)(const NextionParser::Event&);
 
     uint8_t currentPage;
     unsigned long lastUpdate;
 
-    // Buffer para lectura de eventos
-    char rxBuffer[32];
-    uint8_t rxIndex;
+    // Último valor enviado a cada atributo de la página visible
+    NextionShadow shadow;
+
+    // Comandos pendientes de escribir al UART
+    NextionFrame frame;
+    uint8_t frameDepth;
+    NextionFormat::Writer valueWriter;
+
+    // Escrituras pendientes de respuesta (bkcmd=3)
+    NextionAckQueue acks;
+
+    // Mensajes del panel y consultas get pendientes de respuesta
+    NextionParser parser;
+    NextionQueryQueue queries;
+
+    // Velocidad negociada (0 = panel sin responder), vigilancia del enlace
+    // y reconexión en curso (un paso por update())
+    uint32_t linkBaud;
+    NextionBaud::LinkMonitor linkMonitor;
+    NextionBaud::LinkRecovery linkRecovery;
+
+    void showPage(uint8_t page);
+    void writeCommand(const char* cmd);
+    void flushFrame();
+    void processAcks();
+    void checkLink();
+    void restorePanel();
 
-    // Procesamiento de eventos touch
+    // Procesamiento de mensajes del panel
     void processSerialData();
-    void parseEvent();
+    void handleEvent(const NextionParser::Event& event);
+    void handleResult(uint8_t code);
+    void handleAnswer(bool answered);
+    bool sendQuery(const char* variable);
 
     // Helpers para formateo
-    void formatTime(uint16_t seconds, char* buffer, size_t bufferSize);
     const char* getPhaseText(uint8_t phase);
     const char* getWaterTypeText(WaterType type);
 };
@@ -0,0 +1,28 @@
+#ifndef ONEWIRE_BUS_H
+#define ONEWIRE_BUS_H
+
+// ========================================
+// SELECCIÓN DEL BACKEND ONEWIRE
+// ========================================
+// ONEWIRE_USE_RMT=1 (platformio.ini) usa el periférico RMT en lugar del
+// bit-banging de la librería OneWire. Ambos tienen la misma interfaz.
+
+#ifndef ONEWIRE_USE_RMT
+#define ONEWIRE_USE_RMT 0
+#endif
+
+#if ONEWIRE_USE_RMT
+#include "OneWireRmt.h"
+typedef OneWireRmt OneWireBus;
+
+// Tiempo de transacción en que la CPU estuvo libre (esperando al RMT)
+inline uint32_t oneWireBlockedUs(const OneWireRmt& bus) { return bus.getBlockedUs(); }
+#else
+#include <OneWire.h>
+typedef OneWire OneWireBus;
+
+// Bit-banging: todo el tiempo de bus es espera activa de la CPU
+inline uint32_t oneWireBlockedUs(const OneWire&) { return 0; }
+#endif
+
+#endif // ONEWIRE_BUS_H
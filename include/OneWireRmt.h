@@ -0,0 +1,92 @@
+#ifndef ONEWIRE_RMT_H
+#define ONEWIRE_RMT_H
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include <freertos/ringbuf.h>
+
+// ========================================
+// ONEWIRE CON EL PERIFÉRICO RMT DEL ESP32
+// ========================================
+// Misma interfaz que la librería OneWire, pero los pulsos de reset y los time
+// slots los genera (TX) y mide (RX) el RMT: la CPU no hace bit-banging ni
+// deshabilita interrupciones. Mientras el RMT trabaja, la tarea que llama
+// queda bloqueada en un semáforo y el resto del sistema sigue corriendo.
+// Un canal TX y uno RX comparten el pin en modo open-drain (pull-up externo).
+// No soporta alimentación parásita (power/depower se ignoran).
+
+#ifndef ONEWIRE_RMT_TX_CHANNEL
+#define ONEWIRE_RMT_TX_CHANNEL RMT_CHANNEL_2
+#endif
+#ifndef ONEWIRE_RMT_RX_CHANNEL
+#define ONEWIRE_RMT_RX_CHANNEL RMT_CHANNEL_3
+#endif
+
+class OneWireRmt {
+public:
+    explicit OneWireRmt(uint8_t pin,
+                        rmt_channel_t txChannel = ONEWIRE_RMT_TX_CHANNEL,
+                        rmt_channel_t rxChannel = ONEWIRE_RMT_RX_CHANNEL);
+
+    void begin(uint8_t pin);
+
+    // Interfaz OneWire
+    uint8_t reset(void);
+    void select(const uint8_t rom[8]);
+    void skip(void);
+    void write(uint8_t v, uint8_t power = 0);
+    void write_bytes(const uint8_t* buf, uint16_t count, bool power = 0);
+    uint8_t read(void);
+    void read_bytes(uint8_t* buf, uint16_t count);
+    void write_bit(uint8_t v);
+    uint8_t read_bit(void);
+    void depower(void) {}
+    void reset_search();
+    void target_search(uint8_t family_code);
+    bool search(uint8_t* newAddr, bool search_mode = true);
+    static uint8_t crc8(const uint8_t* addr, uint8_t len);
+
+    // Tiempo total en transacciones y parte bloqueada esperando al RMT (µs).
+    // La diferencia es el tiempo de CPU realmente consumido.
+    uint32_t getBusUs() const { return busUs; }
+    uint32_t getBlockedUs() const { return blockedUs; }
+
+private:
+    // Tiempos estándar (µs, tick de 1 µs)
+    static constexpr uint16_t RESET_LOW_US = 480;
+    static constexpr uint16_t RESET_RELEASE_US = 70;
+    static constexpr uint16_t RESET_IDLE_US = RESET_LOW_US + 20;
+    static constexpr uint16_t SLOT_US = 70;
+    static constexpr uint16_t WRITE1_LOW_US = 6;
+    static constexpr uint16_t WRITE0_LOW_US = 60;
+    static constexpr uint16_t READ_LOW_US = 6;
+    static constexpr uint16_t READ_SAMPLE_US = 15;   // Bajo más tiempo = el esclavo envía 0
+    static constexpr uint16_t SLOT_IDLE_US = SLOT_US + 10;
+    static constexpr uint8_t MAX_SLOTS = 32;          // Slots por transacción RX (memoria RMT)
+    static constexpr uint32_t RX_TIMEOUT_MS = 5;
+
+    uint8_t pin;
+    rmt_channel_t txChannel;
+    rmt_channel_t rxChannel;
+    RingbufHandle_t rxRing;
+    bool initialized;
+
+    uint32_t busUs;
+    uint32_t blockedUs;
+
+    // Estado de búsqueda (algoritmo de Maxim, igual que OneWire)
+    uint8_t romNo[8];
+    uint8_t lastDiscrepancy;
+    uint8_t lastFamilyDiscrepancy;
+    bool lastDeviceFlag;
+
+    bool init();
+    void transmit(const rmt_item32_t* items, size_t count);
+    size_t exchange(const rmt_item32_t* items, size_t count, uint16_t idleUs, rmt_item32_t** rx);
+    void readSlots(uint8_t* bits, uint8_t count);
+
+    static rmt_item32_t writeSlot(uint8_t bit);
+    static rmt_item32_t readSlot();
+};
+
+#endif // ONEWIRE_RMT_H
@@ -0,0 +1,79 @@
+#ifndef PRESSURE_ACQUISITION_H
+#define PRESSURE_ACQUISITION_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "PressureSensor.h"
+#include "SpscQueue.h"
+
+// Muestra cruda con marca de tiempo del flanco de DOUT (o ALERT/RDY del ADS1115)
+struct PressureSample {
+    long raw;               // Cuentas de 24 bits con signo extendido (escala HX710B)
+    uint32_t timestampUs;   // micros() en el flanco de bajada
+};
+
+// ========================================
+// ADQUISICIÓN DE PRESIÓN POR INTERRUPCIÓN
+// ========================================
+// Un flanco de bajada en DOUT (conversión lista) despierta una tarea FreeRTOS
+// dedicada que lee los 24 bits y encola la muestra. loop() solo vacía la cola.
+// Con el ADS1115 el flanco es el pulso de ALERT/RDY y la lectura va por I2C.
+
+class PressureAcquisition {
+public:
+    struct Stats {
+        uint32_t samples;    // Muestras encoladas
+        uint32_t dropped;    // Muestras descartadas por cola llena
+        uint32_t overruns;   // Conversiones perdidas (la tarea no leyó a tiempo)
+        uint32_t timeouts;   // Esperas sin flanco (sensor ausente o flanco perdido)
+        uint32_t readErrors; // Lecturas fallidas (I2C del ADS1115)
+        uint32_t lastReadUs; // Duración de la lectura (comparación entre frentes)
+        uint32_t maxReadUs;
+    };
+
+    explicit PressureAcquisition(PressureSensor& sensor);
+
+    // Crea la tarea y engancha la interrupción (llamar tras sensor.begin())
+    bool begin();
+
+    // Consumidor (loop()): extrae la siguiente muestra si existe
+    bool pop(PressureSample& sample) { return queue.pop(sample); }
+    void clear() { queue.clear(); }
+    size_t pending() const { return queue.size(); }
+
+    Stats getStats() const;
+    bool isRunning() const { return taskHandle != nullptr; }
+
+    // Periodo nominal del sensor (lento o rápido) para detectar conversiones perdidas
+    void setSamplePeriodUs(uint32_t periodUs) { samplePeriodUs = periodUs; }
+
+private:
+    PressureSensor& sensor;
+    SpscQueue<PressureSample, SensorConfig::PRESSURE_QUEUE_SIZE> queue;
+    TaskHandle_t taskHandle;
+    portMUX_TYPE mux;
+
+    // Compartidos con la ISR
+    volatile bool busy;                  // Lectura en curso: ignorar flancos del desplazamiento
+    volatile uint32_t edgeTimestampUs;
+    volatile uint32_t samplePeriodUs;
+
+    // Escritos solo por la tarea
+    volatile uint32_t samples;
+    volatile uint32_t dropped;
+    volatile uint32_t overruns;
+    volatile uint32_t timeouts;
+    volatile uint32_t readErrors;
+    volatile uint32_t lastReadUs;
+    volatile uint32_t maxReadUs;
+    uint32_t lastTimestampUs;
+    bool hasLastTimestamp;
+
+    static void IRAM_ATTR onDataReady(void* arg);
+    static void taskEntry(void* arg);
+    void run();
+    bool claim();
+    void acquire(uint32_t timestampUs);
+};
+
+#endif // PRESSURE_ACQUISITION_H
@@ -0,0 +1,160 @@
+#ifndef PRESSURE_FILTER_H
+#define PRESSURE_FILTER_H
+
+#include <stdint.h>
+#include "Config.h"
+#include "PressureMath.h"
+
+// ========================================
+// BANCO DE FILTROS DE PRESIÓN
+// ========================================
+// Etapas por muestra cruda del HX710B (cuentas, sin float ni heap):
+//  1. Mediana de N: elimina picos aislados (burbujas, ruido eléctrico)
+//  2. EMA entera: suaviza con alpha = 1/2^shift
+//  3. Histéresis por nivel: subir al cruzar el umbral, bajar solo al caer
+//     una banda por debajo, para que el nivel no parpadee en la frontera
+
+template <uint8_t N>
+class MedianFilter {
+    static_assert(N >= 1 && N <= 9, "MedianFilter: N entre 1 y 9");
+
+public:
+    MedianFilter() : index(0), count(0) {}
+
+    int32_t add(int32_t sample) {
+        ring[index] = sample;
+        index = (index + 1) % N;
+        if (count < N) count++;
+
+        // Ordenar una copia (inserción; N pequeño)
+        int32_t sorted[N];
+        for (uint8_t i = 0; i < count; i++) {
+            int32_t v = ring[i];
+            uint8_t j = i;
+            while (j > 0 && sorted[j - 1] > v) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = v;
+        }
+        return sorted[count / 2];
+    }
+
+    void reset() { index = 0; count = 0; }
+
+private:
+    int32_t ring[N];
+    uint8_t index;
+    uint8_t count;
+};
+
+class EmaFilter {
+public:
+    // Bits fraccionarios del estado: 2^23 << 6 cabe en int32
+    static constexpr uint8_t FRAC_BITS = 6;
+
+    explicit EmaFilter(uint8_t shift) : shift(shift), stateQ(0), primed(false) {}
+
+    int32_t add(int32_t sample) {
+        int32_t valueQ = sample * (1L << FRAC_BITS);
+        if (!primed) {
+            stateQ = valueQ;
+            primed = true;
+        } else {
+            stateQ += (valueQ - stateQ) >> shift;
+        }
+        return value();
+    }
+
+    int32_t value() const { return stateQ >> FRAC_BITS; }
+    bool isPrimed() const { return primed; }
+    void reset() { primed = false; }
+
+private:
+    uint8_t shift;
+    int32_t stateQ;
+    bool primed;
+};
+
+class LevelHysteresis {
+public:
+    explicit LevelHysteresis(int32_t bandCounts) : band(bandCounts), level(0), primed(false) {}
+
+    uint8_t update(int32_t raw, const PressureMath::LevelTable& table) {
+        if (!primed) {
+            level = PressureMath::levelFromRaw(raw, table);
+            primed = true;
+            return level;
+        }
+        while (level < PressureMath::LEVEL_COUNT && raw >= table.raw[level]) {
+            level++;
+        }
+        while (level > 0 && raw < table.raw[level - 1] - band) {
+            level--;
+        }
+        return level;
+    }
+
+    uint8_t getLevel() const { return level; }
+    void reset() { primed = false; level = 0; }
+
+private:
+    int32_t band;
+    uint8_t level;
+    bool primed;
+};
+
+class PressureFilter {
+public:
+    // Banda de histéresis en cuentas: Pa * 2^21 / 125
+    static constexpr int32_t HYSTERESIS_COUNTS =
+        (int32_t)(((int64_t)SensorConfig::PRESSURE_LEVEL_HYSTERESIS << PressureMath::PASCAL_Q_SHIFT) /
+                  PressureMath::PASCAL_PER_COUNT_Q);
+
+    // Muestras hasta que la salida sigue a la entrada: mediana llena y tres
+    // constantes de tiempo de la EMA (~95 % de un escalón)
+    static constexpr uint16_t PRIME_SAMPLES =
+        SensorConfig::PRESSURE_MEDIAN_SIZE + 3 * (1u << SensorConfig::PRESSURE_EMA_SHIFT);
+
+    PressureFilter()
+        : ema(SensorConfig::PRESSURE_EMA_SHIFT),
+          hysteresis(HYSTERESIS_COUNTS),
+          filtered(0),
+          samples(0) {}
+
+    // Procesa una muestra cruda; devuelve el valor filtrado (cuentas)
+    int32_t add(int32_t raw) {
+        filtered = ema.add(median.add(raw));
+        if (samples < PRIME_SAMPLES) samples++;
+        return filtered;
+    }
+
+    // Nivel con histéresis a partir del último valor filtrado
+    uint8_t updateLevel(const PressureMath::LevelTable& table) {
+        return hysteresis.update(filtered, table);
+    }
+
+    int32_t value() const { return filtered; }
+    bool hasValue() const { return ema.isPrimed(); }
+    bool isPrimed() const { return samples >= PRIME_SAMPLES; }
+    uint8_t getLevel() const { return hysteresis.getLevel(); }
+
+    // Olvida el nivel con histéresis (p.ej. al cambiar los umbrales)
+    void resetLevel() { hysteresis.reset(); }
+
+    void reset() {
+        median.reset();
+        ema.reset();
+        hysteresis.reset();
+        samples = 0;
+    }
+
+private:
+    MedianFilter<SensorConfig::PRESSURE_MEDIAN_SIZE> median;
+    EmaFilter ema;
+    LevelHysteresis hysteresis;
+    int32_t filtered;
+    uint16_t samples;
+};
+
+#endif // PRESSURE_FILTER_H
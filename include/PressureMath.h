@@ -0,0 +1,120 @@
+#ifndef PRESSURE_MATH_H
+#define PRESSURE_MATH_H
+
+#include <stdint.h>
+#include "Config.h"
+
+// ========================================
+// CONVERSIÓN ENTERA: CUENTAS HX710B -> PRESIÓN -> NIVEL
+// ========================================
+// La ruta original hacía pascal() = raw*RES*200 + 500 en float, truncaba a long
+// y luego dividía en float entre umbrales. Aquí todo es entero:
+//  - Presión en Pa con escala Q21: RES*200 = 1000/2^24 = 125/2^21 Pa por cuenta.
+//  - Nivel comparando cuentas crudas contra umbrales calculados en compilación.
+
+namespace PressureMath {
+
+    // Mismo valor que HX710B::RES (float) para reproducir la ruta float exacta
+    constexpr float HX710B_RES = static_cast<float>(2.98023e-7);
+
+    // Escala Q21: Pa = 500 + raw * 125 / 2^21 (raw * 125 cabe en int32 para 24 bits)
+    constexpr uint8_t PASCAL_Q_SHIFT = 21;
+    constexpr int32_t PASCAL_PER_COUNT_Q = 125;
+    constexpr int32_t PASCAL_ZERO = 500;
+
+    constexpr uint8_t LEVEL_COUNT = 4;
+
+    struct LevelTable {
+        int32_t raw[LEVEL_COUNT];  // Cuenta mínima para alcanzar nivel i+1
+    };
+
+    // Ruta float original (referencia): HX710B::to_pascal() truncado a long
+    constexpr long pascalFromRawFloat(long raw) {
+        return (long)((raw * HX710B_RES) * 200 + 500);
+    }
+
+    // Ruta entera (Q21). El desplazamiento redondea hacia -inf; para presiones
+    // positivas coincide con la truncación de la ruta float (±1 Pa por redondeo de RES).
+    constexpr int32_t pascalFromRaw(int32_t raw) {
+        return PASCAL_ZERO + ((raw * PASCAL_PER_COUNT_Q) >> PASCAL_Q_SHIFT);
+    }
+
+    // Diferencia de presión (Pa) expresada en cuentas
+    constexpr int32_t rawFromPascalDelta(int32_t pascal) {
+        return (int32_t)(((int64_t)pascal << PASCAL_Q_SHIFT) / PASCAL_PER_COUNT_Q);
+    }
+
+    // Salida del transductor al final del span y PGA del ADS1115: el menor
+    // rango (±mV) que la cubre, para no desperdiciar códigos
+    constexpr uint32_t ADS1115_SPAN_UV = (uint32_t)SensorConfig::ADS1115_MV_PER_KPA *
+                                         SensorConfig::ADS1115_SPAN_PA;
+    constexpr uint16_t ADS1115_MAX_MV = SensorConfig::ADS1115_ZERO_MV + ADS1115_SPAN_UV / 1000;
+    constexpr uint16_t ads1115FsrMv(uint16_t maxMv) {
+        return maxMv <= 256 ? 256 : maxMv <= 512 ? 512 : maxMv <= 1024 ? 1024 :
+               maxMv <= 2048 ? 2048 : maxMv <= 4096 ? 4096 : 6144;
+    }
+    constexpr uint16_t ADS1115_FSR_MV = ads1115FsrMv(ADS1115_MAX_MV);
+    static_assert(ADS1115_MAX_MV <= 3300, "La entrada del ADS1115 (3.3 V) no llega al final del span");
+
+    // Código del ADS1115 (16 bits, ±ADS1115_FSR_MV) a cuentas equivalentes
+    // del HX710B: 0 Pa -> 0 cuentas y el final del span -> ADS1115_SPAN_RAW
+    // (2^22), así pascalFromRaw() va de PASCAL_ZERO a PASCAL_ZERO + 250 en el
+    // span. Todo el rango del PGA entra sin llegar al tope de 24 bits: el
+    // final del span no se confunde con saturación en FaultMonitor.
+    constexpr int32_t ADS1115_SPAN_RAW = 1L << 22;
+    static_assert((int64_t)(ADS1115_FSR_MV + SensorConfig::ADS1115_ZERO_MV) * 1000 < 2 * (int64_t)ADS1115_SPAN_UV,
+                  "El rango del PGA no entra en 24 bits con el span en 2^22");
+    constexpr int32_t rawFromAds1115(int16_t code) {
+        // µV x 32768 sobre la salida a 0 Pa
+        int64_t uvScaled = (int64_t)code * ADS1115_FSR_MV * 1000 -
+                           (int64_t)SensorConfig::ADS1115_ZERO_MV * 1000 * 32768;
+        // cuentas = µV x 2^22 / µV del span (el 2^15 se simplifica)
+        int64_t raw = uvScaled * (ADS1115_SPAN_RAW >> 15) / (int64_t)ADS1115_SPAN_UV;
+        constexpr int32_t RAW_MAX = (1L << 23) - 1;
+        return raw > RAW_MAX ? RAW_MAX : (raw < -RAW_MAX - 1 ? -RAW_MAX - 1 : (int32_t)raw);
+    }
+
+    // Cuenta cruda mínima con pascalFromRawFloat(raw) >= pascal.
+    // Estimación entera y ajuste fino contra la ruta float (es monótona).
+    constexpr int32_t rawThresholdForPascal(int32_t pascal) {
+        int32_t raw = (int32_t)(((int64_t)(pascal - PASCAL_ZERO) << PASCAL_Q_SHIFT) / PASCAL_PER_COUNT_Q);
+        while (pascalFromRawFloat(raw) >= pascal) raw--;
+        while (pascalFromRawFloat(raw) < pascal) raw++;
+        return raw;
+    }
+
+    // Umbrales crudos a partir de los niveles en Pa (relativos al offset de vacío)
+    constexpr LevelTable makeLevelTable(long offsetPascal) {
+        LevelTable table = {};
+        const uint16_t levels[LEVEL_COUNT] = {
+            SensorConfig::PRESSURE_LEVEL_1,
+            SensorConfig::PRESSURE_LEVEL_2,
+            SensorConfig::PRESSURE_LEVEL_3,
+            SensorConfig::PRESSURE_LEVEL_4
+        };
+        for (uint8_t i = 0; i < LEVEL_COUNT; i++) {
+            table.raw[i] = rawThresholdForPascal((int32_t)(levels[i] + offsetPascal));
+        }
+        return table;
+    }
+
+    // Nivel 0..4 = cantidad de umbrales alcanzados (igual que la interpolación
+    // truncada de la ruta float, que siempre devolvía el nivel inferior del tramo)
+    inline uint8_t levelFromRaw(int32_t raw, const LevelTable& table) {
+        uint8_t level = 0;
+        while (level < LEVEL_COUNT && raw >= table.raw[level]) {
+            level++;
+        }
+        return level;
+    }
+
+    // Tabla por defecto, calculada en compilación desde SensorConfig
+    constexpr LevelTable DEFAULT_LEVEL_TABLE = makeLevelTable(SensorConfig::PRESSURE_OFFSET);
+
+    static_assert(DEFAULT_LEVEL_TABLE.raw[0] < DEFAULT_LEVEL_TABLE.raw[1] &&
+                  DEFAULT_LEVEL_TABLE.raw[1] < DEFAULT_LEVEL_TABLE.raw[2] &&
+                  DEFAULT_LEVEL_TABLE.raw[2] < DEFAULT_LEVEL_TABLE.raw[3],
+                  "PRESSURE_LEVEL_1..4 deben ser crecientes");
+}
+
+#endif // PRESSURE_MATH_H
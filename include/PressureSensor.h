@@ -0,0 +1,60 @@
+#ifndef PRESSURE_SENSOR_H
+#define PRESSURE_SENSOR_H
+
+#include "Config.h"
+
+// ========================================
+// SELECCIÓN DEL FRENTE DE PRESIÓN
+// ========================================
+// PRESSURE_USE_ADS1115=1 (platformio.ini) usa un ADS1115 por I2C en lugar
+// del HX710B. Ambos tienen la misma interfaz para PressureAcquisition y
+// SensorManager y entregan cuentas en la escala del HX710B; lo que difiere
+// (arranque, tasa, lectura con error) queda en estas funciones.
+
+#if PRESSURE_USE_ADS1115
+#include "Ads1115Pressure.h"
+typedef Ads1115Pressure PressureSensor;
+
+constexpr const char* PRESSURE_SENSOR_NAME = "ADS1115";
+
+inline bool beginPressureSensor(Ads1115Pressure& sensor) {
+    return sensor.begin(HardwarePins::PRESSURE_DOUT, HardwarePins::PRESSURE_SDA,
+                        HardwarePins::PRESSURE_SCL, Ads1115Pressure::RATE_16_SPS);
+}
+
+inline void setPressureSensorFast(Ads1115Pressure& sensor, bool fast) {
+    sensor.set_data_rate(fast ? Ads1115Pressure::RATE_64_SPS : Ads1115Pressure::RATE_16_SPS);
+}
+
+// Conversión ya lista (flanco de ALERT/RDY); false = error de I2C
+inline bool readPressureSensor(Ads1115Pressure& sensor, long& value) {
+    return sensor.read_conversion(value);
+}
+
+static_assert(Ads1115Pressure::periodUs(Ads1115Pressure::RATE_16_SPS) == SensorConfig::PRESSURE_SAMPLE_PERIOD_US &&
+              Ads1115Pressure::periodUs(Ads1115Pressure::RATE_64_SPS) == SensorConfig::PRESSURE_FAST_PERIOD_US,
+              "Los periodos de SensorConfig deben coincidir con las tasas del ADS1115");
+#else
+#include <HX710B.h>
+typedef HX710B PressureSensor;
+
+constexpr const char* PRESSURE_SENSOR_NAME = "HX710B";
+
+inline bool beginPressureSensor(HX710B& sensor) {
+    sensor.begin(HardwarePins::PRESSURE_DOUT, HardwarePins::PRESSURE_SCLK,
+                 HX710B_DIFF_10HZ);  // Coincide con PRESSURE_SAMPLE_PERIOD_US
+    return true;
+}
+
+inline void setPressureSensorFast(HX710B& sensor, bool fast) {
+    sensor.set_mode(fast ? HX710B_DIFF_40HZ : HX710B_DIFF_10HZ);
+}
+
+// DOUT ya está en LOW: read() no entra en la espera activa y no falla
+inline bool readPressureSensor(HX710B& sensor, long& value) {
+    value = sensor.read();
+    return true;
+}
+#endif
+
+#endif // PRESSURE_SENSOR_H
@@ -2,30 +2,184 @@
 #define SENSOR_MANAGER_H
 
 #include <Arduino.h>
-#include <OneWire.h>
-#include <DallasTemperature.h>
-#include <HX710B.h>
+#include "OneWireBus.h"
 #include "Config.h"
+#include "PressureSensor.h"
+#include "PressureAcquisition.h"
+#include "PressureFilter.h"
+#include "LevelCalibration.h"
+#include "FillRateEstimator.h"
+#include "TemperatureBus.h"
+#include "Seqlock.h"
+#include "FaultMonitor.h"
+
+// Instantánea de todos los sensores publicada en cada ciclo de adquisición.
+// Se lee completa y consistente (Seqlock), sin mezclar valores de dos ciclos.
+struct SensorSnapshot {
+    uint32_t timestampUs;       // micros() al publicar
+    bool monitoring;
+
+    // Presión / nivel
+    bool pressureValid;         // El filtro ya tiene valor
+    bool pressurePrimed;        // ... y ya sigue a la entrada (PressureFilter::PRIME_SAMPLES)
+    uint32_t pressureSampleUs;  // Marca de tiempo de la última muestra usada
+    long pressurePa;            // Promedio sin filtrar
+    long filteredPa;            // Mediana + EMA
+    int32_t filteredRaw;        // Cuentas filtradas (con corrección de cero)
+    int32_t fillRate;           // Cuentas/s
+    uint8_t waterLevel;
+    uint16_t waterLevelCenti;
+
+    // Temperatura (tambor y todos los sensores del bus)
+    bool temperatureValid;
+    float temperature;
+    unsigned long temperatureMs;  // millis() de la última lectura correcta del tambor
+    float sensorTemperatures[SensorConfig::TEMP_SENSOR_COUNT];
+    uint8_t sensorValidMask;      // Bit = TempSensorId
+    uint8_t alarmMask;
+    uint8_t temperatureResolution;
+    uint8_t sensorMissingMask;    // Puestos guardados que no respondieron a la búsqueda
+    uint8_t identifyState;        // TemperatureBus::IdentifyState
+    uint8_t assignmentVersion;    // Cambia al asignar una sonda (hay que guardar)
+
+    // Plan de muestreo vigente y tasas logradas en la última ventana de
+    // Sampling::RATE_WINDOW_MS (centésimas de Hz; 0 = aún sin medir en este modo)
+    uint8_t samplingMode;           // Sampling::Mode
+    uint16_t pressureRateCHz;       // Muestras de presión usadas
+    uint16_t levelRateCHz;          // Publicaciones de nivel
+    uint16_t temperatureRateCHz;    // Rondas DS18B20
+
+    uint8_t faultCode;              // Fault::Code retenido (NONE = sin falla)
+
+    // Muestras de presión durante la agitación (SensorManager::SloshStats)
+    uint32_t sloshAccepted;
+    uint32_t sloshRejected;
+
+    // Antigüedad de las muestras respecto de un instante dado
+    uint32_t pressureAgeMs(uint32_t nowUs) const { return (nowUs - pressureSampleUs) / 1000; }
+    uint32_t temperatureAgeMs(unsigned long nowMs) const { return nowMs - temperatureMs; }
+};
 
 class SensorManager {
 public:
+    // Periodo real de la tarea de adquisición
+    struct TaskStats {
+        uint32_t cycles;
+        uint32_t minPeriodUs;   // Entre activaciones consecutivas
+        uint32_t maxPeriodUs;
+        uint32_t maxJitterUs;   // |periodo - nominal| máximo
+        uint32_t meanJitterUs;
+        uint32_t lastWorkUs;    // Duración del último ciclo
+        uint32_t maxWorkUs;
+        uint32_t overruns;      // Ciclos más largos que el periodo
+    };
+
     SensorManager();
 
     void begin();
-    void update();
+    void update();  // Sin tarea: un ciclo de adquisición desde loop(); con tarea no hace nada
+
+    // Tarea de adquisición fija en SENSOR_TASK_CORE (llamar al terminar la
+    // inicialización de sensores). Desde ese momento loop() solo lee instantáneas.
+    bool beginTask();
+    bool isTaskRunning() const { return taskHandle != nullptr; }
+    TaskStats getTaskStats() const { return taskStats.read(); }
+
+    // Última instantánea publicada (sin bloqueo). Usarla cuando se necesitan
+    // varios valores coherentes entre sí; los getters de abajo leen cada uno
+    // su propia instantánea.
+    SensorSnapshot getSnapshot() const { return snapshot.read(); }
+
+    // Sensores de temperatura: verifica las direcciones guardadas (nullptr si
+    // no hay) o busca en el bus. Devuelve true si hay que guardar la asignación.
+    bool beginTemperature(const TemperatureBus::Address* savedAddresses);
 
     // Control de monitoreo (activar/desactivar sensores)
     void startMonitoring();
     void stopMonitoring();
     bool isMonitoring() const { return monitoringActive; }
 
-    // Lectura de temperatura
-    float getTemperature() const { return currentTemperature; }
-    bool isTemperatureReady() const { return temperatureValid; }
+    // Plan de muestreo (Sampling::PROFILES) pedido por StateMachine en cada
+    // ciclo. Sin monitoreo rige MODE_IDLE (latido lento).
+    void setSamplingMode(Sampling::Mode mode) { requestedMode = mode; }
+    Sampling::Mode getSamplingMode() const { return (Sampling::Mode)snapshot.read().samplingMode; }
+
+    // Lectura de temperatura (agua del tambor)
+    float getTemperature() const { return snapshot.read().temperature; }
+    bool isTemperatureReady() const { return snapshot.read().temperatureValid; }
+
+    // Consigna para la resolución adaptativa (NO_TEMP_TARGET = solo visualización)
+    static constexpr int16_t NO_TEMP_TARGET = -1;
+    void setTemperatureTarget(int16_t targetC) { temperatureTarget = targetC; }
+    uint8_t getTemperatureResolution() const { return snapshot.read().temperatureResolution; }
 
-    // Lectura de nivel de agua
-    uint8_t getWaterLevel() const { return currentWaterLevel; }
-    long getPressureRaw() const { return currentPressure; }
+    // Alarmas por hardware (TH del DS18B20): temperatura del proceso en curso
+    // o NO_TEMP_TARGET sin programa. Los límites se escriben entre rondas.
+    void setAlarmTemperature(int16_t processC) { alarmTemperature = processC; }
+    uint8_t getTemperatureAlarms() const { return snapshot.read().alarmMask; }  // Bit = TempSensorId
+    bool hasTemperatureAlarm() const { return getTemperatureAlarms() != 0; }
+
+    // Todos los sensores del bus (SensorConfig::TempSensorId)
+    float getSensorTemperature(uint8_t id) const { return snapshot.read().sensorTemperatures[id]; }
+    bool isSensorValid(uint8_t id) const { return (snapshot.read().sensorValidMask >> id) & 1; }
+    const TemperatureBus& getTemperatureBus() const { return tempBus; }  // Solo antes de beginTask()
+
+    // Asignación de una sonda libre a un puesto calentándola (el resultado se
+    // ve en SensorSnapshot::identifyState). Con la tarea en marcha, las
+    // direcciones para Storage se copian con copyTemperatureAddresses().
+    bool identifyTemperatureSensor(uint8_t id);
+    void cancelTemperatureIdentify();
+    void copyTemperatureAddresses(TemperatureBus::Address* out);
+
+    // Lectura de nivel de agua (nivel con histéresis, estable en los umbrales).
+    // Durante la agitación solo se actualiza con muestras de las pausas del
+    // motor, por lo que es un nivel libre de oleaje.
+    uint8_t getWaterLevel() const { return snapshot.read().waterLevel; }
+    long getPressureRaw() const { return snapshot.read().pressurePa; }       // Pa, promedio sin filtrar
+    long getFilteredPressure() const { return snapshot.read().filteredPa; }  // Pa, mediana + EMA
+    int32_t getFilteredRaw() const { return snapshot.read().filteredRaw; }   // Cuentas filtradas
+    uint16_t getWaterLevelCenti() const { return snapshot.read().waterLevelCenti; } // Nivel continuo x100
+
+    // Velocidad de llenado y tiempo estimado hasta un nivel (UINT32_MAX = desconocido)
+    int32_t getFillRate() const { return snapshot.read().fillRate; }  // Cuentas/s
+    uint32_t estimateMsToLevel(uint8_t targetLevel) const;
+    int32_t getLevelThresholdRaw(uint8_t targetLevel) const;
+
+    // Cerrar el llenado: nivel alcanzado, o se alcanzará dentro de latencyMs
+    // estando a menos de FILL_CUTOFF_MAX_LEAD_PCT de un paso de nivel
+    bool shouldStopFilling(uint8_t targetLevel, uint16_t latencyMs) const;
+
+    // Calibración de nivel por tramos (reemplaza los umbrales de Config.h)
+    bool setCalibration(const LevelCalibration& newCalibration);
+    const LevelCalibration& getCalibration() const { return calibration; }
+
+    // Seguimiento del cero: corrección en cuentas restada a cada muestra.
+    // trackZero() se llama con el tanque vacío; devuelve true si el offset cambió.
+    bool trackZero();
+    int32_t getZeroOffset() const { return zeroOffset; }
+    void setZeroOffset(int32_t offset);
+
+    // Muestreo sincronizado con la agitación (lo actualiza StateMachine en cada ciclo)
+    struct SloshStats {
+        uint32_t accepted;  // Muestras usadas durante la agitación
+        uint32_t rejected;  // Muestras descartadas por oleaje
+    };
+    void setAgitation(bool agitating, bool settled);
+    bool isLevelSettled() const {
+        uint8_t request = requestedAgitation;
+        return !(request & AGITATION_ON) || (request & AGITATION_SETTLED);
+    }
+    SloshStats getSloshStats() const {
+        SensorSnapshot s = snapshot.read();
+        return SloshStats{s.sloshAccepted, s.sloshRejected};
+    }
+
+    // Estadísticas de la tarea de adquisición de presión
+    PressureAcquisition::Stats getPressureStats() const { return pressureAcq.getStats(); }
+    uint32_t getLastPressureSampleUs() const { return snapshot.read().pressureSampleUs; }
+
+    // Falla de sensor retenida desde el último startMonitoring() (Fault::NONE = sin falla)
+    Fault::Code getFault() const { return (Fault::Code)snapshot.read().faultCode; }
 
     // Verificaciones de estado
     bool hasReachedLevel(uint8_t targetLevel) const;
@@ -38,27 +192,102 @@ public:
 
 private:
     // Control de monitoreo
-    bool monitoringActive;
+    volatile bool monitoringActive;
+
+    // Tarea de adquisición. Lo que la tarea escribe se publica en 'snapshot';
+    // los comandos poco frecuentes desde loop() (monitoreo, cero, calibración)
+    // toman stateMutex, que la tarea retiene durante cada ciclo.
+    TaskHandle_t taskHandle;
+    SemaphoreHandle_t stateMutex;
+    Seqlock<SensorSnapshot> snapshot;
+    Seqlock<TaskStats> taskStats;
+    TaskStats cycleStats;            // Copia de trabajo de la tarea
+    uint64_t jitterSumUs;
+    uint32_t lastCycleStartUs;
+
+    // Plan de muestreo
+    struct RateCounter {
+        uint32_t pressureSamples;
+        uint32_t levelUpdates;
+        uint32_t temperatureRounds;
+        unsigned long windowStartMs;
+    };
+    volatile uint8_t requestedMode;
+    uint8_t samplingMode;            // Modo aplicado (MODE_COUNT = ninguno aún)
+    bool sampleTaken;                // Hay una muestra usada en el modo actual
+    uint32_t lastSampleTakenUs;      // Para la separación mínima del perfil
+    uint32_t lastFillRateMs;
+    RateCounter rateCounter;
+    uint16_t pressureRateCHz;
+    uint16_t levelRateCHz;
+    uint16_t temperatureRateCHz;
 
     // Sensor de temperatura
-    OneWire oneWire;
-    DallasTemperature tempSensor;
+    OneWireBus oneWire;             // Bit-banging o RMT (ONEWIRE_USE_RMT)
+    TemperatureBus tempBus;         // Rondas de conversión + lectura por plazo
     float currentTemperature;
     bool temperatureValid;
-    unsigned long lastTempRead;
-    bool tempSensorFound;
-    bool tempConversionInProgress;  // Flag para lectura asíncrona
+    uint32_t lastTempRound;         // Ronda del bus ya publicada
+    volatile int16_t temperatureTarget;
+    volatile int16_t alarmTemperature;
 
     // Sensor de presión/nivel
-    HX710B pressureSensor;
+    PressureSensor pressureSensor;   // HX710B o ADS1115 (PRESSURE_USE_ADS1115)
     long currentPressure;
+    long filteredPressure;
+    PressureFilter pressureFilter;
     uint8_t currentWaterLevel;
-    unsigned long lastPressureRead;
+    uint16_t currentWaterLevelCenti;
+    LevelCalibration calibration;
+    PressureMath::LevelTable levelTable;
+    unsigned long lastPressureRead;  // Última publicación de promedio
+    PressureAcquisition pressureAcq;
+    uint32_t lastPressureSampleUs;   // Marca de tiempo de la última muestra consumida
+    uint64_t pressureClockUs;        // Reloj de muestras sin desborde (para la regresión)
+    FillRateEstimator fillRate;
+
+    // Seguimiento del cero
+    int32_t zeroOffset;      // Corrección base (cuentas, a ZERO_TEMP_REF_C)
+    int32_t zeroCorrection;  // Corrección vigente (base + término de temperatura)
+
+    // Plausibilidad de las muestras (rango, congelado, saltos, sin datos)
+    FaultMonitor faults;
+
+    // Sincronización con la agitación (pedida desde loop(), aplicada por la
+    // tarea). Los dos flags en una sola escritura: la tarea nunca ve uno nuevo
+    // con el otro viejo.
+    static constexpr uint8_t AGITATION_ON = 0x01;
+    static constexpr uint8_t AGITATION_SETTLED = 0x02;
+    volatile uint8_t requestedAgitation;
+    bool agitationActive;
+    bool agitationSettled;
+    uint32_t settledSinceUs;  // Inicio de la ventana quieta (en micros)
+    SloshStats sloshStats;
 
     // Métodos privados
+    static void taskEntry(void* arg);
+    void run();
+    void runCycle();
+    void recordCycle(uint32_t startUs, uint32_t workUs);
+    void publishSnapshot();
+    void lock();
+    void unlock();
+    void applyAgitation();
+    void applySamplingMode();
+    bool takePressureSample(uint32_t timestampUs);
+    void updateSamplingRates(unsigned long nowMs);
+    bool estimateZeroOffset();
+    void applyZeroOffset(int32_t offset);
     void readTemperature();
+    uint8_t selectTemperatureResolution() const;
+    void updateAlarmLimits();
     void readPressure();
-    uint8_t calculateWaterLevel(long pressure);
+    void drainPressureQueue();
+    void processPressureSample(int32_t raw, uint32_t timestampUs);
+    bool acceptPressureSample(uint32_t timestampUs);
+    void updateZeroCorrection();
+    void publishPressure();
+    uint8_t calculateWaterLevel();
 };
 
 #endif // SENSOR_MANAGER_H
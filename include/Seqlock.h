@@ -0,0 +1,59 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// ========================================
+// SEQLOCK CON DOBLE BUFFER (un escritor, varios lectores)
+// ========================================
+// Publica un valor completo (p.ej. una instantánea de sensores) desde una
+// tarea hacia otras sin locks. El escritor alterna entre dos copias: mientras
+// escribe una, el contador de secuencia dirige a los lectores a la otra. Así
+// un lector nunca espera a un escritor desalojado a mitad de la escritura
+// (en el mismo core) y solo reintenta si la copia cambió mientras la leía.
+// T debe ser trivialmente copiable. No usa memoria dinámica.
+
+template <typename T>
+class Seqlock {
+public:
+    Seqlock() : sequence(0), buffer{} {}
+
+    // Escritor (una sola tarea)
+    void write(const T& value) {
+        uint32_t s = sequence.load(std::memory_order_relaxed);
+
+        // Impar: los lectores van a buffer[1] mientras se escribe buffer[0]
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        buffer[0] = value;
+
+        // Par: los lectores vuelven a buffer[0] (ya nuevo) y se escribe buffer[1]
+        sequence.store(s + 2, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        buffer[1] = value;
+    }
+
+    // Lectores: copia consistente del último valor publicado
+    T read() const {
+        T value;
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            value = buffer[before & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while (before != after);
+        return value;
+    }
+
+    // Publicaciones hechas (cambia cada vez que hay un valor nuevo)
+    uint32_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<uint32_t> sequence;
+    T buffer[2];
+};
+
+#endif // SEQLOCK_H
@@ -0,0 +1,60 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// ========================================
+// COLA SPSC SIN BLOQUEO (un productor, un consumidor)
+// ========================================
+// Buffer circular de tamaño fijo. push() solo se llama desde el productor
+// (p.ej. una tarea de adquisición) y pop() solo desde el consumidor (loop()).
+// No usa locks ni memoria dinámica.
+
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue: N debe ser potencia de 2");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // Productor: false si la cola está llena (el elemento se descarta)
+    bool push(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        buffer[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: false si la cola está vacía
+    bool pop(T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = buffer[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: descartar todo lo pendiente
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    T buffer[N];
+    std::atomic<size_t> head;  // Escrito solo por el productor
+    std::atomic<size_t> tail;  // Escrito solo por el consumidor
+};
+
+#endif // SPSC_QUEUE_H
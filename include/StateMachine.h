@@ -18,7 +18,8 @@ enum SystemState {
     STATE_PAUSED,
     STATE_COMPLETED,
     STATE_ERROR,
-    STATE_EMERGENCY
+    STATE_EMERGENCY,
+    STATE_CALIBRATION   // Captura de puntos de calibración de nivel
 };
 
 // Estructura para almacenar configuración del programa actual
@@ -50,6 +51,10 @@ public:
     void setState(SystemState newState);
     SystemState getState() const { return currentState; }
 
+    // Error con motivo para la UI (pasa a STATE_ERROR: apagado de emergencia)
+    void raiseError(const char* message);
+    const char* getErrorMessage() const { return errorMessage; }
+
     // Control de programa
     void selectProgram(uint8_t programNum);
     void startProgram();
@@ -58,6 +63,19 @@ public:
     void stopProgram();
     void emergencyStop();
 
+    // Calibración de nivel (tanque lleno de forma manual desde la UI)
+    void startCalibration();
+    void stopCalibration();
+
+    // Llenado de calibración (agua fría): se corta solo al nivel máximo, al
+    // vencer Timing::CALIBRATION_FILL_MAX_SEC o ante una falla de sensor
+    void setCalibrationFill(bool on);
+    bool isCalibrationFilling() const { return calibrationFilling; }
+
+    // Mensaje de estado de la página de calibración (literal; nullptr = ninguno)
+    void setCalibrationStatus(const char* status) { calibrationStatus = status; }
+    const char* getCalibrationStatus() const { return calibrationStatus; }
+
     // Acceso a configuración
     ProgramConfig& getConfig() { return config; }
 
@@ -68,6 +86,9 @@ public:
     uint16_t getTotalProgramTime() const;  // Tiempo total del programa en segundos (valor fijo calculado)
     bool isTimerActive() const;  // true si está en fase de lavado
 
+    // Corte predictivo de llenado (latencia válvula + sensado, aprendida)
+    uint16_t getFillLatencyMs() const { return fillLatencyMs; }
+
 private:
     SystemState currentState;
     SystemState previousState;
@@ -81,6 +102,21 @@ private:
     unsigned long totalPausedTime;
     unsigned long pausedPhaseElapsedTime;  // Tiempo transcurrido de la fase al pausar
 
+    // Medición del sobrepaso tras cerrar las válvulas de llenado
+    uint16_t fillLatencyMs;
+    bool overshootPending;
+    int32_t cutoffRaw;
+    int32_t cutoffRate;
+    unsigned long cutoffTime;
+
+    const char* errorMessage;  // Motivo del último STATE_ERROR (literal)
+    bool fillNearTarget;       // Llenado en MODE_FILL_NEAR
+
+    // Calibración
+    bool calibrationFilling;
+    unsigned long calibrationFillStart;
+    const char* calibrationStatus;
+
     // Métodos de actualización por estado
     void updateInit();
     void updateWelcome();
@@ -95,6 +131,7 @@ private:
     void updateCompleted();
     void updateError();
     void updateEmergency();
+    void updateCalibration();
 
     // Transiciones de fase
     void nextPhase();
@@ -104,6 +141,10 @@ private:
 
     // Helpers
     void resetTimers();
+    void startOvershootMeasurement();
+    void updateFillLatency();
+    void trackPressureZero();
+    Sampling::Mode selectSamplingMode();
     unsigned long getCurrentPhaseDuration() const;
 };
 
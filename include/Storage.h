@@ -5,6 +5,7 @@
 #include <Preferences.h>
 #include "Config.h"
 #include "StateMachine.h"
+#include "LevelCalibration.h"
 
 // ========================================
 // CLASE STORAGE - ALMACENAMIENTO PERSISTENTE
@@ -26,6 +27,27 @@ public:
     // Guardar configuración de un proceso específico
     bool saveProcess(uint8_t programNumber, uint8_t processIndex, const ProgramConfig& config);
 
+    // Calibración de nivel (tabla de puntos del sensor de presión)
+    bool saveCalibration(const LevelCalibration& calibration);
+    bool loadCalibration(LevelCalibration& calibration);
+    void clearCalibration();
+
+    // Latencia de corte de llenado aprendida (ms)
+    bool saveFillLatency(uint16_t latencyMs);
+    uint16_t loadFillLatency(uint16_t defaultMs);
+
+    // Corrección de cero del sensor de presión (cuentas)
+    bool saveZeroOffset(int32_t offset);
+    int32_t loadZeroOffset();
+
+    // Direcciones ROM de los sensores DS18B20 (puestos sin sensor = ceros)
+    bool saveTempAddresses(const uint8_t addresses[][8], uint8_t count);
+    bool loadTempAddresses(uint8_t addresses[][8], uint8_t count);
+
+    // Velocidad negociada con el Nextion (0 = sin negociar)
+    bool saveNextionBaud(uint32_t baud);
+    uint32_t loadNextionBaud();
+
     // Restaurar valores de fábrica
     void restoreDefaults();
 
@@ -0,0 +1,179 @@
+#ifndef TEMPERATURE_BUS_H
+#define TEMPERATURE_BUS_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "OneWireBus.h"
+#include "Ds18b20Reader.h"
+
+// ========================================
+// BUS DS18B20 CON VARIOS SENSORES CON NOMBRE
+// ========================================
+// Cada puesto (tambor, entrada, motor) tiene una dirección ROM asignada y
+// guardada en Storage; en un arranque en caliente solo se verifica que sigan
+// respondiendo. La búsqueda del bus no asigna puestos: el orden de búsqueda
+// no dice qué sonda es cuál. Las ROM sin puesto quedan libres hasta que el
+// operador identifica una calentándola (startIdentify), y un puesto cuya
+// sonda no aparece se conserva marcado como ausente.
+// Cada ronda lanza UNA conversión broadcast (Skip ROM) y, vencido el plazo,
+// lee un sensor por llamada a update() para repartir el tiempo de bus.
+// Antes de leer se hace una búsqueda de alarmas: con TH/TL programados en
+// cada sensor, solo responden los que están fuera de rango, así que un sensor
+// sin alarma no necesita leer su scratchpad (salvo el tambor, que se usa
+// para el control, y una lectura de control cada TEMP_SLOW_READ_ROUNDS).
+
+class TemperatureBus {
+public:
+    static_assert(SensorConfig::TEMP_SENSOR_COUNT <= 8, "Máscara de alarmas de 8 bits");
+
+    static constexpr uint8_t MAX_SENSORS = SensorConfig::TEMP_SENSOR_COUNT;
+    static constexpr uint8_t DS18B20_FAMILY = 0x28;
+    typedef uint8_t Address[8];
+
+    struct SensorStats {
+        uint32_t reads;             // Lecturas correctas
+        uint32_t errors;            // CRC inválido o sin respuesta
+        uint8_t consecutiveErrors;
+        uint16_t readUs;            // Duración de la última lectura del scratchpad
+        uint16_t maxReadUs;
+        uint16_t latencyMs;         // Inicio de la conversión -> dato disponible
+        unsigned long lastOkMs;     // millis() de la última lectura correcta
+    };
+
+    // Costo de bus de la última ronda (conversión + lecturas). Con bit-banging
+    // todo es CPU; con el backend RMT la CPU queda libre mientras espera.
+    struct RoundStats {
+        uint32_t busUs;
+        uint32_t cpuUs;
+    };
+
+    // Identificación de una sonda libre por calentamiento
+    enum IdentifyState : uint8_t {
+        IDENTIFY_IDLE = 0,
+        IDENTIFY_WAITING,   // Esperando que una sonda libre suba TEMP_IDENTIFY_RISE_C
+        IDENTIFY_DONE,      // Asignada (hay que guardar las direcciones)
+        IDENTIFY_FAILED     // Sin sondas libres o sin calentamiento a tiempo
+    };
+
+    explicit TemperatureBus(OneWireBus& wire);
+
+    // Cambio de resolución o de límites de alarma: se escribe en el scratchpad
+    // de cada sensor entre rondas, una transacción por llamada a update()
+    // (sin copia a EEPROM)
+    void requestResolution(uint8_t bits);
+    uint8_t getResolution() const { return reader.getResolution(); }
+    bool isResolutionPending() const { return targetResolution != reader.getResolution(); }
+    void setAlarmLimits(uint8_t index, int8_t high, int8_t low);
+    bool isConfigPending() const { return configPending; }
+
+    // Alarmas confirmadas (bit i = puesto i): el sensor respondió a la búsqueda
+    // de alarmas y su lectura está fuera de TH/TL (o no se pudo leer)
+    uint8_t getAlarmMask() const { return alarmMask; }
+    bool isAlarm(uint8_t index) const { return (alarmMask >> index) & 1; }
+    int8_t getAlarmHigh(uint8_t index) const { return alarmHigh[index]; }
+
+    // Asignación de direcciones
+    void setAddress(uint8_t index, const uint8_t* rom);
+    void clearAddress(uint8_t index);
+    const uint8_t* getAddress(uint8_t index) const { return addresses[index]; }
+    const Address* getAddresses() const { return addresses; }  // Para Storage
+    bool isAssigned(uint8_t index) const { return assigned[index]; }
+    uint8_t getSensorCount() const;
+
+    // Puesto asignado cuya sonda no respondió a la última búsqueda (se
+    // conserva: vuelve sola si era un conector flojo)
+    bool isMissing(uint8_t index) const { return missing[index]; }
+    uint8_t getMissingMask() const;
+    uint8_t getSpareCount() const { return spareCount; }  // ROM sin puesto
+
+    // Arranque en caliente: true si todas las direcciones asignadas responden
+    bool verify();
+
+    // Búsqueda completa del bus: marca los puestos ausentes y lista las ROM
+    // sin puesto. No cambia la asignación.
+    void discover();
+
+    // Asignar al puesto la sonda libre que el operador calienta: se busca en
+    // el bus, se toma la mínima de cada sonda libre en cada ronda y se asigna
+    // la única que sube TEMP_IDENTIFY_RISE_C. La anterior del puesto, si
+    // sigue en el bus, queda libre. false = sin sondas libres.
+    bool startIdentify(uint8_t index, unsigned long nowMs);
+    void cancelIdentify();
+    IdentifyState getIdentifyState() const { return identifyState; }
+    uint8_t getAssignmentVersion() const { return assignmentVersion; }  // Cambia al asignar
+
+    // Rondas de lectura (no bloqueante)
+    void update(unsigned long nowMs);
+    void cancel();
+    void setRoundInterval(uint16_t intervalMs) { roundIntervalMs = intervalMs; }
+    bool isRoundInProgress() const { return reader.isConverting(); }
+    uint32_t getRounds() const { return rounds; }  // Rondas terminadas (con o sin error)
+    const RoundStats& getLastRound() const { return lastRound; }
+
+    // Resolución y límites TH/TL en cada sensor asignado (arranque; solo se
+    // escriben donde el scratchpad no los tiene ya)
+    void applyResolution();
+
+    // Datos por sensor
+    bool isValid(uint8_t index) const { return valid[index]; }
+    float getTemperature(uint8_t index) const { return temperatures[index]; }
+    const SensorStats& getStats(uint8_t index) const { return stats[index]; }
+
+    static const char* getName(uint8_t index) { return SensorConfig::TEMP_SENSOR_NAMES[index]; }
+    static void printAddress(const uint8_t* rom);
+
+private:
+    OneWireBus& wire;
+    Ds18b20Reader reader;
+
+    static constexpr uint8_t MAX_SPARES = MAX_SENSORS * 2;  // Tope de la búsqueda
+
+    Address addresses[MAX_SENSORS];
+    bool assigned[MAX_SENSORS];
+    bool missing[MAX_SENSORS];
+    bool valid[MAX_SENSORS];
+    float temperatures[MAX_SENSORS];
+    SensorStats stats[MAX_SENSORS];
+
+    int8_t alarmHigh[MAX_SENSORS];  // TH/TL del scratchpad
+    int8_t alarmLow[MAX_SENSORS];
+    uint8_t targetResolution;       // Resolución a escribir en la próxima reconfiguración
+    bool configPending;
+    uint8_t nextWrite;              // Próximo puesto a reconfigurar
+
+    bool alarmSearchDone;           // Búsqueda de alarmas hecha en la ronda en curso
+    uint8_t alarmFlags;             // Puestos que respondieron a la búsqueda
+    uint8_t alarmMask;              // Alarmas confirmadas
+
+    Address spares[MAX_SPARES];     // ROM en el bus sin puesto
+    uint8_t spareCount;
+    float spareMin[MAX_SPARES];     // Mínima desde startIdentify (NAN = sin lectura)
+    IdentifyState identifyState;
+    uint8_t identifyIndex;
+    unsigned long identifyStartMs;
+    uint8_t assignmentVersion;
+
+    uint8_t nextRead;           // Próximo puesto a leer en la ronda en curso
+    unsigned long lastRoundMs;  // Fin de la última ronda
+    uint16_t roundIntervalMs;   // Fin de ronda -> próxima conversión
+    uint32_t rounds;
+    RoundStats currentRound;
+    RoundStats lastRound;
+
+    // Medición de tiempo de bus y de CPU por transacción
+    uint32_t txStartUs;
+    uint32_t txStartBlockedUs;
+    void beginTransaction();
+    void endTransaction();
+
+    void searchAlarms();
+    bool needsRead(uint8_t index) const;
+    void readSensor(uint8_t index, unsigned long nowMs);
+    bool writePendingConfig();
+    void recordError(uint8_t index);
+    int8_t findAssigned(const uint8_t* rom) const;
+    void updateIdentify(unsigned long nowMs);
+    void assignSpare(uint8_t spare);
+};
+
+#endif // TEMPERATURE_BUS_H
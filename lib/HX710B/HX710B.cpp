@@ -63,20 +63,59 @@ uint8_t shiftInSlow(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder) {
 #define SHIFTIN_WITH_SPEED_SUPPORT(data,clock,order) shiftIn(data,clock,order)
 #endif
 
+#if HX710B_USE_SPI && !defined(ARDUINO_ARCH_ESP32)
+#error "HX710B_USE_SPI requires the ESP32 SPIClass::transferBits() API"
+#endif
+
 
 HX710B::HX710B() {
 }
 
 HX710B::~HX710B() {
+	#if HX710B_USE_SPI
+	delete spi_dev;
+	delete spi_bus;
+	#endif
 }
 
-void HX710B::begin(byte dout, byte pd_sck) {
+void HX710B::begin(byte dout, byte pd_sck, byte mode) {
 	PD_SCK = pd_sck;
 	DOUT = dout;
 
 	pinMode(PD_SCK, OUTPUT);
 	pinMode(DOUT, INPUT_PULLUP);
 
+	#if HX710B_USE_SPI
+	// Route PD_SCK to SCK and DOUT to MISO; no MOSI or chip select is needed.
+	// The bus is started here with our pins, so Adafruit_SPIDevice::begin()
+	// finds it already running and does not reassign the default pins.
+	// SPI_MODE1: clock idles low, DOUT changes on the rising edge and is
+	// sampled on the falling edge.
+	if (spi_bus == nullptr) {
+		spi_bus = new SPIClass(HX710B_SPI_BUS);
+		spi_bus->begin(PD_SCK, DOUT, -1, -1);
+		spi_dev = new Adafruit_SPIDevice(-1, HX710B_SPI_FREQ, SPI_BITORDER_MSBFIRST, SPI_MODE1, spi_bus);
+		spi_dev->begin();
+	}
+	#endif
+
+	set_mode(mode);
+}
+
+void HX710B::set_mode(byte mode) {
+	switch (mode) {
+		case HX710B_DVDD_40HZ:
+		case HX710B_DIFF_40HZ:
+			MODE = mode;
+			break;
+		default:
+			MODE = HX710B_DIFF_10HZ;
+			break;
+	}
+}
+
+byte HX710B::get_mode() {
+	return MODE;
 }
 
 bool HX710B::is_ready() {
@@ -94,6 +133,9 @@ long HX710B::read() {
 	uint8_t data[3] = { 0 };
 	uint8_t filler = 0x00;
 
+	#if HX710B_USE_SPI
+	read_spi(data);
+	#else
 	// Protect the read sequence from system interrupts.  If an interrupt occurs during
 	// the time the PD_SCK signal is high it will stretch the length of the clock pulse.
 	// If the total pulse time exceeds 60 uSec this will cause the HX710B to enter
@@ -104,8 +146,8 @@ long HX710B::read() {
 	// The result is that all subsequent bits read by shiftIn() will read back as 1,
 	// corrupting the value returned by read().  The ATOMIC_BLOCK macro disables
 	// interrupts during the sequence and then restores the interrupt mask to its previous
-	// state after the sequence completes, insuring that the entire read-and-gain-set
-	// sequence is not interrupted.  The macro has a few minor advantages over bracketing
+	// state after the sequence completes, insuring that the 24-bit shift is not
+	// interrupted.  The macro has a few minor advantages over bracketing
 	// the sequence between `noInterrupts()` and `interrupts()` calls.
 	#if HAS_ATOMIC_BLOCK
 	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
@@ -129,18 +171,6 @@ long HX710B::read() {
 	data[1] = SHIFTIN_WITH_SPEED_SUPPORT(DOUT, PD_SCK, MSBFIRST);
 	data[0] = SHIFTIN_WITH_SPEED_SUPPORT(DOUT, PD_SCK, MSBFIRST);
 
-	// Set the channel and the gain factor for the next reading using the clock pin.
-	for (unsigned int i = 0; i < 128; i++) {
-		digitalWrite(PD_SCK, HIGH);
-		#if ARCH_ESPRESSIF
-		delayMicroseconds(1);
-		#endif
-		digitalWrite(PD_SCK, LOW);
-		#if ARCH_ESPRESSIF
-		delayMicroseconds(1);
-		#endif
-	}
-
 	#if IS_FREE_RTOS
 	// End of critical section.
 	portEXIT_CRITICAL(&mux);
@@ -153,6 +183,38 @@ long HX710B::read() {
 	interrupts();
 	#endif
 
+	// Select the next conversion mode with 1..3 extra pulses (25/26/27 in total).
+	// The data is already latched, so only each pulse's high time needs protecting
+	// against the 60 uSec power-down limit; interrupts are re-enabled between pulses.
+	for (byte i = 0; i < MODE; i++) {
+		#if HAS_ATOMIC_BLOCK
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		#elif IS_FREE_RTOS
+		portENTER_CRITICAL(&mux);
+		#else
+		noInterrupts();
+		#endif
+
+		digitalWrite(PD_SCK, HIGH);
+		#if ARCH_ESPRESSIF
+		delayMicroseconds(1);
+		#endif
+		digitalWrite(PD_SCK, LOW);
+
+		#if IS_FREE_RTOS
+		portEXIT_CRITICAL(&mux);
+		#elif HAS_ATOMIC_BLOCK
+		}
+		#else
+		interrupts();
+		#endif
+
+		#if ARCH_ESPRESSIF
+		delayMicroseconds(1);
+		#endif
+	}
+	#endif // HX710B_USE_SPI
+
 	// Replicate the most significant bit to pad out a 32-bit signed integer
 	if (data[2] & 0x80) {
 		filler = 0xFF;
@@ -169,6 +231,26 @@ long HX710B::read() {
 	return static_cast<long>(value);
 }
 
+#if HX710B_USE_SPI
+void HX710B::read_spi(uint8_t data[3]) {
+	// One transaction of 24 + MODE clocks generated by the peripheral. The data bytes
+	// go through the SPI FIFO (at most 4 bytes, so DMA would add setup cost without
+	// saving any CPU); the 1..3 mode pulses use transferBits() for the odd bit count.
+	uint8_t rx[3] = { 0x00, 0x00, 0x00 };
+	uint32_t tail = 0;
+
+	spi_dev->beginTransaction();
+	spi_dev->transfer(rx, sizeof(rx));
+	spi_bus->transferBits(0, &tail, MODE);
+	spi_dev->endTransaction();
+
+	// SPI delivers the MSB first; read() expects data[2] to hold it
+	data[2] = rx[0];
+	data[1] = rx[1];
+	data[0] = rx[2];
+}
+#endif
+
 void HX710B::wait_ready(unsigned long delay_ms) {
 	// Wait for the chip to become ready.
 	// This is a blocking implementation and will
@@ -219,8 +301,64 @@ long HX710B::read_average(byte times) {
 	return sum / times;
 }
 
+bool HX710B::read_if_ready(long &value) {
+	// Only touch the clock when DOUT already signals a finished conversion,
+	// so read() never enters wait_ready()'s busy loop.
+	if (!is_ready()) {
+		return false;
+	}
+	value = read();
+	return true;
+}
+
+bool HX710B::sample() {
+	long value;
+	if (!read_if_ready(value)) {
+		return false;
+	}
+	return sampler_add(value);
+}
+
+bool HX710B::sampler_add(long value) {
+	sampler_sum += value;
+	sampler_count++;
+
+	if (sampler_count < SAMPLER_WINDOW) {
+		return false;
+	}
+
+	// Window complete: publish the average and start a new one
+	sampler_last = sampler_sum / SAMPLER_WINDOW;
+	sampler_valid = true;
+	sampler_sum = 0;
+	sampler_count = 0;
+	return true;
+}
+
+void HX710B::set_sampler_window(byte samples) {
+	SAMPLER_WINDOW = (samples == 0) ? 1 : samples;
+	sampler_reset();
+}
+
+long HX710B::sampler_average() {
+	return sampler_last;
+}
+
+bool HX710B::sampler_ready() {
+	return sampler_valid;
+}
+
+void HX710B::sampler_reset() {
+	sampler_sum = 0;
+	sampler_count = 0;
+}
+
+float HX710B::to_pascal(long raw) {
+	return (raw*RES) *200 + 500;
+}
+
 float HX710B::pascal(){
-    float value = (read_average()*RES) *200 + 500;
+    float value = to_pascal(read_average());
     return value;
 }
 
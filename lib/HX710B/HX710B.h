@@ -18,6 +18,31 @@
 #include "WProgram.h"
 #endif
 
+// Optional SPI backend: define HX710B_USE_SPI=1 in build_flags to clock the chip with
+// the ESP32 SPI peripheral (PD_SCK on SCK, DOUT on MISO) instead of bit-banging.
+// Reads then run with hardware timing and without disabling interrupts.
+#ifndef HX710B_USE_SPI
+#define HX710B_USE_SPI 0
+#endif
+
+#if HX710B_USE_SPI
+#include <Adafruit_SPIDevice.h>
+
+#ifndef HX710B_SPI_BUS
+#define HX710B_SPI_BUS HSPI		// SPI host used for the HX710B (pins routed via GPIO matrix)
+#endif
+
+#ifndef HX710B_SPI_FREQ
+#define HX710B_SPI_FREQ 1000000	// 0.5 us high time, within the 0.2..50 us PD_SCK window
+#endif
+#endif
+
+// Conversion mode for the NEXT reading, encoded as the number of extra PD_SCK
+// pulses after the 24 data bits (25/26/27 total pulses, see datasheet).
+#define HX710B_DIFF_10HZ	1	// differential input, 10 Hz
+#define HX710B_DVDD_40HZ	2	// DVDD-AVDD (temperature on HX710A), 40 Hz
+#define HX710B_DIFF_40HZ	3	// differential input, 40 Hz
+
 class HX710B
 {
 	private:
@@ -26,18 +51,41 @@ class HX710B
 		long OFFSET = 0;	// used for tare weight
 		float SCALE = 1;	// used to return weight in grams, kg, ounces, whatever
         float RES = 2.98023e-7;
+		byte MODE = HX710B_DIFF_10HZ;	// extra clock pulses selecting the next conversion
+
+		#if HX710B_USE_SPI
+		SPIClass *spi_bus = nullptr;			// owns the PD_SCK/DOUT pins once begin() runs
+		Adafruit_SPIDevice *spi_dev = nullptr;
+		void read_spi(uint8_t data[3]);
+		#endif
+
+		// Non-blocking sampler state (see sample())
+		byte SAMPLER_WINDOW = 10;	// conversions per published average
+		byte sampler_count = 0;		// conversions accumulated in the current window
+		long sampler_sum = 0;		// running sum of the current window
+		long sampler_last = 0;		// last completed window average
+		bool sampler_valid = false;	// true once at least one window has completed
 	public:
 
 		HX710B();
 
 		virtual ~HX710B();
 
-		// Initialize library with data output pin, clock input pin and gain factor.
-		// Channel selection is made by passing the appropriate gain:
-		// - With a gain factor of 64 or 128, channel A is selected
-		// - With a gain factor of 32, channel B is selected
-		// The library default is "128" (Channel A).
-		void begin(byte dout, byte pd_sck);
+		// Initialize library with data output pin, clock input pin and conversion mode.
+		// The mode is the number of extra PD_SCK pulses after the 24 data bits:
+		// - HX710B_DIFF_10HZ (1 pulse, 25 total): differential input at 10 Hz
+		// - HX710B_DVDD_40HZ (2 pulses, 26 total): DVDD-AVDD at 40 Hz
+		// - HX710B_DIFF_40HZ (3 pulses, 27 total): differential input at 40 Hz
+		// The library default is HX710B_DIFF_10HZ.
+		void begin(byte dout, byte pd_sck, byte mode = HX710B_DIFF_10HZ);
+
+		// select channel and output rate of the next conversions
+		// (HX710B_DIFF_10HZ, HX710B_DVDD_40HZ or HX710B_DIFF_40HZ)
+		// takes effect after the next read(), which clocks out the new pulse count
+		void set_mode(byte mode = HX710B_DIFF_10HZ);
+
+		// get the current conversion mode
+		byte get_mode();
 
 		// Check if HX710B is ready
 		// from the datasheet: When output data is not ready for retrieval, digital output pin DOUT is high. Serial clock
@@ -55,6 +103,34 @@ class HX710B
 		// returns an average reading; times = how many times to read
 		long read_average(byte times = 10);
 
+		// reads one conversion only if the chip is ready; never waits for DOUT
+		// returns true and stores the reading in value when a conversion was read
+		bool read_if_ready(long &value);
+
+		// Non-blocking sampler mode: call sample() as often as possible. Each call reads
+		// at most one conversion (only when is_ready() is true) and adds it to a running
+		// window. Returns true when the window just filled and a new average is available.
+		bool sample();
+
+		// adds an externally acquired raw reading to the sampler window (e.g. from an
+		// acquisition task); same return value as sample()
+		bool sampler_add(long value);
+
+		// set how many conversions make up one sampler window (1..255); resets the window
+		void set_sampler_window(byte samples = 10);
+
+		// average of the last completed sampler window
+		long sampler_average();
+
+		// true once the sampler has completed at least one window
+		bool sampler_ready();
+
+		// discards the partially filled window
+		void sampler_reset();
+
+		// converts a raw (averaged) reading to pascal using the same scale as pascal()
+		float to_pascal(long raw);
+
         // returns pressure in kilopascals
         float pascal();
 
@@ -90,6 +166,7 @@ class HX710B
 		long get_offset();
 
 		// puts the chip into power down mode
+		// (with HX710B_USE_SPI the SCK pin belongs to the SPI peripheral: not supported)
 		void power_down();
 
 		// wakes up the chip after power down mode
@@ -0,0 +1,137 @@
+#include "PressureSensor.h"
+
+#if PRESSURE_USE_ADS1115
+
+#include "PressureMath.h"
+
+Ads1115Pressure::Ads1115Pressure(uint8_t address, TwoWire* wire)
+    : bus(wire),
+      device(address, wire),
+      configRegister(&device, REG_CONFIG, 2, MSBFIRST),
+      alert(0),
+      pendingRate(RATE_16_SPS),
+      currentRate(RATE_16_SPS),
+      lastReadUs(0),
+      errors(0),
+      samplerWindow(10),
+      samplerCount(0),
+      samplerSum(0),
+      samplerLast(0),
+      samplerValid(false) {}
+
+// ========================================
+// Inicialización
+// ========================================
+
+bool Ads1115Pressure::begin(uint8_t alertPin, uint8_t sdaPin, uint8_t sclPin, DataRate rate) {
+    alert = alertPin;
+    pinMode(alert, INPUT_PULLUP);  // ALERT/RDY es open-drain
+
+    // Bus iniciado con nuestros pines: Adafruit_I2CDevice::begin() lo encuentra andando
+    bus->begin(sdaPin, sclPin, SensorConfig::ADS1115_I2C_HZ);
+    if (!device.begin()) {
+        Serial.println("[SENSOR] ERROR: ADS1115 no responde");
+        return false;
+    }
+
+    // Modo "conversión lista": MSB de Hi_thresh en 1 y de Lo_thresh en 0
+    Adafruit_BusIO_Register loThresh(&device, REG_LO_THRESH, 2, MSBFIRST);
+    Adafruit_BusIO_Register hiThresh(&device, REG_HI_THRESH, 2, MSBFIRST);
+    if (!loThresh.write(0x0000) || !hiThresh.write(0x8000)) {
+        Serial.println("[SENSOR] ERROR: No se pudo configurar el ADS1115");
+        return false;
+    }
+
+    pendingRate = rate;
+    if (!writeConfig(rate)) {
+        Serial.println("[SENSOR] ERROR: No se pudo configurar el ADS1115");
+        return false;
+    }
+    lastReadUs = micros();
+    return true;
+}
+
+void Ads1115Pressure::set_data_rate(DataRate rate) {
+    pendingRate = rate;
+}
+
+bool Ads1115Pressure::writeConfig(uint8_t rate) {
+    uint16_t config = CONFIG_MUX_AIN0 | CONFIG_PGA | CONFIG_CONTINUOUS |
+                      ((uint16_t)rate << CONFIG_DR_SHIFT) | CONFIG_QUEUE_1;
+    if (!configRegister.write(config)) {
+        return false;
+    }
+
+    // Puntero de vuelta al registro de conversión: las lecturas no lo reescriben
+    uint8_t pointer = REG_CONVERSION;
+    if (!device.write(&pointer, 1)) {
+        return false;
+    }
+    currentRate = rate;
+    return true;
+}
+
+// ========================================
+// Lecturas
+// ========================================
+
+bool Ads1115Pressure::is_ready() {
+    return micros() - lastReadUs >= periodUs((DataRate)currentRate);
+}
+
+bool Ads1115Pressure::read_conversion(long& value) {
+    uint8_t data[2];
+    bool ok = device.read(data, 2);
+    lastReadUs = micros();
+
+    // Cambio de tasa pendiente: después de leer, sin otra transacción en curso
+    uint8_t rate = pendingRate;
+    if (rate != currentRate && !writeConfig(rate)) {
+        errors++;
+    }
+
+    if (!ok) {
+        errors++;
+        return false;
+    }
+    value = PressureMath::rawFromAds1115((int16_t)((data[0] << 8) | data[1]));
+    return true;
+}
+
+bool Ads1115Pressure::read_if_ready(long& value) {
+    if (!is_ready()) {
+        return false;
+    }
+    return read_conversion(value);
+}
+
+// ========================================
+// Ventana de promedios
+// ========================================
+
+bool Ads1115Pressure::sampler_add(long value) {
+    samplerSum += value;
+    samplerCount++;
+
+    if (samplerCount < samplerWindow) {
+        return false;
+    }
+
+    samplerLast = samplerSum / samplerWindow;
+    samplerValid = true;
+    samplerSum = 0;
+    samplerCount = 0;
+    return true;
+}
+
+void Ads1115Pressure::set_sampler_window(byte samples) {
+    samplerWindow = (samples == 0) ? 1 : samples;
+    sampler_reset();
+}
+
+void Ads1115Pressure::sampler_reset() {
+    samplerSum = 0;
+    samplerCount = 0;
+}
+
+#endif // PRESSURE_USE_ADS1115
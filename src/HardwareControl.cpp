@@ -174,6 +174,13 @@ void HardwareControl::toggleMotorDirection() {
     }
 }
 
+bool HardwareControl::isMotorSettled(uint16_t settleMs) const {
+    // Solo el final de las pausas: el tambor quieto y el agua ya asentada
+    if (!motorRunning) return false;
+    if (motorState != MOTOR_PAUSE_1 && motorState != MOTOR_PAUSE_2) return false;
+    return millis() - lastMotorToggle >= settleMs;
+}
+
 // ========================================
 // Control de centrifugado
 // ========================================
@@ -1,20 +1,88 @@
 #include "NextionUI.h"
 #include "StateMachine.h"
+#include "LevelCalibration.h"
+#include "NextionBaud.h"
+#include "NextionPrefixes.h"
 
 NextionUI::NextionUI()
     : serial(&Serial2),
       buttonCallback(nullptr),
+      eventCallback(nullptr),
       currentPage(0),
       lastUpdate(0),
-      rxIndex(0) {
-    memset(rxBuffer, 0, sizeof(rxBuffer));
+      frameDepth(0),
+      linkBaud(0) {
 }
 
 // ========================================
 // Inicialización
 // ========================================
 
-void NextionUI::begin() {
+namespace {
+    // Enlace de NextionBaud::LinkRecovery sobre el UART del panel (sin esperas)
+    class SerialLink {
+    public:
+        explicit SerialLink(HardwareSerial* port) : serial(port) {}
+
+        void setBaud(uint32_t baud) {
+            // Terminar de enviar a la velocidad anterior: a lo sumo un
+            // comando corto ("baud=", "get"), ~1 ms a BAUD_RATE
+            serial->flush();
+            serial->updateBaudRate(baud);
+        }
+
+        void sendCommand(const char* cmd) {
+            char buffer[24];
+            NextionFormat::Writer writer(buffer, sizeof(buffer));
+            writer.text(cmd).put((char)0xFF).put((char)0xFF).put((char)0xFF);
+            serial->write((const uint8_t*)writer.data(), writer.size());
+        }
+
+    protected:
+        HardwareSerial* serial;
+    };
+
+    // Enlace de NextionBaud::negotiate() en begin() (esperas bloqueantes)
+    class BootLink : public SerialLink {
+    public:
+        explicit BootLink(HardwareSerial* port) : SerialLink(port), seed(micros()) {}
+
+        void setBaud(uint32_t baud) {
+            SerialLink::setBaud(baud);
+            delay(NextionConfig::BAUD_SETTLE_MS);
+            while (serial->available()) {
+                serial->read();
+            }
+        }
+
+        // "get <nonce>" debe volver exacto antes de PROBE_TIMEOUT_MS
+        bool probe() {
+            uint32_t nonce = NextionBaud::makeNonce(seed++);
+            char cmd[16];
+            NextionFormat::Writer writer(cmd, sizeof(cmd));
+            writer.text("get ").number(nonce);
+            sendCommand(writer.c_str());
+
+            NextionBaud::ProbeMatcher matcher(nonce);
+            unsigned long startTime = millis();
+            while (millis() - startTime < NextionConfig::PROBE_TIMEOUT_MS) {
+                while (serial->available()) {
+                    if (matcher.feed(serial->read())) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+    private:
+        uint32_t seed;
+    };
+}
+
+uint32_t NextionUI::begin(uint32_t savedBaud) {
+    // Buffer de TX del driver: una trama completa se encola sin bloquear
+    serial->setTxBufferSize(NextionConfig::TX_FRAME_SIZE * 2);
     serial->begin(NextionConfig::BAUD_RATE, SERIAL_8N1,
                   HardwarePins::NEXTION_RX, HardwarePins::NEXTION_TX);
 
@@ -29,8 +97,21 @@ void NextionUI::begin() {
         }
     }
 
-    // Comando de inicialización (opcional)
-    sendCommand("bkcmd=0");  // Desactivar respuestas automáticas
+    // Velocidad: la guardada (un sondeo) o la más alta que confirme el panel
+    BootLink link(serial);
+    uint32_t baud = NextionBaud::negotiate(link, savedBaud);
+    if (baud == 0) {
+        Serial.printf("[NEXTION] ERROR: El panel no responde, se sigue a %lu baudios\n",
+                      (unsigned long)NextionConfig::BAUD_RATE);
+    } else {
+        Serial.printf("[NEXTION] Enlace a %lu baudios\n", (unsigned long)baud);
+    }
+
+    // Respuestas a cada comando solo si se confirman (ver NextionAckQueue)
+    sendCommand(NextionConfig::ACK_COMMANDS ? "bkcmd=3" : "bkcmd=0");
+    linkBaud = baud;
+    linkMonitor.reset(millis(), baud == 0 ? NextionConfig::LINK_RETRY_MS : NextionConfig::LINK_SILENCE_MS);
+    return baud;
 }
 
 // ========================================
@@ -39,6 +120,91 @@ void NextionUI::begin() {
 
 void NextionUI::update() {
     processSerialData();
+
+    uint32_t queryTimeouts = queries.getStats().timeouts;
+    queries.checkTimeout(micros());
+    if (queries.getStats().timeouts != queryTimeouts) {
+        linkMonitor.onTimeout();
+    }
+
+    // Buscando el panel: los reintentos se perderían (restorePanel reenvía)
+    if (NextionConfig::ACK_COMMANDS && !linkRecovery.isSearching()) {
+        processAcks();
+    }
+    checkLink();
+}
+
+void NextionUI::processAcks() {
+    // Respuestas perdidas: lo enviado sin confirmación pudo no llegar
+    if (acks.checkTimeout(micros())) {
+        Serial.println("[NEXTION] Sin respuesta del panel, reenviando valores");
+        shadow.invalidate();
+        linkMonitor.onTimeout();
+    }
+
+    // Reintentos, cada uno solo en su escritura
+    const char* cmd;
+    size_t len;
+    uint8_t slot;
+    while (acks.nextRetry(cmd, len, slot)) {
+        frame.begin(false);
+        frame.add(cmd, len);
+        serial->write(frame.data(), frame.size());
+        frame.drain();
+        acks.trackResent(slot, micros());
+    }
+}
+
+// Panel reiniciado en marcha: volvió a BAUD_RATE y a la velocidad negociada
+// no se lee nada. Sondeo a la velocidad actual; si no vuelve, renegociar.
+// Cada llamada avanza un paso de LinkRecovery: el loop no se detiene.
+void NextionUI::checkLink() {
+    if (!linkRecovery.isActive()) {
+        if (linkMonitor.needsCheck(millis())) {
+            linkRecovery.start(linkBaud, millis());
+        }
+        return;
+    }
+
+    SerialLink link(serial);
+    bool searching = linkRecovery.isSearching();
+    NextionBaud::LinkRecovery::Result result = linkRecovery.update(link, millis());
+    if (!searching && linkRecovery.isSearching()) {
+        Serial.println("[NEXTION] Enlace perdido, buscando el panel");
+    }
+    if (result == NextionBaud::LinkRecovery::BUSY) {
+        return;
+    }
+
+    // El sondeo a la velocidad actual volvió: el silencio era normal
+    if (result == NextionBaud::LinkRecovery::LINKED && !searching) {
+        linkMonitor.reset(millis());
+        return;
+    }
+
+    uint32_t baud = linkRecovery.getBaud();
+    if (baud == 0) {
+        if (linkBaud != 0) {
+            Serial.printf("[NEXTION] ERROR: El panel no responde, se sigue a %lu baudios\n",
+                          (unsigned long)NextionConfig::BAUD_RATE);
+        }
+        linkBaud = 0;
+        linkMonitor.reset(millis(), NextionConfig::LINK_RETRY_MS);
+        return;
+    }
+
+    Serial.printf("[NEXTION] Enlace a %lu baudios\n", (unsigned long)baud);
+    linkBaud = baud;
+    linkMonitor.reset(millis());
+    acks.resynchronize();  // Lo pendiente se perdió con el reinicio
+    restorePanel();
+}
+
+// Tras un reinicio el panel vuelve a bkcmd=2, a la página 0 y a los valores del HMI
+void NextionUI::restorePanel() {
+    sendCommand(NextionConfig::ACK_COMMANDS ? "bkcmd=3" : "bkcmd=0");
+    shadow.invalidate();
+    showPage(currentPage);
 }
 
 // ========================================
@@ -46,81 +212,102 @@ void NextionUI::update() {
 // ========================================
 
 void NextionUI::showWelcome() {
-    char cmd[32];
-    snprintf(cmd, sizeof(cmd), "page %d", NextionConfig::PAGE_WELCOME);
-    sendCommand(cmd);
-    currentPage = NextionConfig::PAGE_WELCOME;
+    showPage(NextionConfig::PAGE_WELCOME);
 }
 
 void NextionUI::showSelection() {
-    char cmd[32];
-    snprintf(cmd, sizeof(cmd), "page %d", NextionConfig::PAGE_SELECTION);
-    sendCommand(cmd);
-    currentPage = NextionConfig::PAGE_SELECTION;
+    showPage(NextionConfig::PAGE_SELECTION);
 }
 
 void NextionUI::showExecution() {
-    char cmd[32];
-    snprintf(cmd, sizeof(cmd), "page %d", NextionConfig::PAGE_EXECUTION);
-    sendCommand(cmd);
-    currentPage = NextionConfig::PAGE_EXECUTION;
+    showPage(NextionConfig::PAGE_EXECUTION);
 }
 
 void NextionUI::showEdit() {
-    char cmd[32];
-    snprintf(cmd, sizeof(cmd), "page %d", NextionConfig::PAGE_EDIT);
-    sendCommand(cmd);
-    currentPage = NextionConfig::PAGE_EDIT;
+    showPage(NextionConfig::PAGE_EDIT);
 }
 
 void NextionUI::showError(const char* message) {
-    char cmd[32];
-    snprintf(cmd, sizeof(cmd), "page %d", NextionConfig::PAGE_ERROR);
-    sendCommand(cmd);
+    showPage(NextionConfig::PAGE_ERROR);
     setText("mensaje", message);
-    currentPage = NextionConfig::PAGE_ERROR;
+}
+
+void NextionUI::showPage(uint8_t page) {
+    const NextionShadow::PageStats& left = shadow.getStats(currentPage);
+    log_d("[NEXTION] Página %u: %lu comandos (%lu B), %lu omitidos (%lu B ahorrados)",
+          currentPage, (unsigned long)left.sentCommands, (unsigned long)left.sentBytes,
+          (unsigned long)left.skippedCommands, (unsigned long)left.savedBytes);
+
+    if (NextionConfig::ACK_COMMANDS) {
+        const LatencyHistogram& latency = acks.getLatency();
+        log_d("[NEXTION] Ida y vuelta: p50 %lu us, p90 %lu us, p99 %lu us, máx %lu us (%lu muestras)",
+              (unsigned long)latency.percentileUs(50), (unsigned long)latency.percentileUs(90),
+              (unsigned long)latency.percentileUs(99), (unsigned long)latency.max(),
+              (unsigned long)latency.count());
+    }
+
+    char cmd[8];
+    NextionFormat::Writer writer(cmd, sizeof(cmd));
+    writer.text("page ").number(page);
+
+    currentPage = page;
+    shadow.setPage(page);  // El panel recarga los valores del HMI
+    sendCommandAcked(writer.c_str());
 }
 
 void NextionUI::showEmergency() {
-    char cmd[32];
-    snprintf(cmd, sizeof(cmd), "page %d", NextionConfig::PAGE_EMERGENCY);
-    sendCommand(cmd);
-    currentPage = NextionConfig::PAGE_EMERGENCY;
+    showPage(NextionConfig::PAGE_EMERGENCY);
+}
+
+void NextionUI::showCalibration() {
+    showPage(NextionConfig::PAGE_CALIBRATION);
 }
 
+// ========================================
+// Prefijos de comandos (NextionPrefixes.h)
+// ========================================
+
+using namespace NextionPrefix;
+
+static_assert(NextionConfig::TX_FRAME_SIZE >= NextionConfig::MAX_COMMAND_LEN + 3 * 11,
+              "La trama debe admitir el comando más largo con ref_stop y ref_star");
+
 // ========================================
 // Actualización de displays
 // ========================================
 
 void NextionUI::updateSelectionDisplay(const ProgramConfig& config) {
-    char buffer[32];
-
+    beginFrame();
 
     // Mostrar programa seleccionado
-    snprintf(buffer, sizeof(buffer), "P%d", config.programNumber);
-    setText("progr_sel", buffer);
+    beginValue().prefix(TXT_PROGR_SEL).put('P').number(config.programNumber).quote();
+    endValue();
 
     uint8_t proc = config.currentProcess;
 
     // Nivel de agua (como texto)
-    snprintf(buffer, sizeof(buffer), "%d", config.waterLevel[proc]);
-    setText("val_nivel", buffer);
+    beginValue().prefix(TXT_VAL_NIVEL).number(config.waterLevel[proc]).quote();
+    endValue();
 
     // Temperatura (como texto)
-    snprintf(buffer, sizeof(buffer), "%d", config.temperature[proc]);
-    setText("val_temp", buffer);
+    beginValue().prefix(TXT_VAL_TEMP).number(config.temperature[proc]).quote();
+    endValue();
 
     // Tiempo (como texto)
-    snprintf(buffer, sizeof(buffer), "%d", config.time[proc]);
-    setText("val_tiempo", buffer);
+    beginValue().prefix(TXT_VAL_TIEMPO).number(config.time[proc]).quote();
+    endValue();
 
     // Centrifugado
     const char* centrif = config.centrifugeEnabled[proc] ? "Si" : "No";
-    setText("val_centrif", centrif);
+    beginValue().prefix(TXT_VAL_CENTRIF).text(centrif).quote();
+    endValue();
 
     // Tipo de agua
     const char* agua = getWaterTypeText(config.waterType[proc]);
-    setText("val_agua", agua);
+    beginValue().prefix(TXT_VAL_AGUA).text(agua).quote();
+    endValue();
+
+    endFrame();
 }
 
 void NextionUI::updateExecutionDisplay(
@@ -130,52 +317,95 @@ void NextionUI::updateExecutionDisplay(
     uint16_t phaseTime,
     uint16_t totalTime,
     float temperature,
-    uint8_t waterLevel,
+    uint16_t waterLevelCenti,
     bool centrifuge,
     WaterType waterType)
 {
-    char buffer[32];
+    beginFrame();
 
     // Programa
-    snprintf(buffer, sizeof(buffer), "P%d", program);
-    setText("progr_ejec", buffer);
+    beginValue().prefix(TXT_PROGR_EJEC).put('P').number(program).quote();
+    endValue();
 
     // Fase
-    setText("fase_ejec", getPhaseText(phase));
+    beginValue().prefix(TXT_FASE_EJEC).text(getPhaseText(phase)).quote();
+    endValue();
 
     // Proceso/Tanda (como texto)
-    snprintf(buffer, sizeof(buffer), "%d", process + 1);
-    setText("tanda_ejec", buffer);
+    beginValue().prefix(TXT_TANDA_EJEC).number(process + 1).quote();
+    endValue();
 
     // Tiempo de fase
-    formatTime(phaseTime, buffer, sizeof(buffer));
-    setText("tiempo_ejec", buffer);
+    beginValue().prefix(TXT_TIEMPO_EJEC).mmss(phaseTime).quote();
+    endValue();
 
     // Tiempo total
-    formatTime(totalTime, buffer, sizeof(buffer));
-    setText("tiempo_total", buffer);
+    beginValue().prefix(TXT_TIEMPO_TOTAL).mmss(totalTime).quote();
+    endValue();
 
-    // Temperatura
-    snprintf(buffer, sizeof(buffer), "%.1f C", temperature);
-    setText("temp_ejec", buffer);
+    // Temperatura: décimas redondeadas como "%.1f" (en double el producto es exacto)
+    beginValue().prefix(TXT_TEMP_EJEC).fixed((int32_t)lrint(temperature * 10.0), 1).text(" C").quote();
+    endValue();
 
-    // Nivel (como texto)
-    snprintf(buffer, sizeof(buffer), "%d", waterLevel);
-    setText("nivel_ejec", buffer);
+    // Nivel continuo (como texto, un decimal truncado: 2.49 -> "2.4")
+    beginValue().prefix(TXT_NIVEL_EJEC).fixed(waterLevelCenti / 10, 1).quote();
+    endValue();
 
     // Barras de progreso (estas Si usan .val porque son progress bars)
-    setNumber("barra_nivel", (waterLevel * 100) / 4);
+    beginValue().prefix(VAL_BARRA_NIVEL).number(waterLevelCenti / 4);
+    endValue();
 
     // Barra de temperatura (0-100°C mapeado a 0-100%)
     uint8_t tempPercent = (uint8_t)constrain(temperature, 0, 100);
-    setNumber("barra_temp", tempPercent);
-
+    beginValue().prefix(VAL_BARRA_TEMP).number(tempPercent);
+    endValue();
 
     // Centrifugado
-    setText("centrif_ejec", centrifuge ? "Si" : "No");
+    beginValue().prefix(TXT_CENTRIF_EJEC).text(centrifuge ? "Si" : "No").quote();
+    endValue();
 
     // Tipo de agua
-    setText("agua_ejec", getWaterTypeText(waterType));
+    beginValue().prefix(TXT_AGUA_EJEC).text(getWaterTypeText(waterType)).quote();
+    endValue();
+
+    endFrame();
+}
+
+void NextionUI::updateCalibrationDisplay(
+    uint16_t referenceCenti,
+    uint16_t levelCenti,
+    long pressure,
+    uint8_t points,
+    bool filling,
+    const char* status)
+{
+    beginFrame();
+
+    // Nivel de referencia a capturar (centésimas)
+    beginValue().prefix(TXT_CAL_REF).fixed(referenceCenti, 2).quote();
+    endValue();
+
+    // Nivel actual según la calibración activa (un decimal truncado)
+    beginValue().prefix(TXT_CAL_NIVEL).fixed(levelCenti / 10, 1).quote();
+    endValue();
+
+    // Presión filtrada
+    beginValue().prefix(TXT_CAL_PRES).integer(pressure).text(" Pa").quote();
+    endValue();
+
+    // Puntos capturados
+    beginValue().prefix(TXT_CAL_PUNTOS).number(points).put('/').number(LevelCalibration::MAX_POINTS).quote();
+    endValue();
+
+    // Botón de llenado
+    beginValue().prefix(TXT_BTN_LLENAR).text(filling ? "Cerrar" : "Llenar").quote();
+    endValue();
+
+    // Último resultado (captura, guardado o corte automático del llenado)
+    beginValue().prefix(TXT_CAL_ESTADO).text(status != nullptr ? status : "").quote();
+    endValue();
+
+    endFrame();
 }
 
 void NextionUI::updateEditDisplay(
@@ -183,17 +413,21 @@ void NextionUI::updateEditDisplay(
     const char* paramName,
     const char* paramValue)
 {
-    char buffer[16];
+    beginFrame();
 
     // Resaltar proceso activo (los botones de tanda pueden usar .val para estado)
-    for (int i = 1; i <= 4; i++) {
-        snprintf(buffer, sizeof(buffer), "tanda%d", i);
-        setNumber(buffer, (i == process + 1) ? 1 : 0);  // 1=activo, 0=inactivo
+    for (int i = 0; i < 4; i++) {
+        beginValue().prefix(VAL_TANDA[i]).number(i == process ? 1 : 0);  // 1=activo, 0=inactivo
+        endValue();
     }
 
     // Mostrar parámetro y valor (como texto)
-    setText("param", paramName);
-    setText("param_value", paramValue);
+    beginValue().prefix(TXT_PARAM).text(paramName).quote();
+    endValue();
+    beginValue().prefix(TXT_PARAM_VALUE).text(paramValue).quote();
+    endValue();
+
+    endFrame();
 }
 
 // ========================================
@@ -204,50 +438,155 @@ void NextionUI::setButtonCallback(void (*callback)(uint8_t, uint8_t, uint8_t)) {
     buttonCallback = callback;
 }
 
+void NextionUI::setEventCallback(void (*callback)(const NextionParser::Event&)) {
+    eventCallback = callback;
+}
+
 // ========================================
 // Utilidades
 // ========================================
 
 void NextionUI::setText(const char* component, const char* text) {
-    char cmd[128];
-    snprintf(cmd, sizeof(cmd), "%s.txt=\"%s\"", component, text);
-    // Serial.printf("[NEXTION] Enviando: %s\n", cmd);
-    sendCommand(cmd);
+    beginValue().text(component).text(".txt=\"").text(text).quote();
+    endValue();
 }
 
 void NextionUI::setNumber(const char* component, uint32_t value) {
-    char cmd[64];
-    snprintf(cmd, sizeof(cmd), "%s.val=%lu", component, value);
-    // Serial.printf("[NEXTION] Enviando: %s\n", cmd);
-    sendCommand(cmd);
+    beginValue().text(component).text(".val=").number(value);
+    endValue();
 }
 
 void NextionUI::setEnabled(const char* component, bool enabled) {
-    char cmd[64];
-    snprintf(cmd, sizeof(cmd), "%s.en=%d", component, enabled ? 1 : 0);
-    // Serial.printf("[NEXTION] Enviando: %s\n", cmd);
-    sendCommand(cmd);
+    beginValue().text(component).text(".en=").put(enabled ? '1' : '0');
+    endValue();
 }
 
 void NextionUI::setEnabledById(uint8_t componentId, bool enabled) {
-    char cmd[64];
-    snprintf(cmd, sizeof(cmd), "tsw %d,%d", componentId, enabled ? 1 : 0);
-    // Serial.printf("[NEXTION] Enviando: %s\n", cmd);
-    sendCommand(cmd);
+    beginValue().text("tsw ").number(componentId).put(',').put(enabled ? '1' : '0');
+    endValue();
 }
 
 void NextionUI::setBackgroundColor(const char* component, uint16_t color) {
-    char cmd[64];
-    snprintf(cmd, sizeof(cmd), "%s.bco=%u", component, color);
-    // Serial.printf("[NEXTION] Enviando: %s\n", cmd);
-    sendCommand(cmd);
+    beginValue().text(component).text(".bco=").number(color);
+    endValue();
+}
+
+void NextionUI::setVisible(const char* component, bool visible) {
+    beginValue().text("vis ").text(component).put(',').put(visible ? '1' : '0');
+    endValue();
 }
 
 void NextionUI::sendCommand(const char* cmd) {
-    serial->print(cmd);
-    serial->write(0xFF);
-    serial->write(0xFF);
-    serial->write(0xFF);
+    shadow.recordSent(strlen(cmd));
+    writeCommand(cmd);
+}
+
+void NextionUI::sendCommandAcked(const char* cmd) {
+    size_t len = strlen(cmd);
+    if (!NextionConfig::ACK_COMMANDS || len > NextionConfig::MAX_COMMAND_LEN || !acks.canTrackAcked() ||
+        linkRecovery.isSearching()) {
+        sendCommand(cmd);
+        return;
+    }
+    shadow.recordSent(len);
+
+    // Lo pendiente sale antes; el comando va último en su escritura
+    flushFrame();
+    if (frameDepth == 0) {
+        frame.begin(false);
+    }
+    frame.add(cmd, len);
+    uint16_t before = frame.getBuffered() - 1;  // ref_stop de una trama atómica
+    serial->write(frame.data(), frame.size());
+    frame.drain();
+
+    uint32_t now = micros();
+    acks.trackPlain(before, now);
+    acks.trackAcked(cmd, len, now);
+}
+
+NextionFormat::Writer& NextionUI::beginValue() {
+    // Fuera de una trama: trama de un solo comando
+    if (frameDepth == 0) {
+        frame.begin(false);
+    }
+
+    char* out = frame.reserve(NextionConfig::MAX_COMMAND_LEN);
+    if (out == nullptr) {
+        flushFrame();
+        out = frame.reserve(NextionConfig::MAX_COMMAND_LEN);  // Vacía: siempre entra
+    }
+    valueWriter = NextionFormat::Writer(out, NextionConfig::MAX_COMMAND_LEN);
+    return valueWriter;
+}
+
+void NextionUI::endValue() {
+    if (valueWriter.overflowed()) {
+        // Comando truncado: el Nextion lo rechazaría
+        log_d("[NEXTION] Comando de más de %u bytes descartado", (unsigned)NextionConfig::MAX_COMMAND_LEN);
+    } else if (shadow.shouldSend(valueWriter.data(), valueWriter.size())) {
+        frame.commit(valueWriter.size());
+    }
+
+    if (frameDepth == 0) {
+        flushFrame();
+    }
+}
+
+void NextionUI::beginFrame(bool atomic) {
+    if (frameDepth++ == 0) {
+        frame.begin(atomic);
+    }
+}
+
+void NextionUI::endFrame() {
+    if (frameDepth == 0 || --frameDepth > 0) {
+        return;
+    }
+    frame.finish();
+    flushFrame();
+}
+
+void NextionUI::writeCommand(const char* cmd) {
+    size_t len = strlen(cmd);
+
+    // Fuera de una trama: trama de un solo comando (una escritura con terminador)
+    if (frameDepth == 0) {
+        frame.begin(false);
+    }
+
+    if (!frame.add(cmd, len)) {
+        flushFrame();
+        if (!frame.add(cmd, len)) {
+            // Más largo que la trama: directo al UART
+            static const uint8_t terminator[3] = {0xFF, 0xFF, 0xFF};
+            if (!linkRecovery.isSearching()) {
+                serial->write((const uint8_t*)cmd, len);
+                serial->write(terminator, sizeof(terminator));
+                if (NextionConfig::ACK_COMMANDS) {
+                    acks.trackPlain(1, micros());
+                }
+            }
+        }
+    }
+
+    if (frameDepth == 0) {
+        flushFrame();
+    }
+}
+
+void NextionUI::flushFrame() {
+    if (frame.size() > 0) {
+        // Buscando el panel a otra velocidad: se descarta (restorePanel
+        // vuelve a mostrar la página con el espejo invalidado)
+        if (!linkRecovery.isSearching()) {
+            serial->write(frame.data(), frame.size());
+            if (NextionConfig::ACK_COMMANDS) {
+                acks.trackPlain(frame.getBuffered(), micros());
+            }
+        }
+        frame.drain();
+    }
 }
 
 // ========================================
@@ -255,64 +594,139 @@ void NextionUI::sendCommand(const char* cmd) {
 // ========================================
 
 void NextionUI::processSerialData() {
-    static uint8_t ffCount = 0;
-
-    while (serial->available()) {
-        uint8_t byte = serial->read();
+    uint8_t chunk[NextionConfig::RX_READ_CHUNK];
+
+    // Lecturas en bloque: el parser sigue el mensaje aunque llegue partido
+    int available;
+    while ((available = serial->available()) > 0) {
+        size_t count = serial->read(chunk, min((size_t)available, sizeof(chunk)));
+        for (size_t i = 0; i < count; i++) {
+            // La respuesta a un sondeo del enlace no es un mensaje para el
+            // resto (sería una respuesta de más para las consultas)
+            bool probeReply = linkRecovery.feed(chunk[i]);
+            if (parser.feed(chunk[i]) && !probeReply) {
+                handleEvent(parser.event());
+            }
+        }
+    }
+}
 
-        // Detectar fin de mensaje (3 bytes 0xFF)
-        if (byte == 0xFF) {
-            ffCount++;
+void NextionUI::handleEvent(const NextionParser::Event& event) {
+    // Un mensaje reconocido confirma la velocidad (los bytes a otra velocidad
+    // salen como códigos desconocidos)
+    if (event.type != NextionParser::EVENT_OTHER) {
+        linkMonitor.onMessage(millis());
+    }
 
-            if (ffCount >= 3) {
-                parseEvent();
-                rxIndex = 0;
-                memset(rxBuffer, 0, sizeof(rxBuffer));
-                ffCount = 0;
+    switch (event.type) {
+        // Evento touch: 0x65 [pageId] [componentId] [eventType]
+        case NextionParser::EVENT_TOUCH:
+            Serial.print("Nextion Event: Page=");
+            Serial.print(event.page);
+            Serial.print(", Comp=");
+            Serial.print(event.component);
+            Serial.print(", Type=");
+            Serial.println(event.touch);
+
+            // Un botón dual-state cambia su .val en el panel
+            shadow.invalidateTouchable();
+
+            if (buttonCallback != nullptr) {
+                buttonCallback(event.page, event.component, event.touch);
             }
-        } else {
-            ffCount = 0;  // Reset contador si no es 0xFF
-
-            // Almacenar byte en buffer
-            if (rxIndex < sizeof(rxBuffer) - 1) {
-                rxBuffer[rxIndex++] = byte;
+            break;
+
+        case NextionParser::EVENT_RESULT:
+            handleResult(event.code);
+            break;
+
+        case NextionParser::EVENT_NUMBER:
+            handleAnswer(queries.onNumber(event.number));
+            break;
+
+        case NextionParser::EVENT_STRING:
+            handleAnswer(queries.onText(event.text));
+            break;
+
+        // Respuesta a sendme: el panel puede haber cambiado de página solo
+        case NextionParser::EVENT_PAGE:
+            if (event.page != currentPage && event.page < NextionConfig::PAGE_COUNT) {
+                Serial.printf("[NEXTION] El panel está en la página %u (se esperaba %u)\n",
+                              event.page, currentPage);
+                currentPage = event.page;
+                shadow.setPage(event.page);
             }
-        }
+            break;
+
+        case NextionParser::EVENT_SLEEP:
+            log_d("[NEXTION] Panel dormido");
+            break;
+
+        // Lo enviado con el panel dormido puede no haberse dibujado
+        case NextionParser::EVENT_WAKE:
+            log_d("[NEXTION] Panel despierto");
+            shadow.invalidate();
+            break;
+
+        // El panel se reinició solo (alimentación): volver a la página actual
+        case NextionParser::EVENT_READY:
+            Serial.println("[NEXTION] Panel reiniciado, restaurando página");
+            restorePanel();
+            break;
+
+        default:
+            break;
+    }
+
+    if (eventCallback != nullptr) {
+        eventCallback(event);
+    }
+}
+
+// Respuesta de bkcmd=3: éxito o error del comando más antiguo pendiente
+void NextionUI::handleResult(uint8_t code) {
+    if (!NextionConfig::ACK_COMMANDS) {
+        log_d("[NEXTION] Error del panel (0x%02X)", code);
+        return;
+    }
+    if (acks.onReturn(code, micros())) {
+        Serial.printf("[NEXTION] Comando perdido (0x%02X), reenviando valores\n", code);
+        shadow.invalidate();
+    } else if (code != NextionReturn::SUCCESS) {
+        log_d("[NEXTION] Comando rechazado (0x%02X)", code);
     }
 }
 
-void NextionUI::parseEvent() {
-    if (rxIndex == 0) return;
+// Con bkcmd=3 el dato de un get es su respuesta (no llega 0x01)
+void NextionUI::handleAnswer(bool answered) {
+    if (NextionConfig::ACK_COMMANDS && answered) {
+        acks.onReturn(NextionReturn::SUCCESS, micros());
+    }
+}
 
-    // Evento touch: 0x65 [pageId] [componentId] [eventType]
-    if (rxBuffer[0] == 0x65 && rxIndex >= 4) {
-        uint8_t pageId = rxBuffer[1];
-        uint8_t componentId = rxBuffer[2];
-        uint8_t eventType = rxBuffer[3];
+bool NextionUI::getNumber(const char* variable, NextionQueryQueue::NumberCallback callback) {
+    return queries.canPush() && sendQuery(variable) && queries.pushNumber(callback, micros());
+}
 
-        Serial.print("Nextion Event: Page=");
-        Serial.print(pageId);
-        Serial.print(", Comp=");
-        Serial.print(componentId);
-        Serial.print(", Type=");
-        Serial.println(eventType);
+bool NextionUI::getText(const char* variable, NextionQueryQueue::TextCallback callback) {
+    return queries.canPush() && sendQuery(variable) && queries.pushText(callback, micros());
+}
 
-        if (buttonCallback != nullptr) {
-            buttonCallback(pageId, componentId, eventType);
-        }
+bool NextionUI::sendQuery(const char* variable) {
+    char cmd[NextionConfig::MAX_COMMAND_LEN + 1];
+    NextionFormat::Writer writer(cmd, sizeof(cmd) - 1);
+    writer.text("get ").text(variable);
+    if (writer.overflowed() || linkRecovery.isSearching()) {
+        return false;
     }
+    writeCommand(writer.c_str());
+    return true;
 }
 
 // ========================================
 // Helpers de formateo
 // ========================================
 
-void NextionUI::formatTime(uint16_t seconds, char* buffer, size_t bufferSize) {
-    uint16_t minutes = seconds / 60;
-    uint16_t secs = seconds % 60;
-    snprintf(buffer, bufferSize, "%02d:%02d", minutes, secs);
-}
-
 const char* NextionUI::getPhaseText(uint8_t phase) {
     switch (phase) {
         case PHASE_FILLING:   return "Llenado";
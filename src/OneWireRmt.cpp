@@ -0,0 +1,340 @@
+#include "OneWireBus.h"
+
+#if ONEWIRE_USE_RMT
+
+#include <driver/gpio.h>
+#include <soc/gpio_periph.h>
+#include <soc/gpio_struct.h>
+#include <soc/io_mux_reg.h>
+
+OneWireRmt::OneWireRmt(uint8_t pin, rmt_channel_t txChannel, rmt_channel_t rxChannel)
+    : pin(pin),
+      txChannel(txChannel),
+      rxChannel(rxChannel),
+      rxRing(nullptr),
+      initialized(false),
+      busUs(0),
+      blockedUs(0) {
+    reset_search();
+}
+
+void OneWireRmt::begin(uint8_t newPin) {
+    pin = newPin;
+    initialized = false;
+}
+
+// ========================================
+// Inicialización (diferida: el constructor global corre antes que el RTOS)
+// ========================================
+
+bool OneWireRmt::init() {
+    if (initialized) return true;
+
+    // TX: nivel de reposo alto (bus liberado), tick de 1 µs
+    rmt_config_t tx = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, txChannel);
+    tx.clk_div = 80;
+    tx.tx_config.idle_level = RMT_IDLE_LEVEL_HIGH;
+    tx.tx_config.idle_output_en = true;
+    tx.tx_config.carrier_en = false;
+
+    // RX: mide los pulsos en el mismo pin
+    rmt_config_t rx = RMT_DEFAULT_CONFIG_RX((gpio_num_t)pin, rxChannel);
+    rx.clk_div = 80;
+    rx.rx_config.filter_en = true;
+    rx.rx_config.filter_ticks_thresh = 30;  // Ciclos APB (~0.4 µs)
+    rx.rx_config.idle_threshold = SLOT_IDLE_US;
+
+    if (rmt_config(&tx) != ESP_OK || rmt_driver_install(txChannel, 0, 0) != ESP_OK ||
+        rmt_config(&rx) != ESP_OK || rmt_driver_install(rxChannel, 512, 0) != ESP_OK ||
+        rmt_get_ringbuf_handle(rxChannel, &rxRing) != ESP_OK) {
+        Serial.println("[ONEWIRE] Error inicializando RMT");
+        return false;
+    }
+
+    // Ambos canales en el pin: primero RX (configurar TX deshabilita la
+    // entrada), luego se reactiva la entrada y se pasa a open-drain
+    gpio_set_pull_mode((gpio_num_t)pin, GPIO_PULLUP_ONLY);
+    rmt_set_gpio(rxChannel, RMT_MODE_RX, (gpio_num_t)pin, false);
+    rmt_set_gpio(txChannel, RMT_MODE_TX, (gpio_num_t)pin, false);
+    PIN_INPUT_ENABLE(GPIO_PIN_MUX_REG[pin]);
+    GPIO.pin[pin].pad_driver = 1;
+
+    initialized = true;
+    return true;
+}
+
+// ========================================
+// Transacciones RMT
+// ========================================
+
+rmt_item32_t OneWireRmt::writeSlot(uint8_t bit) {
+    rmt_item32_t item;
+    item.level0 = 0;
+    item.duration0 = bit ? WRITE1_LOW_US : WRITE0_LOW_US;
+    item.level1 = 1;
+    item.duration1 = SLOT_US - item.duration0;
+    return item;
+}
+
+rmt_item32_t OneWireRmt::readSlot() {
+    rmt_item32_t item;
+    item.level0 = 0;
+    item.duration0 = READ_LOW_US;
+    item.level1 = 1;
+    item.duration1 = SLOT_US - READ_LOW_US;
+    return item;
+}
+
+void OneWireRmt::transmit(const rmt_item32_t* items, size_t count) {
+    uint32_t start = micros();
+    rmt_write_items(txChannel, items, count, false);
+
+    uint32_t waitStart = micros();
+    rmt_wait_tx_done(txChannel, portMAX_DELAY);
+    uint32_t end = micros();
+
+    blockedUs += end - waitStart;
+    busUs += end - start;
+}
+
+size_t OneWireRmt::exchange(const rmt_item32_t* items, size_t count, uint16_t idleUs, rmt_item32_t** rx) {
+    uint32_t start = micros();
+
+    // Descartar capturas viejas y armar RX antes de transmitir
+    size_t len = 0;
+    void* stale;
+    while ((stale = xRingbufferReceive(rxRing, &len, 0)) != nullptr) {
+        vRingbufferReturnItem(rxRing, stale);
+    }
+    rmt_set_rx_idle_thresh(rxChannel, idleUs);
+    rmt_rx_start(rxChannel, true);
+    rmt_write_items(txChannel, items, count, false);
+
+    // La captura termina cuando el bus queda en reposo idleUs
+    uint32_t waitStart = micros();
+    *rx = (rmt_item32_t*)xRingbufferReceive(rxRing, &len, pdMS_TO_TICKS(RX_TIMEOUT_MS));
+    uint32_t waitEnd = micros();
+    rmt_rx_stop(rxChannel);
+
+    blockedUs += waitEnd - waitStart;
+    busUs += micros() - start;
+    return *rx ? len / sizeof(rmt_item32_t) : 0;
+}
+
+void OneWireRmt::readSlots(uint8_t* bits, uint8_t count) {
+    rmt_item32_t items[MAX_SLOTS];
+    for (uint8_t i = 0; i < count; i++) {
+        items[i] = readSlot();
+    }
+
+    rmt_item32_t* rx = nullptr;
+    size_t received = exchange(items, count, SLOT_IDLE_US, &rx);
+
+    // Un item por slot: duración del nivel bajo (corta = 1, extendida por el esclavo = 0)
+    for (uint8_t i = 0; i < count; i++) {
+        bits[i] = (i < received && rx[i].level0 == 0 && rx[i].duration0 < READ_SAMPLE_US) ? 1 : 0;
+    }
+    if (rx) vRingbufferReturnItem(rxRing, rx);
+}
+
+// ========================================
+// Interfaz OneWire
+// ========================================
+
+uint8_t OneWireRmt::reset(void) {
+    if (!init()) return 0;
+
+    rmt_item32_t item;
+    item.level0 = 0;
+    item.duration0 = RESET_LOW_US;
+    item.level1 = 1;
+    item.duration1 = RESET_RELEASE_US;
+
+    rmt_item32_t* rx = nullptr;
+    size_t received = exchange(&item, 1, RESET_IDLE_US, &rx);
+
+    // Reset propio (bajo >= 480 µs), liberación y pulso de presencia del esclavo
+    bool presence = received >= 2 &&
+                    rx[0].level0 == 0 && rx[0].duration0 >= RESET_LOW_US - 2 &&
+                    rx[0].level1 == 1 && rx[0].duration1 > 0 &&
+                    rx[1].level0 == 0;
+    if (rx) vRingbufferReturnItem(rxRing, rx);
+    return presence ? 1 : 0;
+}
+
+void OneWireRmt::write_bit(uint8_t v) {
+    if (!init()) return;
+    rmt_item32_t item = writeSlot(v & 1);
+    transmit(&item, 1);
+}
+
+uint8_t OneWireRmt::read_bit(void) {
+    if (!init()) return 1;
+    uint8_t bit;
+    readSlots(&bit, 1);
+    return bit;
+}
+
+void OneWireRmt::write(uint8_t v, uint8_t power) {
+    (void)power;
+    write_bytes(&v, 1);
+}
+
+void OneWireRmt::write_bytes(const uint8_t* buf, uint16_t count, bool power) {
+    (void)power;
+    if (!init()) return;
+
+    // Hasta 4 bytes (32 slots) por transmisión
+    rmt_item32_t items[MAX_SLOTS];
+    while (count > 0) {
+        uint8_t chunk = count > MAX_SLOTS / 8 ? MAX_SLOTS / 8 : count;
+        for (uint8_t b = 0; b < chunk; b++) {
+            for (uint8_t i = 0; i < 8; i++) {
+                items[b * 8 + i] = writeSlot((buf[b] >> i) & 1);  // LSB primero
+            }
+        }
+        transmit(items, chunk * 8);
+        buf += chunk;
+        count -= chunk;
+    }
+}
+
+uint8_t OneWireRmt::read(void) {
+    uint8_t value;
+    read_bytes(&value, 1);
+    return value;
+}
+
+void OneWireRmt::read_bytes(uint8_t* buf, uint16_t count) {
+    if (!init()) {
+        memset(buf, 0xFF, count);
+        return;
+    }
+
+    uint8_t bits[MAX_SLOTS];
+    while (count > 0) {
+        uint8_t chunk = count > MAX_SLOTS / 8 ? MAX_SLOTS / 8 : count;
+        readSlots(bits, chunk * 8);
+        for (uint8_t b = 0; b < chunk; b++) {
+            uint8_t value = 0;
+            for (uint8_t i = 0; i < 8; i++) {
+                value |= bits[b * 8 + i] << i;
+            }
+            buf[b] = value;
+        }
+        buf += chunk;
+        count -= chunk;
+    }
+}
+
+void OneWireRmt::select(const uint8_t rom[8]) {
+    uint8_t cmd[9];
+    cmd[0] = 0x55;  // Match ROM
+    memcpy(&cmd[1], rom, 8);
+    write_bytes(cmd, sizeof(cmd));
+}
+
+void OneWireRmt::skip(void) {
+    write(0xCC);  // Skip ROM
+}
+
+// ========================================
+// Búsqueda ROM (algoritmo de Maxim, como OneWire::search)
+// ========================================
+
+void OneWireRmt::reset_search() {
+    lastDiscrepancy = 0;
+    lastDeviceFlag = false;
+    lastFamilyDiscrepancy = 0;
+    memset(romNo, 0, sizeof(romNo));
+}
+
+void OneWireRmt::target_search(uint8_t family_code) {
+    reset_search();
+    romNo[0] = family_code;
+    lastDiscrepancy = 64;
+}
+
+bool OneWireRmt::search(uint8_t* newAddr, bool search_mode) {
+    uint8_t idBitNumber = 1;
+    uint8_t lastZero = 0;
+    uint8_t romByteNumber = 0;
+    uint8_t romByteMask = 1;
+    bool searchResult = false;
+
+    if (!lastDeviceFlag) {
+        if (!reset()) {
+            reset_search();
+            return false;
+        }
+
+        write(search_mode ? 0xF0 : 0xEC);  // Búsqueda normal o de alarmas
+
+        do {
+            uint8_t idBit = read_bit();
+            uint8_t cmpIdBit = read_bit();
+            uint8_t direction;
+
+            if (idBit == 1 && cmpIdBit == 1) {
+                break;  // Ningún dispositivo respondió
+            }
+
+            if (idBit != cmpIdBit) {
+                direction = idBit;
+            } else {
+                if (idBitNumber < lastDiscrepancy) {
+                    direction = (romNo[romByteNumber] & romByteMask) > 0;
+                } else {
+                    direction = (idBitNumber == lastDiscrepancy);
+                }
+                if (direction == 0) {
+                    lastZero = idBitNumber;
+                    if (lastZero < 9) lastFamilyDiscrepancy = lastZero;
+                }
+            }
+
+            if (direction == 1) romNo[romByteNumber] |= romByteMask;
+            else romNo[romByteNumber] &= ~romByteMask;
+
+            write_bit(direction);
+
+            idBitNumber++;
+            romByteMask <<= 1;
+            if (romByteMask == 0) {
+                romByteNumber++;
+                romByteMask = 1;
+            }
+        } while (romByteNumber < 8);
+
+        if (idBitNumber >= 65) {
+            lastDiscrepancy = lastZero;
+            if (lastDiscrepancy == 0) lastDeviceFlag = true;
+            searchResult = true;
+        }
+    }
+
+    if (!searchResult || !romNo[0]) {
+        reset_search();
+        return false;
+    }
+
+    memcpy(newAddr, romNo, 8);
+    return true;
+}
+
+uint8_t OneWireRmt::crc8(const uint8_t* addr, uint8_t len) {
+    // CRC Dallas/Maxim (x^8 + x^5 + x^4 + 1), versión compacta sin tabla
+    uint8_t crc = 0;
+    while (len--) {
+        uint8_t inbyte = *addr++;
+        for (uint8_t i = 8; i; i--) {
+            uint8_t mix = (crc ^ inbyte) & 0x01;
+            crc >>= 1;
+            if (mix) crc ^= 0x8C;
+            inbyte >>= 1;
+        }
+    }
+    return crc;
+}
+
+#endif // ONEWIRE_USE_RMT
@@ -0,0 +1,155 @@
+#include "PressureAcquisition.h"
+
+PressureAcquisition::PressureAcquisition(PressureSensor& sensor)
+    : sensor(sensor),
+      taskHandle(nullptr),
+      mux(portMUX_INITIALIZER_UNLOCKED),
+      busy(false),
+      edgeTimestampUs(0),
+      samplePeriodUs(SensorConfig::PRESSURE_SAMPLE_PERIOD_US),
+      samples(0),
+      dropped(0),
+      overruns(0),
+      timeouts(0),
+      readErrors(0),
+      lastReadUs(0),
+      maxReadUs(0),
+      lastTimestampUs(0),
+      hasLastTimestamp(false) {}
+
+// ========================================
+// Inicialización
+// ========================================
+
+bool PressureAcquisition::begin() {
+    if (taskHandle != nullptr) {
+        return true;
+    }
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskEntry, "pressure_acq",
+        SensorConfig::PRESSURE_TASK_STACK, this,
+        SensorConfig::PRESSURE_TASK_PRIORITY, &taskHandle,
+        SensorConfig::PRESSURE_TASK_CORE);
+
+    if (created != pdPASS) {
+        taskHandle = nullptr;
+        Serial.println("[SENSOR] ERROR: No se pudo crear la tarea de presión");
+        return false;
+    }
+
+    // La ISR usa taskHandle: engancharla después de crear la tarea
+    attachInterruptArg(digitalPinToInterrupt(HardwarePins::PRESSURE_DOUT),
+                       onDataReady, this, FALLING);
+    return true;
+}
+
+PressureAcquisition::Stats PressureAcquisition::getStats() const {
+    Stats stats;
+    stats.samples = samples;
+    stats.dropped = dropped;
+    stats.overruns = overruns;
+    stats.timeouts = timeouts;
+    stats.readErrors = readErrors;
+    stats.lastReadUs = lastReadUs;
+    stats.maxReadUs = maxReadUs;
+    return stats;
+}
+
+// ========================================
+// ISR y tarea
+// ========================================
+
+void IRAM_ATTR PressureAcquisition::onDataReady(void* arg) {
+    PressureAcquisition* self = static_cast<PressureAcquisition*>(arg);
+
+    // Durante la lectura DOUT cambia con cada bit: esos flancos no son datos nuevos
+    portENTER_CRITICAL_ISR(&self->mux);
+    if (self->busy) {
+        portEXIT_CRITICAL_ISR(&self->mux);
+        return;
+    }
+    self->busy = true;
+    self->edgeTimestampUs = micros();
+    portEXIT_CRITICAL_ISR(&self->mux);
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(self->taskHandle, &woken);
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void PressureAcquisition::taskEntry(void* arg) {
+    static_cast<PressureAcquisition*>(arg)->run();
+}
+
+void PressureAcquisition::run() {
+    const TickType_t timeout = pdMS_TO_TICKS(SensorConfig::PRESSURE_TASK_TIMEOUT_MS);
+
+    for (;;) {
+        if (ulTaskNotifyTake(pdTRUE, timeout) > 0) {
+            acquire(edgeTimestampUs);
+            continue;
+        }
+
+        // Sin flanco: puede que DOUT ya estuviera en LOW al re-habilitar la lectura
+        timeouts++;
+        if (sensor.is_ready() && claim()) {
+            acquire(micros());
+        }
+    }
+}
+
+bool PressureAcquisition::claim() {
+    bool claimed = false;
+    portENTER_CRITICAL(&mux);
+    if (!busy) {
+        busy = true;
+        claimed = true;
+    }
+    portEXIT_CRITICAL(&mux);
+    return claimed;
+}
+
+void PressureAcquisition::acquire(uint32_t timestampUs) {
+    // Conversión ya lista: la lectura no espera al sensor
+    PressureSample sample;
+    uint32_t readStartUs = micros();
+    bool ok = readPressureSensor(sensor, sample.raw);
+    uint32_t readUs = micros() - readStartUs;
+    lastReadUs = readUs;
+    if (readUs > maxReadUs) maxReadUs = readUs;
+    sample.timestampUs = timestampUs;
+
+    if (!ok) {
+        // Sin muestra: la falta de datos la detecta FaultMonitor
+        readErrors++;
+        portENTER_CRITICAL(&mux);
+        busy = false;
+        portEXIT_CRITICAL(&mux);
+        return;
+    }
+
+    // Conversiones perdidas: hueco mayor a 1.5 periodos nominales
+    if (hasLastTimestamp) {
+        uint32_t dt = timestampUs - lastTimestampUs;
+        uint32_t period = samplePeriodUs;
+        if (dt > period + period / 2) {
+            overruns += (dt + period / 2) / period - 1;
+        }
+    }
+    lastTimestampUs = timestampUs;
+    hasLastTimestamp = true;
+
+    if (queue.push(sample)) {
+        samples++;
+    } else {
+        dropped++;
+    }
+
+    // Fin de la lectura: aceptar el próximo flanco
+    portENTER_CRITICAL(&mux);
+    busy = false;
+    portEXIT_CRITICAL(&mux);
+}
@@ -1,69 +1,69 @@
 #include "SensorManager.h"
+#include "PressureMath.h"
 
 SensorManager::SensorManager()
     : monitoringActive(false),
+      taskHandle(nullptr),
+      stateMutex(nullptr),
+      cycleStats{0, UINT32_MAX, 0, 0, 0, 0, 0, 0},
+      jitterSumUs(0),
+      lastCycleStartUs(0),
+      requestedMode(Sampling::MODE_IDLE),
+      samplingMode(Sampling::MODE_COUNT),
+      sampleTaken(false),
+      lastSampleTakenUs(0),
+      lastFillRateMs(0),
+      rateCounter{0, 0, 0, 0},
+      pressureRateCHz(0),
+      levelRateCHz(0),
+      temperatureRateCHz(0),
       oneWire(HardwarePins::TEMPERATURE),
-      tempSensor(&oneWire),
-      tempSensorFound(false),
+      tempBus(oneWire),
       currentTemperature(0.0),
       temperatureValid(false),
-      lastTempRead(0),
-      tempConversionInProgress(false),
+      lastTempRound(0),
+      temperatureTarget(NO_TEMP_TARGET),
+      alarmTemperature(NO_TEMP_TARGET),
       currentPressure(0),
+      filteredPressure(0),
       currentWaterLevel(0),
-      lastPressureRead(0) {}
+      currentWaterLevelCenti(0),
+      calibration(LevelCalibration::fromConfig()),
+      levelTable(PressureMath::DEFAULT_LEVEL_TABLE),
+      lastPressureRead(0),
+      pressureAcq(pressureSensor),
+      lastPressureSampleUs(0),
+      pressureClockUs(0),
+      zeroOffset(0),
+      zeroCorrection(0),
+      requestedAgitation(0),
+      agitationActive(false),
+      agitationSettled(false),
+      settledSinceUs(0),
+      sloshStats{0, 0} {}
 
 // ========================================
 // Inicialización
 // ========================================
 
 void SensorManager::begin() {
-    // Inicializar sensor de temperatura
-    tempSensor.begin();
-
-    // IMPORTANTE: Configurar para lecturas asíncronas (no bloqueantes)
-    tempSensor.setWaitForConversion(false);
-
-    // Verificar si hay CUALQUIER dispositivo en el bus OneWire.
-    // oneWire.search() no se bloquea si no hay nada conectado.
-    uint8_t addr[8];
-    if (oneWire.search(addr)) {
-        tempSensorFound = true;
-        tempSensor.setResolution(SensorConfig::TEMP_RESOLUTION);
-        Serial.println("Sensor de temperatura DS18B20 encontrado.");
-
-        // Mostrar dirección encontrada para debug
-        Serial.print("Dirección detectada: {");
-        for (int i = 0; i < 8; i++) {
-            Serial.print("0x");
-            if (addr[i] < 16) Serial.print("0");
-            Serial.print(addr[i], HEX);
-            if (i < 7) Serial.print(", ");
-        }
-        Serial.println("}");
-
-        // Verificar si la dirección encontrada es la que esperamos
-        if (memcmp(addr, SensorConfig::TEMP_SENSOR_ADDR, 8) != 0) {
-            Serial.println("*** ADVERTENCIA: La dirección del sensor NO coincide con Config.h ***");
-            Serial.print("Dirección en Config.h: {");
-            for (int i = 0; i < 8; i++) {
-                Serial.print("0x");
-                if (SensorConfig::TEMP_SENSOR_ADDR[i] < 16) Serial.print("0");
-                Serial.print(SensorConfig::TEMP_SENSOR_ADDR[i], HEX);
-                if (i < 7) Serial.print(", ");
-            }
-        } else {
-            Serial.println("Dirección del sensor OK (coincide con Config.h)");
-        }
-    } else {
-        Serial.println("ADVERTENCIA: Sensor de temperatura DS18B20 NO encontrado. Funcionando sin él.");
+    // Sensores de temperatura: las direcciones se asignan en beginTemperature()
+    // (desde Storage o con búsqueda en el bus)
+
+    // Inicializar sensor de presión (sin él, FaultMonitor reporta falta de datos)
+    if (!beginPressureSensor(pressureSensor)) {
+        Serial.printf("[SENSOR] ERROR: %s no inicializado\n", PRESSURE_SENSOR_NAME);
     }
+    pressureSensor.set_sampler_window(SensorConfig::PRESSURE_SAMPLE_WINDOW);
 
-    // Inicializar sensor de presión
-    pressureSensor.begin(HardwarePins::PRESSURE_DOUT, HardwarePins::PRESSURE_SCLK);
+    // Adquisición por interrupción: loop() ya no lee el sensor
+    if (SensorConfig::PRESSURE_ACQ_TASK) {
+        pressureAcq.begin();
+    }
 
     // NO usar tare() para evitar bloqueos en el inicio
-    // La calibración se hará manualmente ajustando PRESSURE_OFFSET en Config.h
+    // La calibración se hará manualmente ajustando PRESSURE_OFFSET en Config.h;
+    // la deriva posterior la corrige trackZero() al final de cada drenaje
     // Serial.println("Sensor de presión inicializado (sin auto-calibración).");
 
     // Mostrar umbrales de calibración
@@ -79,22 +79,256 @@ void SensorManager::begin() {
     forceRead();
 }
 
+bool SensorManager::beginTemperature(const TemperatureBus::Address* savedAddresses) {
+    static const uint8_t EMPTY[8] = {0};
+
+    if (savedAddresses) {
+        for (uint8_t i = 0; i < SensorConfig::TEMP_SENSOR_COUNT; i++) {
+            if (memcmp(savedAddresses[i], EMPTY, 8) != 0) {
+                tempBus.setAddress(i, savedAddresses[i]);
+            }
+        }
+    } else {
+        // Primer arranque: la dirección de Config.h conserva el puesto del tambor si está
+        tempBus.setAddress(SensorConfig::TEMP_DRUM, SensorConfig::TEMP_SENSOR_ADDR);
+    }
+
+    // Arranque en caliente: basta con que cada dirección guardada responda.
+    // La búsqueda no cambia la asignación: solo se guarda la del primer arranque.
+    if (savedAddresses && tempBus.verify()) {
+        Serial.printf("Sensores de temperatura verificados (%d, sin búsqueda)\n",
+                      tempBus.getSensorCount());
+    } else {
+        tempBus.discover();
+    }
+    bool changed = !savedAddresses;
+
+    if (!tempBus.isAssigned(SensorConfig::TEMP_DRUM) || tempBus.isMissing(SensorConfig::TEMP_DRUM)) {
+        Serial.println("ADVERTENCIA: Sonda del tambor sin asignar o ausente. Asignarla desde calibración.");
+    }
+
+    updateAlarmLimits();
+    tempBus.applyResolution();
+    return changed;
+}
+
 // ========================================
 // Actualización periódica
 // ========================================
 
 void SensorManager::update() {
-    // Solo actualizar si el monitoreo está activo
-    if (!monitoringActive) {
-        return;
-    }
+    // Con la tarea corriendo, loop() solo consume instantáneas
+    if (taskHandle != nullptr) return;
+    runCycle();
+}
 
-    // Temperatura: Llamar SIEMPRE (es asíncrona, no bloquea)
-    // Esto permite verificar constantemente si la conversión terminó
+void SensorManager::runCycle() {
+    lock();
+    applySamplingMode();
+    applyAgitation();
+
+    // Temperatura: Llamar SIEMPRE (es asíncrona, no bloquea); el intervalo
+    // entre rondas lo fija el perfil de muestreo
     readTemperature();
 
-    // Presión: También asíncrona, verifica intervalo internamente
+    // Presión: consumir las muestras de la tarea del HX710B (el perfil
+    // decide cuáles se usan)
     readPressure();
+    faults.checkPressureTimeout(micros());  // Después de vaciar la cola
+
+    updateSamplingRates(millis());
+    publishSnapshot();
+    unlock();
+}
+
+void SensorManager::publishSnapshot() {
+    SensorSnapshot s;
+    s.timestampUs = micros();
+    s.monitoring = monitoringActive;
+
+    s.pressureValid = pressureFilter.hasValue();
+    s.pressurePrimed = pressureFilter.isPrimed();
+    s.pressureSampleUs = lastPressureSampleUs;
+    s.pressurePa = currentPressure;
+    s.filteredPa = filteredPressure;
+    s.filteredRaw = pressureFilter.value();
+    s.fillRate = fillRate.getRate();
+    s.waterLevel = currentWaterLevel;
+    s.waterLevelCenti = currentWaterLevelCenti;
+
+    s.temperatureValid = temperatureValid;
+    s.temperature = currentTemperature;
+    s.temperatureMs = tempBus.getStats(SensorConfig::TEMP_DRUM).lastOkMs;
+    s.sensorValidMask = 0;
+    for (uint8_t i = 0; i < SensorConfig::TEMP_SENSOR_COUNT; i++) {
+        s.sensorTemperatures[i] = tempBus.getTemperature(i);
+        if (tempBus.isValid(i)) s.sensorValidMask |= 1 << i;
+    }
+    s.alarmMask = tempBus.getAlarmMask();
+    s.temperatureResolution = tempBus.getResolution();
+    s.sensorMissingMask = tempBus.getMissingMask();
+    s.identifyState = tempBus.getIdentifyState();
+    s.assignmentVersion = tempBus.getAssignmentVersion();
+
+    s.samplingMode = samplingMode;
+    s.pressureRateCHz = pressureRateCHz;
+    s.levelRateCHz = levelRateCHz;
+    s.temperatureRateCHz = temperatureRateCHz;
+    s.faultCode = faults.getFault();
+    s.sloshAccepted = sloshStats.accepted;
+    s.sloshRejected = sloshStats.rejected;
+
+    snapshot.write(s);
+}
+
+// ========================================
+// Plan de muestreo
+// ========================================
+
+void SensorManager::applySamplingMode() {
+    uint8_t mode = monitoringActive ? requestedMode : Sampling::MODE_IDLE;
+    if (mode >= Sampling::MODE_COUNT) mode = Sampling::MODE_IDLE;
+    if (mode == samplingMode) return;
+    samplingMode = mode;
+
+    const Sampling::Profile& profile = Sampling::PROFILES[mode];
+    setPressureSensorFast(pressureSensor, profile.pressureFast);
+    pressureAcq.setSamplePeriodUs(profile.pressureFast ? SensorConfig::PRESSURE_FAST_PERIOD_US
+                                                       : SensorConfig::PRESSURE_SAMPLE_PERIOD_US);
+    pressureSensor.set_sampler_window(profile.pressureWindow);
+    tempBus.setRoundInterval(profile.temperatureIntervalMs);
+    sampleTaken = false;
+
+    // Las tasas logradas se miden por modo
+    rateCounter = {0, 0, 0, millis()};
+    pressureRateCHz = 0;
+    levelRateCHz = 0;
+    temperatureRateCHz = 0;
+    log_d("[SENSOR] Modo de muestreo %u", mode);
+}
+
+bool SensorManager::takePressureSample(uint32_t timestampUs) {
+    // Separación mínima del perfil: el resto de las muestras se descarta
+    uint16_t intervalMs = Sampling::PROFILES[samplingMode].pressureIntervalMs;
+    if (intervalMs > 0 && sampleTaken &&
+        timestampUs - lastSampleTakenUs < (uint32_t)intervalMs * 1000) {
+        return false;
+    }
+    sampleTaken = true;
+    lastSampleTakenUs = timestampUs;
+    return true;
+}
+
+void SensorManager::updateSamplingRates(unsigned long nowMs) {
+    unsigned long elapsedMs = nowMs - rateCounter.windowStartMs;
+    if (elapsedMs < Sampling::RATE_WINDOW_MS) return;
+
+    auto centiHz = [elapsedMs](uint32_t count) -> uint16_t {
+        uint32_t rate = (uint32_t)(((uint64_t)count * 100000) / elapsedMs);
+        return (rate > UINT16_MAX) ? UINT16_MAX : rate;
+    };
+    pressureRateCHz = centiHz(rateCounter.pressureSamples);
+    levelRateCHz = centiHz(rateCounter.levelUpdates);
+    temperatureRateCHz = centiHz(rateCounter.temperatureRounds);
+    rateCounter = {0, 0, 0, nowMs};
+
+    log_d("[SENSOR] Modo %u: presión %u.%02u Hz, nivel %u.%02u Hz, temperatura %u.%02u Hz",
+          samplingMode, pressureRateCHz / 100, pressureRateCHz % 100,
+          levelRateCHz / 100, levelRateCHz % 100,
+          temperatureRateCHz / 100, temperatureRateCHz % 100);
+
+    // Costo por muestra del frente de presión (comparación HX710B / ADS1115)
+    PressureAcquisition::Stats acq = pressureAcq.getStats();
+    log_d("[SENSOR] %s: %lu muestras, lectura %lu us (max %lu), %lu errores, %lu perdidas",
+          PRESSURE_SENSOR_NAME, (unsigned long)acq.samples, (unsigned long)acq.lastReadUs,
+          (unsigned long)acq.maxReadUs, (unsigned long)acq.readErrors, (unsigned long)acq.overruns);
+
+    // Periodo real de la tarea (acumulado desde beginTask; sin tarea no hay)
+    const TaskStats& task = cycleStats;
+    if (task.cycles == 0) return;
+    log_d("[SENSOR] Tarea: %lu ciclos, periodo %lu..%lu us, jitter medio %lu us (max %lu), "
+          "trabajo %lu us (max %lu), %lu excedidos",
+          (unsigned long)task.cycles, (unsigned long)task.minPeriodUs, (unsigned long)task.maxPeriodUs,
+          (unsigned long)task.meanJitterUs, (unsigned long)task.maxJitterUs,
+          (unsigned long)task.lastWorkUs, (unsigned long)task.maxWorkUs, (unsigned long)task.overruns);
+}
+
+// ========================================
+// Tarea de adquisición
+// ========================================
+
+bool SensorManager::beginTask() {
+    if (taskHandle != nullptr || !SensorConfig::SENSOR_TASK) {
+        return taskHandle != nullptr;
+    }
+
+    stateMutex = xSemaphoreCreateMutex();
+    if (stateMutex == nullptr) {
+        Serial.println("[SENSOR] ERROR: No se pudo crear el mutex de sensores");
+        return false;
+    }
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskEntry, "sensor_acq",
+        SensorConfig::SENSOR_TASK_STACK, this,
+        SensorConfig::SENSOR_TASK_PRIORITY, &taskHandle,
+        SensorConfig::SENSOR_TASK_CORE);
+
+    if (created != pdPASS) {
+        taskHandle = nullptr;
+        Serial.println("[SENSOR] ERROR: No se pudo crear la tarea de sensores (se usa loop())");
+        return false;
+    }
+    return true;
+}
+
+void SensorManager::taskEntry(void* arg) {
+    static_cast<SensorManager*>(arg)->run();
+}
+
+void SensorManager::run() {
+    const TickType_t period = pdMS_TO_TICKS(SensorConfig::SENSOR_TASK_PERIOD_MS);
+    TickType_t lastWake = xTaskGetTickCount();
+
+    for (;;) {
+        // Periodo fijo desde la activación anterior (no desde el fin del trabajo)
+        vTaskDelayUntil(&lastWake, period);
+
+        uint32_t startUs = micros();
+        runCycle();
+        recordCycle(startUs, micros() - startUs);
+    }
+}
+
+void SensorManager::recordCycle(uint32_t startUs, uint32_t workUs) {
+    constexpr uint32_t NOMINAL_US = SensorConfig::SENSOR_TASK_PERIOD_MS * 1000UL;
+    TaskStats& s = cycleStats;
+
+    if (s.cycles > 0) {
+        uint32_t periodUs = startUs - lastCycleStartUs;
+        uint32_t jitterUs = (periodUs > NOMINAL_US) ? periodUs - NOMINAL_US : NOMINAL_US - periodUs;
+        if (periodUs < s.minPeriodUs) s.minPeriodUs = periodUs;
+        if (periodUs > s.maxPeriodUs) s.maxPeriodUs = periodUs;
+        if (jitterUs > s.maxJitterUs) s.maxJitterUs = jitterUs;
+        jitterSumUs += jitterUs;
+        s.meanJitterUs = jitterSumUs / s.cycles;
+    }
+    lastCycleStartUs = startUs;
+    s.cycles++;
+
+    s.lastWorkUs = workUs;
+    if (workUs > s.maxWorkUs) s.maxWorkUs = workUs;
+    if (workUs > NOMINAL_US) s.overruns++;
+
+    taskStats.write(s);
+}
+
+void SensorManager::lock() {
+    if (stateMutex != nullptr) xSemaphoreTake(stateMutex, portMAX_DELAY);
+}
+
+void SensorManager::unlock() {
+    if (stateMutex != nullptr) xSemaphoreGive(stateMutex);
 }
 
 // ========================================
@@ -102,23 +336,207 @@ void SensorManager::update() {
 // ========================================
 
 void SensorManager::startMonitoring() {
+    lock();
     monitoringActive = true;
+    fillRate.reset();  // No mezclar muestras de antes de la pausa en la regresión
+    faults.reset(micros());
+    // Sin esperar al próximo ciclo: la instantánea vieja aún tiene la falla
+    // anterior y loop() la tomaría como nueva al arrancar el programa.
+    // Con stateMutex tomado la tarea no publica: un solo escritor a la vez.
+    publishSnapshot();
+    unlock();
     // Serial.println("[SENSOR] Monitoreo ACTIVADO");
 }
 
 void SensorManager::stopMonitoring() {
+    lock();
     monitoringActive = false;
-    tempConversionInProgress = false;  // Cancelar conversión en progreso
+    tempBus.cancel();  // Cancelar ronda en progreso
+    unlock();
     // Serial.println("[SENSOR] Monitoreo DESACTIVADO");
 }
 
+// ========================================
+// Asignación de sondas de temperatura
+// ========================================
+
+bool SensorManager::identifyTemperatureSensor(uint8_t id) {
+    lock();
+    bool started = tempBus.startIdentify(id, millis());
+    unlock();
+    return started;
+}
+
+void SensorManager::cancelTemperatureIdentify() {
+    lock();
+    tempBus.cancelIdentify();
+    unlock();
+}
+
+void SensorManager::copyTemperatureAddresses(TemperatureBus::Address* out) {
+    lock();
+    memcpy(out, tempBus.getAddresses(), sizeof(TemperatureBus::Address) * SensorConfig::TEMP_SENSOR_COUNT);
+    unlock();
+}
+
+// ========================================
+// Seguimiento del cero
+// ========================================
+
+bool SensorManager::trackZero() {
+    lock();
+    bool changed = estimateZeroOffset();
+    unlock();
+    return changed;
+}
+
+bool SensorManager::estimateZeroOffset() {
+    // Estimación no bloqueante: el valor filtrado que ya se viene calculando
+    if (!pressureFilter.hasValue()) return false;
+
+    constexpr int32_t MAX_STEP = PressureMath::rawFromPascalDelta(SensorConfig::ZERO_TRACK_MAX_STEP_PA);
+    constexpr int32_t MAX_ERROR = PressureMath::rawFromPascalDelta(SensorConfig::ZERO_TRACK_MAX_ERROR_PA);
+
+    // Error respecto del nivel 0 de la calibración activa (cuentas ya corregidas)
+    int32_t error = pressureFilter.value() - calibration.rawForLevelCenti(0);
+    if (error > MAX_ERROR || error < -MAX_ERROR) {
+        Serial.printf("[SENSOR] Cero descartado: error %ld cuentas (¿agua remanente?)\n", (long)error);
+        return false;
+    }
+
+    int32_t step = error / (1 << SensorConfig::ZERO_TRACK_SHIFT);
+    step = constrain(step, -MAX_STEP, MAX_STEP);
+    if (step == 0) return false;
+
+    int32_t previous = zeroOffset;
+    applyZeroOffset(zeroOffset + step);
+    return zeroOffset != previous;
+}
+
+void SensorManager::setZeroOffset(int32_t offset) {
+    lock();
+    applyZeroOffset(offset);
+    unlock();
+}
+
+void SensorManager::applyZeroOffset(int32_t offset) {
+    constexpr int32_t MAX_OFFSET = PressureMath::rawFromPascalDelta(SensorConfig::ZERO_TRACK_MAX_OFFSET_PA);
+    zeroOffset = constrain(offset, -MAX_OFFSET, MAX_OFFSET);
+    updateZeroCorrection();
+}
+
+void SensorManager::updateZeroCorrection() {
+    zeroCorrection = zeroOffset;
+
+    // Deriva térmica opcional: coeficiente en cPa/°C, temperatura en décimas
+    if (SensorConfig::ZERO_TEMP_COEFF_CPA != 0 && temperatureValid) {
+        int32_t deltaDeci = (int32_t)(currentTemperature * 10) - SensorConfig::ZERO_TEMP_REF_C * 10;
+        int64_t centiPa = (int64_t)SensorConfig::ZERO_TEMP_COEFF_CPA * deltaDeci / 10;
+        zeroCorrection += (int32_t)((centiPa << PressureMath::PASCAL_Q_SHIFT) /
+                                    (PressureMath::PASCAL_PER_COUNT_Q * 100));
+    }
+}
+
+// ========================================
+// Sincronización con la agitación
+// ========================================
+
+void SensorManager::setAgitation(bool agitating, bool settled) {
+    // Lo aplica la tarea al comienzo del próximo ciclo
+    requestedAgitation = (agitating ? AGITATION_ON : 0) | (settled ? AGITATION_SETTLED : 0);
+}
+
+void SensorManager::applyAgitation() {
+    uint8_t request = requestedAgitation;
+    bool agitating = request & AGITATION_ON;
+    bool settled = request & AGITATION_SETTLED;
+
+    // Flanco de entrada a la ventana quieta: las muestras con marca de tiempo
+    // anterior (aún en la cola) fueron tomadas con el agua en movimiento.
+    // Marcarlo en la tarea lo atrasa como mucho un periodo (lado seguro).
+    if (settled && !agitationSettled) {
+        settledSinceUs = micros();
+    }
+    agitationActive = agitating;
+    agitationSettled = settled;
+}
+
+bool SensorManager::acceptPressureSample(uint32_t timestampUs) {
+    if (!agitationActive) return true;
+
+    if (agitationSettled && (int32_t)(timestampUs - settledSinceUs) >= 0) {
+        sloshStats.accepted++;
+        return true;
+    }
+    sloshStats.rejected++;
+    return false;
+}
+
+// ========================================
+// Velocidad de llenado
+// ========================================
+
+int32_t SensorManager::getLevelThresholdRaw(uint8_t targetLevel) const {
+    if (targetLevel == 0) return INT32_MIN;
+    if (targetLevel > PressureMath::LEVEL_COUNT) return INT32_MAX;
+    return levelTable.raw[targetLevel - 1];
+}
+
+uint32_t SensorManager::estimateMsToLevel(uint8_t targetLevel) const {
+    // Nivel, cuentas y pendiente de la misma instantánea
+    SensorSnapshot s = snapshot.read();
+    if (s.waterLevel >= targetLevel) return 0;
+    if (targetLevel > PressureMath::LEVEL_COUNT) return UINT32_MAX;
+    return FillRateEstimator::estimateMs(s.fillRate, s.filteredRaw, getLevelThresholdRaw(targetLevel));
+}
+
+bool SensorManager::shouldStopFilling(uint8_t targetLevel, uint16_t latencyMs) const {
+    SensorSnapshot s = snapshot.read();
+    if (s.waterLevel >= targetLevel) return true;
+    if (targetLevel > PressureMath::LEVEL_COUNT) return false;
+
+    // Paso de nivel del tramo del objetivo (para el nivel 1, el siguiente)
+    uint8_t upper = (targetLevel >= 2) ? targetLevel - 1 : 1;
+    int32_t stepRaw = levelTable.raw[upper] - levelTable.raw[upper - 1];
+    int32_t maxLeadRaw = (int32_t)((int64_t)stepRaw * SensorConfig::FILL_CUTOFF_MAX_LEAD_PCT / 100);
+    return FillRateEstimator::shouldCutOff(s.fillRate, s.filteredRaw, getLevelThresholdRaw(targetLevel),
+                                           maxLeadRaw, latencyMs);
+}
+
+// ========================================
+// Calibración de nivel
+// ========================================
+
+bool SensorManager::setCalibration(const LevelCalibration& newCalibration) {
+    PressureMath::LevelTable table;
+    if (!newCalibration.buildLevelTable(table)) {
+        return false;
+    }
+
+    lock();
+    calibration = newCalibration;
+    levelTable = table;
+
+    // Los umbrales cambiaron: recalcular el nivel desde cero (sin histéresis previa)
+    pressureFilter.resetLevel();
+    if (pressureFilter.hasValue()) {
+        currentWaterLevel = calculateWaterLevel();
+        currentWaterLevelCenti = calibration.levelCentiFromRaw(pressureFilter.value());
+    }
+    unlock();
+    return true;
+}
+
 // ========================================
 // Lectura forzada inmediata
 // ========================================
 
 void SensorManager::forceRead() {
+    lock();
     readTemperature();
     readPressure();
+    publishSnapshot();
+    unlock();
 }
 
 // ========================================
@@ -126,22 +544,25 @@ void SensorManager::forceRead() {
 // ========================================
 
 bool SensorManager::hasReachedLevel(uint8_t targetLevel) const {
-    return currentWaterLevel >= targetLevel;
+    return getWaterLevel() >= targetLevel;
 }
 
 bool SensorManager::hasReachedTemperature(uint8_t targetTemp, uint8_t tolerance) const {
-    if (!temperatureValid) return false;
-    return abs(currentTemperature - targetTemp) <= tolerance;
+    SensorSnapshot s = snapshot.read();
+    if (!s.temperatureValid) return false;
+    return abs(s.temperature - targetTemp) <= tolerance;
 }
 
 bool SensorManager::isTemperatureTooHigh(uint8_t targetTemp, uint8_t tolerance) const {
-    if (!temperatureValid) return false;
-    return currentTemperature > (targetTemp + tolerance);
+    SensorSnapshot s = snapshot.read();
+    if (!s.temperatureValid) return false;
+    return s.temperature > (targetTemp + tolerance);
 }
 
 bool SensorManager::isTemperatureTooLow(uint8_t targetTemp, uint8_t tolerance) const {
-    if (!temperatureValid) return false;
-    return currentTemperature < (targetTemp - tolerance);
+    SensorSnapshot s = snapshot.read();
+    if (!s.temperatureValid) return false;
+    return s.temperature < (targetTemp - tolerance);
 }
 
 // ========================================
@@ -149,88 +570,137 @@ bool SensorManager::isTemperatureTooLow(uint8_t targetTemp, uint8_t tolerance) c
 // ========================================
 
 void SensorManager::readTemperature() {
-    // No hacer nada si el sensor no fue encontrado en el arranque
-    if (!tempSensorFound) {
-        temperatureValid = false;
+    // Ronda NO BLOQUEANTE: una conversión broadcast para todos los sensores y,
+    // vencido el plazo, un sensor leído por llamada
+    tempBus.update(millis());
+
+    // Publicar el sensor del tambor al terminar cada ronda
+    if (tempBus.getRounds() == lastTempRound) {
         return;
     }
+    lastTempRound = tempBus.getRounds();
+    rateCounter.temperatureRounds++;
+    if (tempBus.isAssigned(SensorConfig::TEMP_DRUM)) {
+        faults.checkTemperatureRound(tempBus.isValid(SensorConfig::TEMP_DRUM),
+                                     tempBus.getTemperature(SensorConfig::TEMP_DRUM));
+    }
 
-    // Lectura ASÍNCRONA (no bloqueante) - igual que código anterior
-    if (tempConversionInProgress) {
-        // Verificar si la conversión terminó
-        if (tempSensor.isConversionComplete()) {
-            float temp = tempSensor.getTempC(SensorConfig::TEMP_SENSOR_ADDR);
-            tempConversionInProgress = false;
-            lastTempRead = millis();  // Actualizar timestamp al completar
-
-            if (temp != DEVICE_DISCONNECTED_C && temp >= -55 && temp <= 125) {
-                currentTemperature = temp;
-                temperatureValid = true;
-            } else {
-                temperatureValid = false;
-                Serial.println("Error: Sensor de temperatura desconectado");
-            }
-        }
-        // Si no terminó, esperar al próximo ciclo (NO BLOQUEA)
-    } else {
-        // Solo iniciar nueva conversión si pasó el intervalo
-        unsigned long now = millis();
-        if (now - lastTempRead >= Timing::SENSOR_READ_INTERVAL_MS) {
-            tempSensor.requestTemperatures();
-            tempConversionInProgress = true;
-        }
+    bool wasValid = temperatureValid;
+    temperatureValid = tempBus.isValid(SensorConfig::TEMP_DRUM);
+    if (temperatureValid) {
+        currentTemperature = tempBus.getTemperature(SensorConfig::TEMP_DRUM);
+    } else if (wasValid) {
+        Serial.println("Error: Sensor de temperatura desconectado");
     }
+    updateZeroCorrection();
+
+    // Ajustar la resolución para la próxima ronda según la distancia a la consigna
+    tempBus.requestResolution(selectTemperatureResolution());
+    updateAlarmLimits();
 }
 
-void SensorManager::readPressure() {
-    // OPTIMIZACIÓN: Verificar is_ready() es muy rápido, pero leer puede tardar
-    // Solo leer si realmente pasó el intervalo completo desde última lectura
-    unsigned long now = millis();
-    if (now - lastPressureRead < Timing::SENSOR_READ_INTERVAL_MS) {
-        return;  // Salir rápido si no es momento de leer
+void SensorManager::updateAlarmLimits() {
+    // Agua (tambor y entrada): consigna del proceso + margen, con tope fijo
+    int16_t waterHigh = SensorConfig::TEMP_ALARM_MAX_C;
+    if (alarmTemperature != NO_TEMP_TARGET) {
+        waterHigh = min<int16_t>(alarmTemperature + SensorConfig::TEMP_ALARM_MARGIN_C, waterHigh);
     }
 
-    if (pressureSensor.is_ready()) {
-        // Leer solo con pascal() (como código anterior)
-        float pressurePascal = pressureSensor.pascal();
-        currentPressure = (long)pressurePascal;
-        currentWaterLevel = calculateWaterLevel(currentPressure);
-        lastPressureRead = now;  // Actualizar timestamp aquí
+    // Solo marca reconfiguración si algún límite cambió
+    tempBus.setAlarmLimits(SensorConfig::TEMP_DRUM, waterHigh, SensorConfig::TEMP_ALARM_LOW_C);
+    tempBus.setAlarmLimits(SensorConfig::TEMP_INLET, waterHigh, SensorConfig::TEMP_ALARM_LOW_C);
+    tempBus.setAlarmLimits(SensorConfig::TEMP_MOTOR, SensorConfig::TEMP_MOTOR_ALARM_C,
+                           SensorConfig::TEMP_ALARM_LOW_C);
+}
 
-        // Debug deshabilitado (ralentiza el sistema)
-        // Serial.printf("[SENSOR] Presion: %.2f Pa → Nivel: %d\n",
-        //               pressurePascal, currentWaterLevel);
+uint8_t SensorManager::selectTemperatureResolution() const {
+    // Sin consigna o sin dato: conversión rápida (solo se muestra)
+    if (temperatureTarget == NO_TEMP_TARGET || !temperatureValid) {
+        return SensorConfig::TEMP_RESOLUTION;
     }
+
+    float distance = fabs(currentTemperature - temperatureTarget);
+    if (distance <= SensorConfig::TEMP_BAND_NEAR_C) return SensorConfig::TEMP_RESOLUTION_NEAR;
+    if (distance <= SensorConfig::TEMP_BAND_MID_C) return SensorConfig::TEMP_RESOLUTION_MID;
+    return SensorConfig::TEMP_RESOLUTION;
 }
 
-uint8_t SensorManager::calculateWaterLevel(long pressure) {
-    // Aplicar offset manual (sin tare)
-    float pressureFloat = (float)(pressure - SensorConfig::PRESSURE_OFFSET);
+void SensorManager::readPressure() {
+    if (pressureAcq.isRunning()) {
+        drainPressureQueue();
+        return;
+    }
 
-    if (pressureFloat < SensorConfig::PRESSURE_LEVEL_1) {
-        return 0;  // Sin agua
+    // Muestreo NO BLOQUEANTE: read_if_ready() lee como máximo una conversión y
+    // solo si el sensor ya tiene el dato listo (DOUT en LOW en el HX710B, un
+    // periodo desde la última lectura en el ADS1115). Nunca espera al chip.
+    long raw;
+    if (pressureSensor.read_if_ready(raw)) {
+        processPressureSample(raw, micros());
     }
+}
+
+void SensorManager::drainPressureQueue() {
+    // Consumir todas las muestras que la tarea de adquisición dejó en la cola
+    PressureSample sample;
+    while (pressureAcq.pop(sample)) {
+        processPressureSample(sample.raw, sample.timestampUs);
+    }
+}
+
+void SensorManager::processPressureSample(int32_t raw, uint32_t timestampUs) {
+    // Plausibilidad sobre todas las muestras (antes de decimar o descartar)
+    faults.checkPressureSample(raw, timestampUs);
 
-    if (pressureFloat < SensorConfig::PRESSURE_LEVEL_2) {
-        float p = (pressureFloat - SensorConfig::PRESSURE_LEVEL_1) /
-                  (SensorConfig::PRESSURE_LEVEL_2 - SensorConfig::PRESSURE_LEVEL_1);
-        uint8_t level = (uint8_t)(1 + p);
-        return (level < 1) ? 1 : ((level > 2) ? 2 : level);  // Nivel 1-2 interpolado
+    // Cadencia del perfil de muestreo vigente
+    if (!takePressureSample(timestampUs)) {
+        return;
     }
 
-    if (pressureFloat < SensorConfig::PRESSURE_LEVEL_3) {
-        float p = (pressureFloat - SensorConfig::PRESSURE_LEVEL_2) /
-                  (SensorConfig::PRESSURE_LEVEL_3 - SensorConfig::PRESSURE_LEVEL_2);
-        uint8_t level = (uint8_t)(2 + p);
-        return (level < 2) ? 2 : ((level > 3) ? 3 : level);  // Nivel 2-3 interpolado
+    // Durante la agitación, descartar muestras con el agua en movimiento
+    if (!acceptPressureSample(timestampUs)) {
+        return;
     }
+    rateCounter.pressureSamples++;
+
+    // Corrección de cero (deriva del sensor) antes de cualquier filtro
+    raw -= zeroCorrection;
+
+    // Reloj continuo a partir de micros() (que desborda cada ~71 min)
+    pressureClockUs += (uint32_t)(timestampUs - lastPressureSampleUs);
+    lastPressureSampleUs = timestampUs;
+
+    // Filtro por muestra (mediana + EMA); la ventana marca la cadencia de publicación
+    int32_t filtered = pressureFilter.add(raw);
 
-    if (pressureFloat < SensorConfig::PRESSURE_LEVEL_4) {
-        float p = (pressureFloat - SensorConfig::PRESSURE_LEVEL_3) /
-                  (SensorConfig::PRESSURE_LEVEL_4 - SensorConfig::PRESSURE_LEVEL_3);
-        uint8_t level = (uint8_t)(3 + p);
-        return (level < 3) ? 3 : ((level > 4) ? 4 : level);  // Nivel 3-4 interpolado
+    // La regresión de llenado conserva su ventana en tiempo (~10 Hz) aunque el HX710B vaya a 40 Hz
+    uint32_t clockMs = (uint32_t)(pressureClockUs / 1000);
+    if (clockMs - lastFillRateMs >= SensorConfig::FILL_RATE_MIN_INTERVAL_MS) {
+        fillRate.add(filtered, clockMs);
+        lastFillRateMs = clockMs;
     }
+    if (pressureSensor.sampler_add(raw)) {
+        publishPressure();
+    }
+}
+
+void SensorManager::publishPressure() {
+    // Ventana completa: publicar nuevo promedio (ruta entera, sin float)
+    currentPressure = PressureMath::pascalFromRaw(pressureSensor.sampler_average());
+    filteredPressure = PressureMath::pascalFromRaw(pressureFilter.value());
+    currentWaterLevel = calculateWaterLevel();
+    currentWaterLevelCenti = calibration.levelCentiFromRaw(pressureFilter.value());
+    lastPressureRead = millis();
+    rateCounter.levelUpdates++;
+
+    // Debug deshabilitado (ralentiza el sistema)
+    // Serial.printf("[SENSOR] Presion: %ld Pa → Nivel: %d\n",
+    //               currentPressure, currentWaterLevel);
+}
 
-    return 4;  // Máximo nivel
+uint8_t SensorManager::calculateWaterLevel() {
+    // Cuentas filtradas contra los umbrales enteros de la calibración activa
+    // (por defecto, los de Config.h precalculados en compilación), con banda
+    // de histéresis para bajar de nivel
+    return pressureFilter.updateLevel(levelTable);
 }
@@ -1,10 +1,33 @@
 #include "StateMachine.h"
 #include "HardwareControl.h"
 #include "SensorManager.h"
+#include "Storage.h"
 
 // Variables externas (definidas en main.cpp)
 extern HardwareControl hardware;
 extern SensorManager sensors;
+extern Storage storage;
+
+// Plan de muestreo de sensores por estado (índice = SystemState). El llenado
+// pasa a MODE_FILL_NEAR cerca del objetivo (ver selectSamplingMode()).
+static constexpr Sampling::Mode STATE_SAMPLING[] = {
+    Sampling::MODE_IDLE,         // STATE_INIT
+    Sampling::MODE_IDLE,         // STATE_WELCOME
+    Sampling::MODE_IDLE,         // STATE_SELECTION
+    Sampling::MODE_FILL,         // STATE_FILLING
+    Sampling::MODE_WASH,         // STATE_WASHING
+    Sampling::MODE_DRAIN,        // STATE_DRAINING
+    Sampling::MODE_SPIN,         // STATE_SPINNING
+    Sampling::MODE_SPIN,         // STATE_RESTING
+    Sampling::MODE_SPIN,         // STATE_COOLING
+    Sampling::MODE_IDLE,         // STATE_PAUSED
+    Sampling::MODE_IDLE,         // STATE_COMPLETED
+    Sampling::MODE_IDLE,         // STATE_ERROR
+    Sampling::MODE_IDLE,         // STATE_EMERGENCY
+    Sampling::MODE_CALIBRATION   // STATE_CALIBRATION
+};
+static_assert(sizeof(STATE_SAMPLING) / sizeof(STATE_SAMPLING[0]) == STATE_CALIBRATION + 1,
+              "STATE_SAMPLING debe cubrir todos los estados");
 
 // ========================================
 // ProgramConfig - Configuración por defecto
@@ -58,7 +81,17 @@ StateMachine::StateMachine()
       programStartTime(0),
       pauseStartTime(0),
       totalPausedTime(0),
-      pausedPhaseElapsedTime(0) {}
+      pausedPhaseElapsedTime(0),
+      fillLatencyMs(SensorConfig::FILL_LATENCY_DEFAULT_MS),
+      overshootPending(false),
+      cutoffRaw(0),
+      cutoffRate(0),
+      cutoffTime(0),
+      errorMessage("Error del sistema"),
+      fillNearTarget(false),
+      calibrationFilling(false),
+      calibrationFillStart(0),
+      calibrationStatus(nullptr) {}
 
 // ========================================
 // Inicialización
@@ -67,6 +100,8 @@ StateMachine::StateMachine()
 void StateMachine::begin() {
     // Seleccionar programa por defecto (P22)
     config.setDefaults(PROGRAM_22);
+    fillLatencyMs = FillRateEstimator::clampLatency(
+        storage.loadFillLatency(SensorConfig::FILL_LATENCY_DEFAULT_MS));
     setState(STATE_INIT);
 }
 
@@ -75,6 +110,43 @@ void StateMachine::begin() {
 // ========================================
 
 void StateMachine::update() {
+    updateFillLatency();
+
+    // Resolución del DS18B20: fina solo donde importa la temperatura del agua
+    bool temperaturePhase = currentState == STATE_FILLING || currentState == STATE_WASHING;
+    sensors.setTemperatureTarget(temperaturePhase ? config.temperature[config.currentProcess]
+                                                  : SensorManager::NO_TEMP_TARGET);
+
+    // Alarma de sobretemperatura por hardware (TH del DS18B20) durante un programa
+    bool programRunning = (currentState >= STATE_FILLING && currentState <= STATE_COOLING) ||
+                          currentState == STATE_PAUSED;
+    sensors.setAlarmTemperature(programRunning ? config.temperature[config.currentProcess]
+                                               : SensorManager::NO_TEMP_TARGET);
+    if (programRunning && sensors.hasTemperatureAlarm()) {
+        uint8_t alarms = sensors.getTemperatureAlarms();
+        for (uint8_t i = 0; i < SensorConfig::TEMP_SENSOR_COUNT; i++) {
+            if ((alarms >> i) & 1) {
+                Serial.printf("[TEMP] Alarma de sobretemperatura: %s\n", TemperatureBus::getName(i));
+            }
+        }
+        raiseError("Sobretemperatura");
+        return;
+    }
+
+    // Falla de sensor (rango, congelado, saltos o sin datos) durante un programa
+    Fault::Code fault = sensors.getFault();
+    if (programRunning && fault != Fault::NONE) {
+        Serial.printf("[SENSOR] Falla %u: %s\n", fault, Fault::describe(fault));
+        raiseError(Fault::describe(fault));
+        return;
+    }
+
+    sensors.setSamplingMode(selectSamplingMode());
+
+    // Sincronizar el muestreo de presión con la agitación del lavado
+    sensors.setAgitation(currentState == STATE_WASHING && hardware.isMotorRunning(),
+                         hardware.isMotorSettled(SensorConfig::SLOSH_SETTLE_MS));
+
     switch (currentState) {
         case STATE_INIT:        updateInit();       break;
         case STATE_WELCOME:     updateWelcome();    break;
@@ -89,6 +161,7 @@ void StateMachine::update() {
         case STATE_COMPLETED:   updateCompleted();  break;
         case STATE_ERROR:       updateError();      break;
         case STATE_EMERGENCY:   updateEmergency();  break;
+        case STATE_CALIBRATION: updateCalibration(); break;
     }
 }
 
@@ -105,6 +178,11 @@ void StateMachine::setState(SystemState newState) {
     Serial.println(currentState);
 }
 
+void StateMachine::raiseError(const char* message) {
+    errorMessage = message;
+    setState(STATE_ERROR);
+}
+
 // ========================================
 // Control de programa
 // ========================================
@@ -121,6 +199,7 @@ void StateMachine::startProgram() {
     config.currentPhase = PHASE_FILLING;
     programStartTime = millis();
     totalPausedTime = 0;
+    errorMessage = "Error del sistema";
 
     // Cerrar drenaje y bloquear puerta
     hardware.closeDrain();
@@ -181,6 +260,27 @@ void StateMachine::emergencyStop() {
     setState(STATE_EMERGENCY);
 }
 
+void StateMachine::startCalibration() {
+    if (currentState != STATE_SELECTION) return;
+
+    // Retener agua y bloquear puerta mientras se llena el tanque
+    hardware.closeDrain();
+    hardware.lockDoor();
+    calibrationFilling = false;
+    calibrationStatus = nullptr;
+    setState(STATE_CALIBRATION);
+}
+
+void StateMachine::stopCalibration() {
+    if (currentState != STATE_CALIBRATION) return;
+
+    calibrationFilling = false;
+    hardware.closeWaterValves();
+    hardware.openDrain();  // Vaciar el agua de calibración
+    hardware.unlockDoor();
+    setState(STATE_SELECTION);
+}
+
 // ========================================
 // Actualización por estado
 // ========================================
@@ -211,9 +311,11 @@ void StateMachine::updateFilling() {
         hardware.openColdWater();
     }
 
-    // Verificar si se alcanzó el nivel
-    if (sensors.hasReachedLevel(targetLevel)) {
+    // Verificar si se alcanzó el nivel, o si se alcanzará antes de que
+    // el cierre tenga efecto (corte predictivo con la latencia aprendida)
+    if (sensors.shouldStopFilling(targetLevel, fillLatencyMs)) {
         hardware.closeWaterValves();
+        startOvershootMeasurement();
         nextPhase();
     }
 }
@@ -239,6 +341,7 @@ void StateMachine::updateDraining() {
     hardware.openDrain();
 
     if (millis() - phaseStartTime >= Timing::DRAIN_TIME_SEC * 1000UL) {
+        trackPressureZero();  // Tanque vacío: referencia de cero
         nextPhase();
     }
 }
@@ -252,6 +355,7 @@ void StateMachine::updateSpinning() {
 
         if (millis() - phaseStartTime >= Timing::CENTRIFUGE_TIME_SEC * 1000UL) {
             hardware.stopCentrifuge();
+            trackPressureZero();
 
             // Verificar si es el último proceso
             if (isLastProcess()) {
@@ -312,6 +416,43 @@ void StateMachine::updateEmergency() {
     // Sistema detenido, requiere reinicio manual
 }
 
+void StateMachine::setCalibrationFill(bool on) {
+    if (currentState != STATE_CALIBRATION) return;
+
+    if (on) {
+        calibrationFillStart = millis();
+        calibrationStatus = nullptr;
+        hardware.openColdWater();
+    } else {
+        hardware.closeWaterValves();
+    }
+    calibrationFilling = on;
+}
+
+void StateMachine::updateCalibration() {
+    // La captura la maneja la UI; el llenado no depende de que el panel
+    // siga respondiendo: se corta solo
+    if (!calibrationFilling) return;
+
+    SensorSnapshot s = sensors.getSnapshot();
+    const char* reason = nullptr;
+    if (s.faultCode != Fault::NONE) {
+        reason = Fault::describe((Fault::Code)s.faultCode);
+    } else if (!s.pressureValid) {
+        reason = "Sin lectura de presion";
+    } else if (s.waterLevelCenti >= LevelCalibration::MAX_LEVEL_CENTI) {
+        reason = "Nivel maximo";
+    } else if (millis() - calibrationFillStart >= Timing::CALIBRATION_FILL_MAX_SEC * 1000UL) {
+        reason = "Tiempo de llenado agotado";
+    }
+
+    if (reason != nullptr) {
+        setCalibrationFill(false);
+        calibrationStatus = reason;
+        Serial.printf("[CAL] Llenado detenido: %s\n", reason);
+    }
+}
+
 // ========================================
 // Transiciones
 // ========================================
@@ -336,7 +477,7 @@ void StateMachine::nextPhase() {
             setState(STATE_COOLING);
             break;
         default:
-            setState(STATE_ERROR);
+            raiseError("Error del sistema");
     }
 }
 
@@ -404,9 +545,13 @@ unsigned long StateMachine::getPhaseRemainingTime() const {
             targetTime = Timing::COOLING_TIME_SEC * 1000UL;
             break;
 
-        case STATE_FILLING:
+        case STATE_FILLING: {
+            // Tiempo estimado de llenado según la velocidad medida (0 = desconocido)
+            uint32_t eta = sensors.estimateMsToLevel(config.waterLevel[config.currentProcess]);
+            return (eta == UINT32_MAX) ? 0 : eta;
+        }
+
         default:
-            // Fase de llenado no tiene tiempo definido (depende del sensor)
             return 0;
     }
 
@@ -442,6 +587,72 @@ unsigned long StateMachine::getTotalElapsedTime() const {
     return millis() - programStartTime - totalPausedTime;
 }
 
+void StateMachine::trackPressureZero() {
+    if (sensors.trackZero()) {
+        storage.saveZeroOffset(sensors.getZeroOffset());
+        Serial.printf("[SENSOR] Cero ajustado: %ld cuentas\n", (long)sensors.getZeroOffset());
+    }
+}
+
+Sampling::Mode StateMachine::selectSamplingMode() {
+    if (currentState != STATE_FILLING) {
+        fillNearTarget = false;
+        return STATE_SAMPLING[currentState];
+    }
+
+    // Cerca del nivel objetivo: presión a 40 Hz para cortar a tiempo. Con
+    // histéresis para no alternar el modo del HX710B por ruido en la ETA.
+    uint32_t eta = sensors.estimateMsToLevel(config.waterLevel[config.currentProcess]);
+    if (eta <= Sampling::FILL_NEAR_MS) {
+        fillNearTarget = true;
+    } else if (eta > 2 * Sampling::FILL_NEAR_MS) {
+        fillNearTarget = false;
+    }
+    return fillNearTarget ? Sampling::MODE_FILL_NEAR : Sampling::MODE_FILL;
+}
+
+void StateMachine::startOvershootMeasurement() {
+    SensorSnapshot s = sensors.getSnapshot();  // Cuentas y pendiente del mismo ciclo
+    cutoffRaw = s.filteredRaw;
+    cutoffRate = s.fillRate;
+    cutoffTime = millis();
+    overshootPending = true;
+}
+
+void StateMachine::updateFillLatency() {
+    if (!overshootPending || millis() - cutoffTime < SensorConfig::FILL_SETTLE_MS) {
+        return;
+    }
+
+    // Solo medir si el lavado siguió normalmente (sin pausa ni parada) y
+    // la velocidad al cortar era confiable
+    if (currentState != STATE_WASHING || cutoffRate < SensorConfig::FILL_MIN_RATE) {
+        overshootPending = false;
+        return;
+    }
+
+    // Con el tambor girando el agua se mueve: esperar el final de una pausa
+    if (hardware.isMotorRunning() && !hardware.isMotorSettled(SensorConfig::SLOSH_SETTLE_MS)) {
+        if (millis() - cutoffTime >= SensorConfig::FILL_MEASURE_WINDOW_MS) {
+            overshootPending = false;
+        }
+        return;
+    }
+    overshootPending = false;
+
+    // Agua que siguió entrando tras el cierre, expresada como tiempo de llenado
+    int32_t overshoot = sensors.getFilteredRaw() - cutoffRaw;
+    if (overshoot < 0) overshoot = 0;
+    uint32_t measuredMs = FillRateEstimator::clampLatency(((int64_t)overshoot * 1000) / cutoffRate);
+
+    // Promedio con la latencia anterior para no reaccionar a un llenado aislado
+    fillLatencyMs = FillRateEstimator::clampLatency((fillLatencyMs + measuredMs) / 2);
+    storage.saveFillLatency(fillLatencyMs);
+
+    Serial.printf("[FILL] Sobrepaso %ld cuentas -> latencia %lu ms (nueva: %u ms)\n",
+                  (long)overshoot, (unsigned long)measuredMs, fillLatencyMs);
+}
+
 void StateMachine::resetTimers() {
     programStartTime = millis();
     phaseStartTime = millis();
@@ -3,6 +3,12 @@
 namespace StorageConfig {
     constexpr const char* NAMESPACE = "washer";
     constexpr const char* KEY_INITIALIZED = "init";
+    constexpr const char* KEY_CAL_COUNT = "cal_n";
+    constexpr const char* KEY_CAL_POINTS = "cal_pts";
+    constexpr const char* KEY_FILL_LATENCY = "fill_lat";
+    constexpr const char* KEY_ZERO_OFFSET = "zero_off";
+    constexpr const char* KEY_TEMP_ROMS = "temp_roms";
+    constexpr const char* KEY_NEXTION_BAUD = "nx_baud";
 }
 
 Storage::Storage() {
@@ -111,6 +117,107 @@ bool Storage::saveProcess(uint8_t programNumber, uint8_t processIndex, const Pro
     return true;
 }
 
+bool Storage::saveCalibration(const LevelCalibration& calibration) {
+    if (!calibration.isValid()) {
+        return false;
+    }
+
+    preferences.begin(StorageConfig::NAMESPACE, false);
+    size_t len = calibration.size() * sizeof(CalibrationPoint);
+    bool ok = preferences.putBytes(StorageConfig::KEY_CAL_POINTS, calibration.data(), len) == len;
+    if (ok) {
+        preferences.putUChar(StorageConfig::KEY_CAL_COUNT, calibration.size());
+    }
+    preferences.end();
+    return ok;
+}
+
+bool Storage::loadCalibration(LevelCalibration& calibration) {
+    preferences.begin(StorageConfig::NAMESPACE, true);
+
+    if (!preferences.isKey(StorageConfig::KEY_CAL_COUNT)) {
+        preferences.end();
+        return false;
+    }
+
+    uint8_t count = preferences.getUChar(StorageConfig::KEY_CAL_COUNT, 0);
+    CalibrationPoint points[LevelCalibration::MAX_POINTS];
+    size_t len = count * sizeof(CalibrationPoint);
+    bool ok = count <= LevelCalibration::MAX_POINTS &&
+              preferences.getBytes(StorageConfig::KEY_CAL_POINTS, points, sizeof(points)) == len;
+    preferences.end();
+
+    // load() valida monotonía: una tabla corrupta no reemplaza la actual
+    return ok && calibration.load(points, count);
+}
+
+void Storage::clearCalibration() {
+    preferences.begin(StorageConfig::NAMESPACE, false);
+    preferences.remove(StorageConfig::KEY_CAL_COUNT);
+    preferences.remove(StorageConfig::KEY_CAL_POINTS);
+    preferences.end();
+}
+
+bool Storage::saveFillLatency(uint16_t latencyMs) {
+    preferences.begin(StorageConfig::NAMESPACE, false);
+    bool ok = preferences.putUShort(StorageConfig::KEY_FILL_LATENCY, latencyMs) == sizeof(uint16_t);
+    preferences.end();
+    return ok;
+}
+
+uint16_t Storage::loadFillLatency(uint16_t defaultMs) {
+    preferences.begin(StorageConfig::NAMESPACE, true);
+    uint16_t latencyMs = preferences.getUShort(StorageConfig::KEY_FILL_LATENCY, defaultMs);
+    preferences.end();
+    return latencyMs;
+}
+
+bool Storage::saveZeroOffset(int32_t offset) {
+    preferences.begin(StorageConfig::NAMESPACE, false);
+    bool ok = preferences.putInt(StorageConfig::KEY_ZERO_OFFSET, offset) == sizeof(int32_t);
+    preferences.end();
+    return ok;
+}
+
+int32_t Storage::loadZeroOffset() {
+    preferences.begin(StorageConfig::NAMESPACE, true);
+    int32_t offset = preferences.getInt(StorageConfig::KEY_ZERO_OFFSET, 0);
+    preferences.end();
+    return offset;
+}
+
+bool Storage::saveNextionBaud(uint32_t baud) {
+    preferences.begin(StorageConfig::NAMESPACE, false);
+    bool ok = preferences.putUInt(StorageConfig::KEY_NEXTION_BAUD, baud) == sizeof(uint32_t);
+    preferences.end();
+    return ok;
+}
+
+uint32_t Storage::loadNextionBaud() {
+    preferences.begin(StorageConfig::NAMESPACE, true);
+    uint32_t baud = preferences.getUInt(StorageConfig::KEY_NEXTION_BAUD, 0);
+    preferences.end();
+    return baud;
+}
+
+bool Storage::saveTempAddresses(const uint8_t addresses[][8], uint8_t count) {
+    preferences.begin(StorageConfig::NAMESPACE, false);
+    size_t len = count * 8;
+    bool ok = preferences.putBytes(StorageConfig::KEY_TEMP_ROMS, addresses, len) == len;
+    preferences.end();
+    return ok;
+}
+
+bool Storage::loadTempAddresses(uint8_t addresses[][8], uint8_t count) {
+    preferences.begin(StorageConfig::NAMESPACE, true);
+    size_t len = count * 8;
+    bool ok = preferences.isKey(StorageConfig::KEY_TEMP_ROMS) &&
+              preferences.getBytesLength(StorageConfig::KEY_TEMP_ROMS) == len &&
+              preferences.getBytes(StorageConfig::KEY_TEMP_ROMS, addresses, len) == len;
+    preferences.end();
+    return ok;
+}
+
 void Storage::restoreDefaults() {
     ProgramConfig config;
 
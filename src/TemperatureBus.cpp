@@ -0,0 +1,421 @@
+#include "TemperatureBus.h"
+
+TemperatureBus::TemperatureBus(OneWireBus& wire)
+    : wire(wire),
+      reader(wire, SensorConfig::TEMP_RESOLUTION, SensorConfig::TEMP_VERIFY_CRC),
+      targetResolution(SensorConfig::TEMP_RESOLUTION),
+      configPending(false),
+      nextWrite(0),
+      alarmSearchDone(false),
+      alarmFlags(0),
+      alarmMask(0),
+      spareCount(0),
+      identifyState(IDENTIFY_IDLE),
+      identifyIndex(0),
+      identifyStartMs(0),
+      assignmentVersion(0),
+      nextRead(0),
+      lastRoundMs(0),
+      roundIntervalMs(Timing::SENSOR_READ_INTERVAL_MS),
+      rounds(0),
+      currentRound{0, 0},
+      lastRound{0, 0},
+      txStartUs(0),
+      txStartBlockedUs(0) {
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        clearAddress(i);
+        alarmHigh[i] = 75;  // Valores de fábrica del DS18B20
+        alarmLow[i] = 70;
+    }
+}
+
+// ========================================
+// Asignación de direcciones
+// ========================================
+
+void TemperatureBus::setAddress(uint8_t index, const uint8_t* rom) {
+    if (index >= MAX_SENSORS) return;
+    memcpy(addresses[index], rom, 8);
+    assigned[index] = true;
+    missing[index] = false;
+    valid[index] = false;
+    temperatures[index] = 0.0;
+    memset(&stats[index], 0, sizeof(SensorStats));
+}
+
+void TemperatureBus::clearAddress(uint8_t index) {
+    if (index >= MAX_SENSORS) return;
+    memset(addresses[index], 0, 8);
+    assigned[index] = false;
+    missing[index] = false;
+    valid[index] = false;
+    temperatures[index] = 0.0;
+    memset(&stats[index], 0, sizeof(SensorStats));
+}
+
+uint8_t TemperatureBus::getSensorCount() const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        if (assigned[i]) count++;
+    }
+    return count;
+}
+
+uint8_t TemperatureBus::getMissingMask() const {
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        if (missing[i]) mask |= 1 << i;
+    }
+    return mask;
+}
+
+int8_t TemperatureBus::findAssigned(const uint8_t* rom) const {
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        if (assigned[i] && memcmp(addresses[i], rom, 8) == 0) return i;
+    }
+    return -1;
+}
+
+bool TemperatureBus::verify() {
+    if (getSensorCount() == 0) return false;
+
+    // Una lectura del scratchpad con CRC por sensor (sin búsqueda ROM)
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        if (!assigned[i]) continue;
+        int16_t raw;
+        if (reader.readTemperature(addresses[i], raw) != Ds18b20Reader::READ_OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TemperatureBus::discover() {
+    Address found[MAX_SPARES];
+    uint8_t foundCount = 0;
+    uint8_t rom[8];
+
+    wire.reset_search();
+    while (foundCount < MAX_SPARES && wire.search(rom)) {
+        if (OneWireBus::crc8(rom, 7) != rom[7] || rom[0] != DS18B20_FAMILY) {
+            continue;  // ROM corrupta u otro tipo de dispositivo
+        }
+        memcpy(found[foundCount++], rom, 8);
+    }
+
+    // Puestos cuya sonda no respondió: se conservan (sin guardar nada)
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        if (!assigned[i]) continue;
+        bool present = false;
+        for (uint8_t f = 0; f < foundCount && !present; f++) {
+            present = memcmp(addresses[i], found[f], 8) == 0;
+        }
+        missing[i] = !present;
+    }
+
+    // ROM sin puesto: esperan a startIdentify()
+    spareCount = 0;
+    for (uint8_t f = 0; f < foundCount; f++) {
+        if (findAssigned(found[f]) < 0) memcpy(spares[spareCount++], found[f], 8);
+    }
+
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        Serial.printf("[TEMP] %-8s ", getName(i));
+        if (assigned[i]) printAddress(addresses[i]);
+        else Serial.print("(sin sensor)");
+        if (missing[i]) Serial.print(" AUSENTE");
+        Serial.println();
+    }
+    for (uint8_t s = 0; s < spareCount; s++) {
+        Serial.print("[TEMP] libre    ");
+        printAddress(spares[s]);
+        Serial.println();
+    }
+}
+
+// ========================================
+// Identificación por calentamiento
+// ========================================
+
+bool TemperatureBus::startIdentify(uint8_t index, unsigned long nowMs) {
+    if (index >= MAX_SENSORS) return false;
+
+    // Búsqueda nueva: la sonda pudo conectarse después del arranque
+    discover();
+    if (spareCount == 0) {
+        identifyState = IDENTIFY_FAILED;
+        return false;
+    }
+    for (uint8_t s = 0; s < spareCount; s++) spareMin[s] = NAN;
+    identifyIndex = index;
+    identifyStartMs = nowMs;
+    identifyState = IDENTIFY_WAITING;
+    Serial.printf("[TEMP] Identificando '%s': calentar la sonda (%d libres)\n",
+                  getName(index), spareCount);
+    return true;
+}
+
+void TemperatureBus::cancelIdentify() {
+    if (identifyState == IDENTIFY_WAITING) identifyState = IDENTIFY_IDLE;
+}
+
+void TemperatureBus::updateIdentify(unsigned long nowMs) {
+    // Al cierre de cada ronda: la conversión broadcast incluyó a las libres
+    int8_t warmed = -1;
+    uint8_t warmedCount = 0;
+    for (uint8_t s = 0; s < spareCount; s++) {
+        int16_t raw;
+        if (reader.readTemperature(spares[s], raw) != Ds18b20Reader::READ_OK) continue;
+        float temp = Ds18b20Reader::toCelsius(raw);
+        if (isnan(spareMin[s]) || temp < spareMin[s]) spareMin[s] = temp;
+        if (temp - spareMin[s] >= SensorConfig::TEMP_IDENTIFY_RISE_C) {
+            warmed = s;
+            warmedCount++;
+        }
+    }
+
+    // Solo una sonda caliente: con dos no se sabe cuál es
+    if (warmedCount == 1) {
+        assignSpare(warmed);
+        identifyState = IDENTIFY_DONE;
+    } else if (nowMs - identifyStartMs >= SensorConfig::TEMP_IDENTIFY_TIMEOUT_MS) {
+        Serial.printf("[TEMP] Identificación de '%s' sin resultado\n", getName(identifyIndex));
+        identifyState = IDENTIFY_FAILED;
+    }
+}
+
+void TemperatureBus::assignSpare(uint8_t spare) {
+    Address rom;
+    memcpy(rom, spares[spare], 8);
+
+    // La sonda anterior del puesto, si sigue en el bus, pasa a libre
+    if (assigned[identifyIndex] && !missing[identifyIndex]) {
+        memcpy(spares[spare], addresses[identifyIndex], 8);
+    } else {
+        memmove(spares[spare], spares[spare + 1], (spareCount - spare - 1) * sizeof(Address));
+        spareCount--;
+    }
+
+    setAddress(identifyIndex, rom);
+    assignmentVersion++;
+    Serial.printf("[TEMP] %-8s ", getName(identifyIndex));
+    printAddress(rom);
+    Serial.println(" (asignada)");
+
+    // TH/TL y resolución de la sonda nueva, entre rondas
+    configPending = true;
+    nextWrite = 0;
+}
+
+void TemperatureBus::applyResolution() {
+    // Se lee antes de escribir: tras un reinicio en caliente ya la tienen
+    uint8_t written = 0;
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        if (assigned[i] && reader.updateConfig(addresses[i], alarmHigh[i], alarmLow[i],
+                                               reader.getResolution())) {
+            written++;
+        }
+    }
+    log_d("[TEMP] Configuración escrita en %d de %d sensores", written, getSensorCount());
+    targetResolution = reader.getResolution();
+    configPending = false;
+}
+
+void TemperatureBus::requestResolution(uint8_t bits) {
+    bits = constrain(bits, 9, 12);
+    if (bits == targetResolution) return;
+    targetResolution = bits;
+    configPending = true;
+    nextWrite = 0;
+}
+
+void TemperatureBus::setAlarmLimits(uint8_t index, int8_t high, int8_t low) {
+    if (index >= MAX_SENSORS) return;
+    if (alarmHigh[index] == high && alarmLow[index] == low) return;
+    alarmHigh[index] = high;
+    alarmLow[index] = low;
+    configPending = true;
+    nextWrite = 0;
+}
+
+bool TemperatureBus::writePendingConfig() {
+    // Una escritura de scratchpad por llamada; true mientras quede trabajo
+    while (nextWrite < MAX_SENSORS && !assigned[nextWrite]) nextWrite++;
+    if (nextWrite < MAX_SENSORS) {
+        beginTransaction();
+        reader.writeConfig(addresses[nextWrite], alarmHigh[nextWrite], alarmLow[nextWrite],
+                           targetResolution);
+        endTransaction();
+        nextWrite++;
+        return true;
+    }
+
+    // Todos los sensores reconfigurados: el plazo de conversión cambia recién ahora
+    if (targetResolution != reader.getResolution()) {
+        reader.setResolution(targetResolution);
+        log_d("[TEMP] Resolución: %d bits", targetResolution);
+    }
+    configPending = false;
+    return false;
+}
+
+// ========================================
+// Rondas de lectura
+// ========================================
+
+void TemperatureBus::beginTransaction() {
+    txStartUs = micros();
+    txStartBlockedUs = oneWireBlockedUs(wire);
+}
+
+void TemperatureBus::endTransaction() {
+    uint32_t elapsed = micros() - txStartUs;
+    uint32_t blocked = oneWireBlockedUs(wire) - txStartBlockedUs;
+    currentRound.busUs += elapsed;
+    currentRound.cpuUs += (blocked < elapsed) ? elapsed - blocked : 0;
+}
+
+void TemperatureBus::update(unsigned long nowMs) {
+    if (getSensorCount() == 0 && identifyState != IDENTIFY_WAITING) return;
+
+    if (!reader.isConverting()) {
+        // Entre rondas: aplicar un cambio de resolución o de límites pendiente
+        if (configPending && writePendingConfig()) return;
+
+        // Nueva ronda: una sola conversión para todos los sensores
+        if (nowMs - lastRoundMs < roundIntervalMs) return;
+
+        currentRound = {0, 0};
+        beginTransaction();
+        bool started = reader.startConversion(nowMs);
+        endTransaction();
+
+        if (!started) {
+            // Sin presencia en el bus: reintentar en el próximo intervalo
+            for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+                if (assigned[i]) recordError(i);
+            }
+            lastRoundMs = nowMs;
+            rounds++;
+            return;
+        }
+        nextRead = 0;
+        alarmSearchDone = false;
+        return;
+    }
+
+    // Sin tocar el bus hasta que venza el plazo de conversión
+    if (!reader.conversionDue(nowMs)) return;
+
+    // Primero la búsqueda de alarmas (los flags se actualizan al convertir)
+    if (!alarmSearchDone) {
+        searchAlarms();
+        alarmSearchDone = true;
+        return;
+    }
+
+    // Un sensor por llamada, solo los que hace falta leer
+    while (nextRead < MAX_SENSORS && !needsRead(nextRead)) nextRead++;
+    if (nextRead < MAX_SENSORS) {
+        readSensor(nextRead++, nowMs);
+    }
+    while (nextRead < MAX_SENSORS && !needsRead(nextRead)) nextRead++;
+
+    if (nextRead >= MAX_SENSORS) {
+        reader.cancel();
+        lastRoundMs = nowMs;
+        rounds++;
+        lastRound = currentRound;
+        if (identifyState == IDENTIFY_WAITING) updateIdentify(nowMs);
+        log_d("[TEMP] Ronda %lu: %lu us de bus, %lu us de CPU", (unsigned long)rounds,
+              (unsigned long)lastRound.busUs, (unsigned long)lastRound.cpuUs);
+    }
+}
+
+void TemperatureBus::cancel() {
+    reader.cancel();
+    nextRead = 0;
+    alarmSearchDone = false;
+    alarmFlags = 0;
+    alarmMask = 0;  // Sin rondas no hay dato: no arrastrar alarmas viejas
+}
+
+void TemperatureBus::searchAlarms() {
+    // Búsqueda condicional: sin sensores en alarma es un reset, el comando y
+    // dos slots de lectura (~1 ms con bit-banging); cada sensor en alarma
+    // agrega una pasada de 64 bits
+    uint8_t flags = 0;
+    uint8_t rom[8];
+
+    beginTransaction();
+    wire.reset_search();
+    for (uint8_t found = 0; found < MAX_SENSORS * 2 && wire.search(rom, false); found++) {
+        if (OneWireBus::crc8(rom, 7) != rom[7]) continue;
+        int8_t index = findAssigned(rom);
+        if (index >= 0) flags |= 1 << index;
+    }
+    endTransaction();
+
+    alarmFlags = flags;
+    alarmMask &= flags;  // Un sensor que dejó de alarmar no necesita lectura
+}
+
+bool TemperatureBus::needsRead(uint8_t index) const {
+    if (!assigned[index]) return false;
+    if (index == SensorConfig::TEMP_DRUM) return true;     // Control del programa
+    if ((alarmFlags >> index) & 1) return true;             // Confirmar la alarma
+    return rounds % SensorConfig::TEMP_SLOW_READ_ROUNDS == 0;  // Lectura de control
+}
+
+void TemperatureBus::readSensor(uint8_t index, unsigned long nowMs) {
+    int16_t raw = 0;
+    uint32_t startUs = micros();
+    beginTransaction();
+    Ds18b20Reader::ReadResult result = reader.readTemperature(addresses[index], raw);
+    endTransaction();
+    uint32_t elapsedUs = micros() - startUs;
+
+    SensorStats& s = stats[index];
+    s.readUs = (elapsedUs > UINT16_MAX) ? UINT16_MAX : elapsedUs;
+    if (s.readUs > s.maxReadUs) s.maxReadUs = s.readUs;
+
+    float temp = Ds18b20Reader::toCelsius(raw);
+    bool flagged = (alarmFlags >> index) & 1;
+    if (result != Ds18b20Reader::READ_OK || temp < -55 || temp > 125) {
+        // Marcado por la búsqueda pero ilegible: se toma como alarma (lado seguro)
+        if (flagged) alarmMask |= 1 << index;
+        recordError(index);
+        return;
+    }
+
+    // Confirmar con la misma comparación que hizo el sensor
+    bool outOfRange = Ds18b20Reader::isAlarm(raw, alarmHigh[index], alarmLow[index]);
+    if (flagged && outOfRange) alarmMask |= 1 << index;
+    else alarmMask &= ~(1 << index);
+
+    temperatures[index] = temp;
+    valid[index] = true;
+    missing[index] = false;  // Respondió: conector flojo que volvió
+    s.reads++;
+    s.consecutiveErrors = 0;
+    s.latencyMs = nowMs - reader.getConversionStartMs();
+    s.lastOkMs = nowMs;
+}
+
+void TemperatureBus::recordError(uint8_t index) {
+    SensorStats& s = stats[index];
+    s.errors++;
+    if (s.consecutiveErrors < UINT8_MAX) s.consecutiveErrors++;
+    valid[index] = false;
+}
+
+void TemperatureBus::printAddress(const uint8_t* rom) {
+    Serial.print("{");
+    for (int i = 0; i < 8; i++) {
+        Serial.print("0x");
+        if (rom[i] < 16) Serial.print("0");
+        Serial.print(rom[i], HEX);
+        if (i < 7) Serial.print(", ");
+    }
+    Serial.print("}");
+}
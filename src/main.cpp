@@ -4,6 +4,7 @@
 #include "HardwareControl.h"
 #include "SensorManager.h"
 #include "NextionUI.h"
+#include "NextionPrefixes.h"
 #include "Storage.h"
 
 // ========================================
@@ -42,6 +43,24 @@ struct EditState {
     ProgramConfig backupConfig;  // Backup para cancelar
 } editState;
 
+// ========================================
+// VARIABLES DE CALIBRACIÓN
+// ========================================
+
+struct CalibrationState {
+    LevelCalibration points;     // Puntos capturados en esta sesión
+    uint16_t referenceCenti;     // Nivel de referencia del próximo punto (x100)
+    bool identifying;            // Esperando que el operador caliente la sonda
+    uint32_t identifyStartUs;    // Instantáneas anteriores no cuentan
+    uint8_t tempAssignments;     // Última asignación de sondas guardada
+} calState;
+
+// ========================================
+// PREFIJOS DE COMANDOS NEXTION (NextionPrefixes.h)
+// ========================================
+
+using namespace NextionPrefix;
+
 // ========================================
 // FUNCIONES DE SELECCIÓN
 // ========================================
@@ -58,16 +77,14 @@ void updateProgramButtons(uint8_t selectedProgram) {
 
     // Actualizar cada botón
     for (int i = 0; i < 3; i++) {
-        char btnName[16];
-        snprintf(btnName, sizeof(btnName), "btnPrograma%d", i + 1);
-
         if (programNumbers[i] == selectedProgram) {
             // Botón seleccionado: color activo
-            nextion.setBackgroundColor(btnName, NextionConfig::COLOR_ACTIVE);
+            nextion.beginValue().prefix(BCO_PROGRAMA[i]).number(NextionConfig::COLOR_ACTIVE);
         } else {
             // Botón no seleccionado: color inactivo
-            nextion.setBackgroundColor(btnName, NextionConfig::COLOR_INACTIVE);
+            nextion.beginValue().prefix(BCO_PROGRAMA[i]).number(NextionConfig::COLOR_INACTIVE);
         }
+        nextion.endValue();
     }
 }
 
@@ -89,23 +106,27 @@ void updateEditDisplay() {
     ProgramConfig& config = stateMachine.getConfig();
     uint8_t tanda = editState.currentTanda;
 
+    // Toda la página en una trama: el panel redibuja una sola vez
+    nextion.beginFrame();
+
     // Actualizar número de programa en edición
-    char buffer[32];
-        snprintf(buffer, sizeof(buffer), "P%d", config.programNumber);
-    nextion.setText("progr_sel", buffer);
+    nextion.beginValue().prefix(TXT_PROGR_SEL).put('P').number(config.programNumber).quote();
+    nextion.endValue();
 
     // Actualizar valores del panel derecho
-    snprintf(buffer, sizeof(buffer), "%d", config.waterLevel[tanda]);
-    nextion.setText("val_nivel", buffer);
+    nextion.beginValue().prefix(TXT_VAL_NIVEL).number(config.waterLevel[tanda]).quote();
+    nextion.endValue();
 
-    snprintf(buffer, sizeof(buffer), "%d", config.temperature[tanda]);
-    nextion.setText("val_temp", buffer);
+    nextion.beginValue().prefix(TXT_VAL_TEMP).number(config.temperature[tanda]).quote();
+    nextion.endValue();
 
-    snprintf(buffer, sizeof(buffer), "%d", config.time[tanda]);
-    nextion.setText("val_tiempo", buffer);
+    nextion.beginValue().prefix(TXT_VAL_TIEMPO).number(config.time[tanda]).quote();
+    nextion.endValue();
 
-    nextion.setText("val_centrif", config.centrifugeEnabled[tanda] ? "Si" : "No");
-    nextion.setText("val_agua", config.waterType[tanda] == WATER_HOT ? "Caliente" : "Fria");
+    nextion.beginValue().prefix(TXT_VAL_CENTRIF).text(config.centrifugeEnabled[tanda] ? "Si" : "No").quote();
+    nextion.endValue();
+    nextion.beginValue().prefix(TXT_VAL_AGUA).text(config.waterType[tanda] == WATER_HOT ? "Caliente" : "Fria").quote();
+    nextion.endValue();
 
     // Deshabilitar botón de tipo de agua para P22 (caliente fijo) y P23 (fría fija)
     if (config.programNumber == PROGRAM_22 || config.programNumber == PROGRAM_23) {
@@ -127,57 +148,59 @@ void updateEditDisplay() {
     };
 
     for (int i = 0; i < 4; i++) {
-        char tandaName[16];
-        snprintf(tandaName, sizeof(tandaName), "tanda%d", i + 1);
+        uint16_t color;
+        uint8_t value;
 
         if (i < totalTandas) {
             // Tanda disponible: habilitar con tsw
             nextion.setEnabledById(tandaIds[i], true);
 
-            // Cambiar color según si está seleccionada o no
-            if (i == tanda) {
-                nextion.setBackgroundColor(tandaName, NextionConfig::COLOR_ACTIVE);
-                nextion.setNumber(tandaName, 1);  // Valor seleccionado
-            } else {
-                nextion.setBackgroundColor(tandaName, NextionConfig::COLOR_INACTIVE);
-                nextion.setNumber(tandaName, 0);  // Valor no seleccionado
-            }
+            // Cambiar color y valor según si está seleccionada o no
+            color = (i == tanda) ? NextionConfig::COLOR_ACTIVE : NextionConfig::COLOR_INACTIVE;
+            value = (i == tanda) ? 1 : 0;
         } else {
             // Tanda no disponible: deshabilitar con tsw y color deshabilitado
             nextion.setEnabledById(tandaIds[i], false);
-            nextion.setBackgroundColor(tandaName, NextionConfig::COLOR_DISABLED);
-            nextion.setNumber(tandaName, 0);
+            color = NextionConfig::COLOR_DISABLED;
+            value = 0;
         }
+
+        nextion.beginValue().prefix(BCO_TANDA[i]).number(color);
+        nextion.endValue();
+        nextion.beginValue().prefix(VAL_TANDA[i]).number(value);
+        nextion.endValue();
     }
 
     // Mostrar parámetro actual en edición
     const char* paramName = "";
-    char paramValue[32] = "";
+    char paramValue[32];
+    NextionFormat::Writer value(paramValue, sizeof(paramValue));
 
     switch (editState.currentParam) {
         case PARAM_NIVEL:
             paramName = "Nivel de Agua";
-            snprintf(paramValue, sizeof(paramValue), "%d", config.waterLevel[tanda]);
+            value.number(config.waterLevel[tanda]);
             break;
         case PARAM_TEMP:
             paramName = "Temperatura";
-            snprintf(paramValue, sizeof(paramValue), "%d°C", config.temperature[tanda]);
+            value.number(config.temperature[tanda]).text("°C");
             break;
         case PARAM_TIEMPO:
             paramName = "Tiempo";
-            snprintf(paramValue, sizeof(paramValue), "%d min", config.time[tanda]);
+            value.number(config.time[tanda]).text(" min");
             break;
         case PARAM_CENTRIF:
             paramName = "Centrifugado";
-            snprintf(paramValue, sizeof(paramValue), "%s", config.centrifugeEnabled[tanda] ? "Si" : "No");
+            value.text(config.centrifugeEnabled[tanda] ? "Si" : "No");
             break;
         case PARAM_AGUA:
             paramName = "Tipo de Agua";
-            snprintf(paramValue, sizeof(paramValue), "%s", config.waterType[tanda] == WATER_HOT ? "Caliente" : "Fria");
+            value.text(config.waterType[tanda] == WATER_HOT ? "Caliente" : "Fria");
             break;
     }
 
-    nextion.updateEditDisplay(tanda, paramName, paramValue);
+    nextion.updateEditDisplay(tanda, paramName, value.c_str());
+    nextion.endFrame();
 }
 
 void incrementCurrentParameter() {
@@ -280,6 +303,144 @@ void prevParameter() {
     updateEditDisplay();
 }
 
+// ========================================
+// FUNCIONES DE CALIBRACIÓN
+// ========================================
+
+void enterCalibrationMode() {
+    // Primer punto esperado: tanque vacío (nivel 0)
+    calState.points.clear();
+    calState.referenceCenti = 0;
+    calState.identifying = false;
+    calState.tempAssignments = sensors.getSnapshot().assignmentVersion;
+
+    stateMachine.startCalibration();
+    sensors.startMonitoring();  // Necesario para leer presión durante la captura
+}
+
+void exitCalibrationMode() {
+    if (calState.identifying) {
+        sensors.cancelTemperatureIdentify();
+        calState.identifying = false;
+    }
+    stateMachine.stopCalibration();
+    sensors.stopMonitoring();
+}
+
+void updateCalibrationDisplay() {
+    SensorSnapshot s = sensors.getSnapshot();
+    nextion.updateCalibrationDisplay(
+        calState.referenceCenti,
+        s.waterLevelCenti,
+        s.filteredPa,
+        calState.points.size(),
+        stateMachine.isCalibrationFilling(),
+        stateMachine.getCalibrationStatus()
+    );
+}
+
+// Resultado de la identificación de la sonda del tambor: la asignación nueva
+// se guarda una sola vez
+void checkTemperatureIdentify() {
+    SensorSnapshot s = sensors.getSnapshot();
+    if (s.assignmentVersion != calState.tempAssignments) {
+        calState.tempAssignments = s.assignmentVersion;
+        TemperatureBus::Address addresses[SensorConfig::TEMP_SENSOR_COUNT];
+        sensors.copyTemperatureAddresses(addresses);
+        if (storage.saveTempAddresses(addresses, SensorConfig::TEMP_SENSOR_COUNT)) {
+            stateMachine.setCalibrationStatus("Sonda asignada");
+        } else {
+            stateMachine.setCalibrationStatus("Error al guardar");
+            Serial.println("[CAL] ERROR: No se pudo guardar la asignación de sondas");
+        }
+    }
+
+    if (!calState.identifying || (int32_t)(s.timestampUs - calState.identifyStartUs) <= 0 ||
+        s.identifyState == TemperatureBus::IDENTIFY_WAITING) {
+        return;
+    }
+    calState.identifying = false;
+    if (s.identifyState == TemperatureBus::IDENTIFY_FAILED) {
+        stateMachine.setCalibrationStatus("Sonda no detectada");
+    }
+}
+
+void handleCalibrationButton(uint8_t componentId) {
+    switch (componentId) {
+        case NextionConfig::BTN_CAL_MINUS:
+            if (calState.referenceCenti >= NextionConfig::CAL_STEP_CENTI)
+                calState.referenceCenti -= NextionConfig::CAL_STEP_CENTI;
+            break;
+
+        case NextionConfig::BTN_CAL_PLUS:
+            if (calState.referenceCenti + NextionConfig::CAL_STEP_CENTI <= LevelCalibration::MAX_LEVEL_CENTI)
+                calState.referenceCenti += NextionConfig::CAL_STEP_CENTI;
+            break;
+
+        case NextionConfig::BTN_CAL_CAPTURE: {
+            // Asociar la presión filtrada actual con el nivel de referencia,
+            // solo con el filtro ya asentado
+            SensorSnapshot s = sensors.getSnapshot();
+            if (!s.pressurePrimed) {
+                stateMachine.setCalibrationStatus("Esperando presion");
+                Serial.println("[CAL] Punto rechazado (filtro de presión sin asentar)");
+                break;
+            }
+            if (calState.points.addPoint(s.filteredRaw, calState.referenceCenti)) {
+                Serial.printf("[CAL] Punto %d: raw=%ld nivel=%u\n", calState.points.size(),
+                              (long)s.filteredRaw, calState.referenceCenti);
+                stateMachine.setCalibrationStatus("Punto capturado");
+                if (calState.referenceCenti + NextionConfig::CAL_STEP_CENTI <= LevelCalibration::MAX_LEVEL_CENTI)
+                    calState.referenceCenti += NextionConfig::CAL_STEP_CENTI;
+            } else {
+                stateMachine.setCalibrationStatus("Punto rechazado");
+                Serial.println("[CAL] Punto rechazado (tabla llena o no monótono)");
+            }
+            break;
+        }
+
+        case NextionConfig::BTN_CAL_FILL:
+            stateMachine.setCalibrationFill(!stateMachine.isCalibrationFilling());
+            break;
+
+        case NextionConfig::BTN_CAL_CLEAR:
+            // Descartar calibración guardada y volver a los umbrales de Config.h
+            calState.points.clear();
+            calState.referenceCenti = 0;
+            storage.clearCalibration();
+            sensors.setCalibration(LevelCalibration::fromConfig());
+            break;
+
+        case NextionConfig::BTN_CAL_SAVE:
+            if (!sensors.setCalibration(calState.points)) {
+                stateMachine.setCalibrationStatus("Faltan puntos");
+                Serial.println("[CAL] Calibración inválida: se necesitan al menos 2 puntos");
+            } else if (!storage.saveCalibration(calState.points)) {
+                // Vigente hasta reiniciar, pero no quedó en memoria
+                stateMachine.setCalibrationStatus("Error al guardar");
+                Serial.println("[CAL] ERROR: No se pudo guardar la calibración");
+            } else {
+                stateMachine.setCalibrationStatus("Guardado");
+                Serial.printf("[CAL] Calibración guardada (%d puntos)\n", calState.points.size());
+            }
+            break;
+
+        case NextionConfig::BTN_CAL_TEMP:
+            // El operador calienta con la mano la sonda que va en el tambor
+            calState.identifyStartUs = micros();
+            calState.identifying = sensors.identifyTemperatureSensor(SensorConfig::TEMP_DRUM);
+            stateMachine.setCalibrationStatus(calState.identifying ? "Calentar sonda tambor"
+                                                                   : "Sin sondas libres");
+            break;
+
+        case NextionConfig::BTN_CAL_EXIT:
+            exitCalibrationMode();
+            return;  // updateUI() cambia a la página de selección
+    }
+
+    updateCalibrationDisplay();
+}
+
 // ========================================
 // CALLBACK DE EVENTOS NEXTION
 // ========================================
@@ -334,9 +495,18 @@ void handleNextionEvent(uint8_t pageId, uint8_t componentId, uint8_t eventType)
                 nextion.showEdit();
                 updateEditDisplay();
                 break;
+
+            case NextionConfig::BTN_CALIBRATE:
+                enterCalibrationMode();
+                break;
         }
     }
 
+    // Página de calibración
+    else if (pageId == NextionConfig::PAGE_CALIBRATION) {
+        handleCalibrationButton(componentId);
+    }
+
     // Página de ejecución
     else if (pageId == NextionConfig::PAGE_EXECUTION) {
         switch (componentId) {
@@ -560,7 +730,7 @@ void updateUI() {
 
             case STATE_ERROR:
                 sensors.stopMonitoring();  // DESACTIVAR sensores en error
-                nextion.showError("Error del sistema");
+                nextion.showError(stateMachine.getErrorMessage());
                 // Serial.println("UI: Mostrando página de error");
                 break;
 
@@ -570,6 +740,11 @@ void updateUI() {
                 // Serial.println("UI: EMERGENCIA ACTIVADA");
                 break;
 
+            case STATE_CALIBRATION:
+                nextion.showCalibration();
+                updateCalibrationDisplay();
+                break;
+
             default:
                 break;
         }
@@ -582,11 +757,20 @@ void updateUI() {
 
     lastUIUpdate = now;
 
+    // Página de calibración: presión y nivel en vivo mientras se llena
+    if (state == STATE_CALIBRATION) {
+        checkTemperatureIdentify();
+        updateCalibrationDisplay();
+        return;
+    }
+
     // Actualizar página de ejecución si estamos en proceso o pausado
     // Nota: STATE_RESTING está entre STATE_SPINNING y STATE_COOLING por el orden del enum
     if ((state >= STATE_FILLING && state <= STATE_COOLING) || state == STATE_PAUSED) {
-        // Mostrar tiempo restante si está en fase de lavado o pausado, sino 0
-        uint16_t phaseTime = (stateMachine.isTimerActive() || state == STATE_PAUSED)
+        // Mostrar tiempo restante si está en fase con tiempo o pausado;
+        // durante el llenado, el tiempo estimado hasta el nivel objetivo
+        uint16_t phaseTime = (stateMachine.isTimerActive() || state == STATE_PAUSED ||
+                              state == STATE_FILLING)
             ? stateMachine.getPhaseRemainingTime() / 1000
             : 0;
         // Tiempo total del programa (valor fijo calculado, no cambia durante ejecución)
@@ -595,15 +779,18 @@ void updateUI() {
         // Durante el reposo, mostrar la tanda que acaba de terminar
         // (currentProcess ya está apuntando a la tanda actual/que terminó)
         uint8_t displayProcess = config.currentProcess;
+        SensorSnapshot sensorData = sensors.getSnapshot();
 
+        // Valores y parpadeo en una trama: el panel redibuja una sola vez
+        nextion.beginFrame();
         nextion.updateExecutionDisplay(
             config.programNumber,
             config.currentPhase,
             displayProcess,
             phaseTime,
             totalTime,
-            sensors.getTemperature(),
-            sensors.getWaterLevel(),
+            sensorData.temperature,
+            sensorData.waterLevelCenti,
             config.centrifugeEnabled[displayProcess],
             config.waterType[displayProcess]
         );
@@ -613,11 +800,12 @@ void updateUI() {
         if (state == STATE_PAUSED) {
             blinkState = !blinkState;
             // Alternar visibilidad del componente tiempo_ejec
-            nextion.sendCommand(blinkState ? "vis tiempo_ejec,1" : "vis tiempo_ejec,0");
+            nextion.setVisible("tiempo_ejec", blinkState);
         } else {
             // Asegurar que esté visible cuando no está pausado
-            nextion.sendCommand("vis tiempo_ejec,1");
+            nextion.setVisible("tiempo_ejec", true);
         }
+        nextion.endFrame();
     }
 }
 
@@ -644,8 +832,31 @@ void setup() {
     // Serial.println("Inicializando sensores...");
     sensors.begin();
 
+    // Sensores de temperatura: direcciones guardadas (arranque en caliente) o búsqueda
+    TemperatureBus::Address tempAddresses[SensorConfig::TEMP_SENSOR_COUNT];
+    bool tempSaved = storage.loadTempAddresses(tempAddresses, SensorConfig::TEMP_SENSOR_COUNT);
+    if (sensors.beginTemperature(tempSaved ? tempAddresses : nullptr)) {
+        storage.saveTempAddresses(sensors.getTemperatureBus().getAddresses(),
+                                  SensorConfig::TEMP_SENSOR_COUNT);
+    }
+
+    // Calibración de nivel guardada (si no hay, se usan los umbrales de Config.h)
+    LevelCalibration savedCalibration;
+    if (storage.loadCalibration(savedCalibration) && sensors.setCalibration(savedCalibration)) {
+        Serial.printf("Calibración de nivel cargada (%d puntos)\n", savedCalibration.size());
+    }
+    sensors.setZeroOffset(storage.loadZeroOffset());
+
+    // Adquisición en su propia tarea: desde aquí loop() solo lee instantáneas
+    sensors.beginTask();
+
     // Serial.println("Inicializando pantalla Nextion...");
-    nextion.begin();
+    // Velocidad negociada en un arranque anterior: sin recorrer la escalera
+    uint32_t savedBaud = storage.loadNextionBaud();
+    uint32_t nextionBaud = nextion.begin(savedBaud);
+    if (nextionBaud != 0 && nextionBaud != savedBaud) {
+        storage.saveNextionBaud(nextionBaud);
+    }
     nextion.setButtonCallback(handleNextionEvent);
 
     // Configurar textos de la página de bienvenida (antes de mostrarla)
@@ -676,7 +887,7 @@ void loop() {
     // Actualizar módulos principales
     stateMachine.update();
     hardware.update();
-    sensors.update();
+    sensors.update();  // Solo si no hay tarea de adquisición
     nextion.update();
 
     // Actualizar interfaz de usuario
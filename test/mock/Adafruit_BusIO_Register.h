@@ -0,0 +1,36 @@
+#ifndef MOCK_ADAFRUIT_BUSIO_REGISTER_H
+#define MOCK_ADAFRUIT_BUSIO_REGISTER_H
+
+// ========================================
+// MOCK DE Adafruit_BusIO_Register PARA TESTS NATIVOS (host)
+// ========================================
+// Solo la parte I2C que usa Ads1115Pressure: write() manda la dirección del
+// registro como prefijo y el valor en una sola transacción, como la librería.
+
+#include <Adafruit_I2CDevice.h>
+
+class Adafruit_BusIO_Register {
+public:
+    Adafruit_BusIO_Register(Adafruit_I2CDevice* device, uint16_t reg_addr, uint8_t width = 1,
+                            uint8_t byteorder = LSBFIRST, uint8_t = 1)
+        : device(device), reg(reg_addr), width(width), byteorder(byteorder) {}
+
+    bool write(uint32_t value, uint8_t numbytes = 0) {
+        if (numbytes == 0) numbytes = width;
+        uint8_t buffer[4];
+        for (uint8_t i = 0; i < numbytes; i++) {
+            uint8_t shift = (byteorder == MSBFIRST) ? 8 * (numbytes - 1 - i) : 8 * i;
+            buffer[i] = (value >> shift) & 0xFF;
+        }
+        uint8_t prefix = (uint8_t)reg;
+        return device->write(buffer, numbytes, true, &prefix, 1);
+    }
+
+private:
+    Adafruit_I2CDevice* device;
+    uint16_t reg;
+    uint8_t width;
+    uint8_t byteorder;
+};
+
+#endif // MOCK_ADAFRUIT_BUSIO_REGISTER_H
@@ -0,0 +1,61 @@
+#ifndef MOCK_ADAFRUIT_I2CDEVICE_H
+#define MOCK_ADAFRUIT_I2CDEVICE_H
+
+// ========================================
+// MOCK DE Adafruit_I2CDevice PARA TESTS NATIVOS (host)
+// ========================================
+// Misma interfaz que la librería, sobre el ADS1115 de MockWire: una
+// transacción por llamada, con la dirección y los bytes de datos.
+
+#include <Arduino.h>
+#include <Wire.h>
+
+class Adafruit_I2CDevice {
+public:
+    explicit Adafruit_I2CDevice(uint8_t addr, TwoWire* = &Wire) : addr(addr) {}
+
+    bool begin(bool addr_detect = true) { return !addr_detect || detected(); }
+
+    bool detected() {
+        MockWire::transaction(0);
+        return responds();
+    }
+
+    // Lectura desde el registro del puntero, MSB primero
+    bool read(uint8_t* buffer, size_t len, bool = true) {
+        MockWire::transaction(len);
+        if (!responds()) return false;
+        uint16_t value = MockWire::registers[MockWire::pointer];
+        for (size_t i = 0; i < len; i++) {
+            buffer[i] = (i % 2 == 0) ? (value >> 8) : (value & 0xFF);
+        }
+        return true;
+    }
+
+    // Puntero (1 byte) o puntero + registro de 16 bits
+    bool write(const uint8_t* buffer, size_t len, bool = true,
+               const uint8_t* prefix = nullptr, size_t prefix_len = 0) {
+        MockWire::transaction(prefix_len + len);
+        if (!responds()) return false;
+        uint8_t data[3];
+        size_t count = 0;
+        for (size_t i = 0; i < prefix_len && count < 3; i++) data[count++] = prefix[i];
+        for (size_t i = 0; i < len && count < 3; i++) data[count++] = buffer[i];
+        if (count == 0) return true;
+        MockWire::pointer = data[0] & 0x03;
+        if (count == 3) {
+            MockWire::registers[MockWire::pointer] = (uint16_t)((data[1] << 8) | data[2]);
+            if (MockWire::pointer == 1) MockWire::configWrites++;
+        }
+        return true;
+    }
+
+    uint8_t address() const { return addr; }
+
+private:
+    uint8_t addr;
+
+    bool responds() const { return MockWire::present && addr == MockWire::address; }
+};
+
+#endif // MOCK_ADAFRUIT_I2CDEVICE_H
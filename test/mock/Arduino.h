@@ -0,0 +1,135 @@
+#ifndef MOCK_ARDUINO_H
+#define MOCK_ARDUINO_H
+
+// ========================================
+// MOCK DE ARDUINO PARA TESTS NATIVOS (host)
+// ========================================
+// Reloj simulado en nanosegundos, GPIO con costo fijo por acceso, secciones
+// críticas instrumentadas y un modelo mínimo del HX710B (DOUT/PD_SCK).
+// Solo se usa en los entornos native de platformio.ini.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef ARDUINO
+#define ARDUINO 100
+#endif
+#define ARDUINO_ARCH_ESP32 1
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LSBFIRST 0
+#define MSBFIRST 1
+#define IRAM_ATTR
+
+namespace MockArduino {
+    // Costos simulados de cada primitiva (aprox. ESP32 a 240 MHz con el core Arduino)
+    inline uint32_t gpioWriteNs = 150;
+    inline uint32_t gpioReadNs = 100;
+
+    inline uint64_t nowNs = 0;
+
+    // Instrumentación de secciones críticas
+    inline int criticalDepth = 0;
+    inline uint64_t criticalStartNs = 0;
+    inline uint64_t criticalTotalNs = 0;
+    inline uint64_t criticalMaxNs = 0;
+
+    // Modelo del HX710B
+    inline uint8_t hxDoutPin = 0xFF;
+    inline uint8_t hxSckPin = 0xFF;
+    inline uint32_t hxValue = 0;     // 24 bits a desplazar
+    inline uint8_t hxBit = 0;        // Bits ya desplazados
+    inline bool hxReady = true;      // DOUT en LOW antes del primer flanco
+    inline uint8_t hxSckLevel = LOW;
+    inline uint32_t hxSckPulses = 0;
+
+    inline void reset() {
+        nowNs = 0;
+        criticalDepth = 0;
+        criticalStartNs = criticalTotalNs = criticalMaxNs = 0;
+        hxBit = 0;
+        hxReady = true;
+        hxSckLevel = LOW;
+        hxSckPulses = 0;
+    }
+
+    inline void enterCritical() {
+        if (criticalDepth++ == 0) criticalStartNs = nowNs;
+    }
+
+    inline void exitCritical() {
+        if (--criticalDepth == 0) {
+            uint64_t span = nowNs - criticalStartNs;
+            criticalTotalNs += span;
+            if (span > criticalMaxNs) criticalMaxNs = span;
+        }
+    }
+}
+
+inline unsigned long millis() { return (unsigned long)(MockArduino::nowNs / 1000000ULL); }
+inline unsigned long micros() { return (unsigned long)(MockArduino::nowNs / 1000ULL); }
+inline void delay(unsigned long ms) { MockArduino::nowNs += ms * 1000000ULL; }
+inline void delayMicroseconds(unsigned int us) { MockArduino::nowNs += us * 1000ULL; }
+inline void pinMode(uint8_t, uint8_t) {}
+
+inline void digitalWrite(uint8_t pin, uint8_t level) {
+    using namespace MockArduino;
+    nowNs += gpioWriteNs;
+    if (pin == hxSckPin) {
+        if (level == HIGH && hxSckLevel == LOW) {
+            hxSckPulses++;
+            if (hxBit < 24) hxBit++;
+        }
+        hxSckLevel = level;
+    }
+}
+
+inline int digitalRead(uint8_t pin) {
+    using namespace MockArduino;
+    nowNs += gpioReadNs;
+    if (pin == hxDoutPin) {
+        if (hxBit == 0) return hxReady ? LOW : HIGH;
+        return (hxValue >> (24 - hxBit)) & 1;
+    }
+    return LOW;
+}
+
+inline uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder) {
+    uint8_t value = 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        digitalWrite(clockPin, HIGH);
+        if (bitOrder == LSBFIRST) value |= digitalRead(dataPin) << i;
+        else value |= digitalRead(dataPin) << (7 - i);
+        digitalWrite(clockPin, LOW);
+    }
+    return value;
+}
+
+inline void noInterrupts() { MockArduino::enterCritical(); }
+inline void interrupts() { MockArduino::exitCritical(); }
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) MockArduino::enterCritical()
+#define portEXIT_CRITICAL(mux) MockArduino::exitCritical()
+
+// Serial: los mensajes de los drivers se descartan
+struct MockSerial {
+    void begin(unsigned long) {}
+    size_t print(const char*) { return 0; }
+    size_t println(const char* = "") { return 0; }
+    size_t printf(const char*, ...) { return 0; }
+};
+inline MockSerial Serial;
+
+#endif // MOCK_ARDUINO_H
@@ -0,0 +1,255 @@
+#ifndef MOCK_ONEWIRE_H
+#define MOCK_ONEWIRE_H
+
+// ========================================
+// MOCK DE ONEWIRE PARA TESTS NATIVOS (host)
+// ========================================
+// Un DS18B20 en el bus con los tiempos de la librería OneWire (bit-banging):
+// cada slot avanza el reloj simulado y marca el tramo con interrupciones off.
+// Con MockOneWire::rmt los mismos bits se agrupan en transferencias como en
+// OneWireRmt (hasta 4 bytes cada una): la CPU paga RMT_CALL_US por
+// transferencia y el resto del tiempo de bus queda bloqueada, sin tramos con
+// interrupciones off. Solo se usa en el entorno [env:native] de platformio.ini.
+
+#include <Arduino.h>
+
+namespace MockOneWire {
+    // Tiempos de OneWire 2.3 (µs): total del slot y tramo con interrupciones off
+    constexpr uint32_t RESET_US = 960, RESET_IRQ_OFF_US = 70;
+    constexpr uint32_t WRITE1_US = 65, WRITE1_IRQ_OFF_US = 10;
+    constexpr uint32_t WRITE0_US = 70, WRITE0_IRQ_OFF_US = 65;
+    constexpr uint32_t READ_US = 66, READ_IRQ_OFF_US = 13;
+
+    // Backend RMT: llamadas al driver por transferencia (rmt_write_items,
+    // semáforo, ring buffer). Estimado para 240 MHz, no medido: el ahorro de
+    // CPU del benchmark sale de este valor. Reposo que espera la captura RX
+    // antes de darse por terminada (OneWireRmt::SLOT_IDLE_US).
+    constexpr uint32_t RMT_CALL_US = 20;
+    constexpr uint32_t RMT_RX_IDLE_US = 80;
+    constexpr uint8_t RMT_CHUNK_BYTES = 4;
+
+    inline bool present = true;
+    inline bool rmt = false;
+    inline uint8_t rom[8] = {0x28, 0xFF, 0x64, 0x1E, 0x0C, 0x31, 0x18, 0x66};
+    inline uint8_t scratchpad[9] = {};
+    inline uint32_t conversionUs = 750000;
+    inline uint64_t conversionEndNs = 0;
+
+    // Contadores
+    inline uint32_t resets = 0;
+    inline uint32_t bitSlots = 0;
+    inline uint32_t conversions = 0;
+    inline uint32_t configWrites = 0;
+    inline uint32_t transfers = 0;  // Transferencias RMT
+    inline uint64_t busNs = 0;   // Tiempo total en slots
+    inline uint64_t cpuNs = 0;   // Parte con la CPU ocupada (bit-banging: todo)
+
+    inline void slot(uint32_t totalUs, uint32_t irqOffUs) {
+        if (rmt) {
+            MockArduino::nowNs += totalUs * 1000ULL;
+        } else {
+            MockArduino::enterCritical();
+            MockArduino::nowNs += irqOffUs * 1000ULL;
+            MockArduino::exitCritical();
+            MockArduino::nowNs += (totalUs - irqOffUs) * 1000ULL;
+            cpuNs += totalUs * 1000ULL;
+        }
+        busNs += totalUs * 1000ULL;
+    }
+
+    // Una transferencia RMT (sin efecto con bit-banging)
+    inline void transfer(bool capture) {
+        if (!rmt) return;
+        transfers++;
+        MockArduino::nowNs += RMT_CALL_US * 1000ULL;
+        cpuNs += RMT_CALL_US * 1000ULL;
+        if (capture) {
+            MockArduino::nowNs += RMT_RX_IDLE_US * 1000ULL;
+            busNs += RMT_RX_IDLE_US * 1000ULL;
+        }
+    }
+
+    inline uint8_t crc8(const uint8_t* data, uint8_t len) {
+        uint8_t crc = 0;
+        while (len--) {
+            uint8_t inbyte = *data++;
+            for (uint8_t i = 8; i; i--) {
+                uint8_t mix = (crc ^ inbyte) & 0x01;
+                crc >>= 1;
+                if (mix) crc ^= 0x8C;
+                inbyte >>= 1;
+            }
+        }
+        return crc;
+    }
+
+    // Carga una temperatura (1/16 °C) y la resolución en el scratchpad
+    inline void setTemperature(int16_t raw, uint8_t resolution) {
+        scratchpad[0] = raw & 0xFF;
+        scratchpad[1] = (raw >> 8) & 0xFF;
+        scratchpad[2] = 0x4B;                                  // TH
+        scratchpad[3] = 0x46;                                  // TL
+        scratchpad[4] = 0x1F | ((resolution - 9) << 5);        // Configuración
+        scratchpad[5] = 0xFF;
+        scratchpad[6] = 0x0C;
+        scratchpad[7] = 0x10;
+        scratchpad[8] = crc8(scratchpad, 8);
+        static const uint32_t times[4] = {93750, 187500, 375000, 750000};
+        conversionUs = times[resolution - 9];
+    }
+
+    inline void reset() {
+        present = true;
+        rmt = false;
+        conversionEndNs = 0;
+        resets = bitSlots = conversions = configWrites = transfers = 0;
+        busNs = cpuNs = 0;
+    }
+}
+
+class OneWire {
+public:
+    OneWire() {}
+    explicit OneWire(uint8_t) {}
+    void begin(uint8_t) {}
+
+    uint8_t reset() {
+        MockOneWire::resets++;
+        MockOneWire::transfer(true);
+        MockOneWire::slot(MockOneWire::RESET_US, MockOneWire::RESET_IRQ_OFF_US);
+        phase = PHASE_ROM;
+        return MockOneWire::present ? 1 : 0;
+    }
+
+    void skip() { write(0xCC); }
+
+    void select(const uint8_t rom[8]) {
+        uint8_t cmd[9] = {0x55};
+        memcpy(&cmd[1], rom, 8);
+        write_bytes(cmd, sizeof(cmd));
+    }
+
+    void write_bit(uint8_t v) {
+        MockOneWire::transfer(false);
+        writeSlot(v);
+    }
+
+    void write(uint8_t v, uint8_t power = 0) {
+        write_bytes(&v, 1, power);
+    }
+
+    void write_bytes(const uint8_t* buf, uint16_t count, bool power = 0) {
+        (void)power;
+        for (uint16_t i = 0; i < count; i++) {
+            if (i % MockOneWire::RMT_CHUNK_BYTES == 0) MockOneWire::transfer(false);
+            for (uint8_t b = 0; b < 8; b++) writeSlot((buf[i] >> b) & 1);
+            command(buf[i]);
+        }
+    }
+
+    uint8_t read_bit() {
+        MockOneWire::transfer(true);
+        return readSlot();
+    }
+
+    uint8_t read() {
+        uint8_t value;
+        read_bytes(&value, 1);
+        return value;
+    }
+
+    void read_bytes(uint8_t* buf, uint16_t count) {
+        for (uint16_t i = 0; i < count; i++) {
+            if (i % MockOneWire::RMT_CHUNK_BYTES == 0) MockOneWire::transfer(true);
+            buf[i] = 0;
+            for (uint8_t b = 0; b < 8; b++) buf[i] |= readSlot() << b;
+        }
+    }
+
+    void depower() {}
+    void reset_search() {}
+    void target_search(uint8_t) {}
+    bool search(uint8_t* newAddr, bool = true) {
+        memcpy(newAddr, MockOneWire::rom, 8);
+        return MockOneWire::present;
+    }
+
+    static uint8_t crc8(const uint8_t* addr, uint8_t len) { return MockOneWire::crc8(addr, len); }
+
+private:
+    enum Phase : uint8_t {
+        PHASE_ROM,
+        PHASE_MATCH_ROM,
+        PHASE_FUNCTION,
+        PHASE_CONVERTING,
+        PHASE_READ_SCRATCHPAD,
+        PHASE_WRITE_SCRATCHPAD,
+        PHASE_IDLE
+    };
+    Phase phase = PHASE_IDLE;
+    uint8_t matchBytes = 0;
+    uint8_t readBit = 0;
+    uint8_t writeByte = 0;
+
+    void writeSlot(uint8_t v) {
+        MockOneWire::bitSlots++;
+        if (v & 1) MockOneWire::slot(MockOneWire::WRITE1_US, MockOneWire::WRITE1_IRQ_OFF_US);
+        else MockOneWire::slot(MockOneWire::WRITE0_US, MockOneWire::WRITE0_IRQ_OFF_US);
+    }
+
+    uint8_t readSlot() {
+        MockOneWire::bitSlots++;
+        MockOneWire::slot(MockOneWire::READ_US, MockOneWire::READ_IRQ_OFF_US);
+        if (!MockOneWire::present) return 1;
+        if (phase == PHASE_CONVERTING) {
+            return MockArduino::nowNs >= MockOneWire::conversionEndNs ? 1 : 0;
+        }
+        if (phase == PHASE_READ_SCRATCHPAD && readBit < 72) {
+            uint8_t bit = (MockOneWire::scratchpad[readBit / 8] >> (readBit % 8)) & 1;
+            readBit++;
+            return bit;
+        }
+        return 1;
+    }
+
+    void command(uint8_t v) {
+        switch (phase) {
+            case PHASE_ROM:
+                if (v == 0xCC) phase = PHASE_FUNCTION;
+                else if (v == 0x55) { phase = PHASE_MATCH_ROM; matchBytes = 0; }
+                else phase = PHASE_IDLE;
+                break;
+            case PHASE_MATCH_ROM:
+                if (++matchBytes == 8) phase = PHASE_FUNCTION;
+                break;
+            case PHASE_FUNCTION:
+                if (v == 0x44) {
+                    phase = PHASE_CONVERTING;
+                    MockOneWire::conversions++;
+                    MockOneWire::conversionEndNs = MockArduino::nowNs + MockOneWire::conversionUs * 1000ULL;
+                } else if (v == 0xBE) {
+                    phase = PHASE_READ_SCRATCHPAD;
+                    readBit = 0;
+                } else if (v == 0x4E) {
+                    phase = PHASE_WRITE_SCRATCHPAD;
+                    writeByte = 0;
+                } else {
+                    phase = PHASE_IDLE;
+                }
+                break;
+            case PHASE_WRITE_SCRATCHPAD:
+                // TH, TL y configuración; el CRC lo recalcula el sensor
+                MockOneWire::scratchpad[2 + writeByte++] = v;
+                if (writeByte == 3) {
+                    MockOneWire::scratchpad[8] = MockOneWire::crc8(MockOneWire::scratchpad, 8);
+                    MockOneWire::configWrites++;
+                    phase = PHASE_IDLE;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+#endif // MOCK_ONEWIRE_H
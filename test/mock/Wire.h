@@ -0,0 +1,67 @@
+#ifndef MOCK_WIRE_H
+#define MOCK_WIRE_H
+
+// ========================================
+// MOCK DE WIRE (I2C) PARA TESTS NATIVOS (host)
+// ========================================
+// Un ADS1115 en el bus, con los tiempos del driver I2C del ESP32 (core
+// Arduino 2.x): cada transacción la arma el driver (I2C_CALL_US de CPU) y
+// la tarea queda bloqueada mientras el periférico mueve los bits (9 por
+// byte con la dirección, más start y stop) a la frecuencia configurada. El bit-banging no
+// interviene: no hay tramos con interrupciones off en la tarea.
+// Solo se usa en el entorno [env:native_ads1115] de platformio.ini.
+
+#include <Arduino.h>
+
+namespace MockWire {
+    // Llamadas al driver por transacción (comandos, semáforo, ISR; estimado para 240 MHz)
+    constexpr uint32_t I2C_CALL_US = 40;
+
+    inline uint32_t clockHz = 100000;
+    inline bool present = true;
+
+    // ADS1115: puntero y registros (conversión, configuración, Lo_thresh, Hi_thresh)
+    inline uint8_t address = 0x48;
+    inline uint8_t pointer = 0;
+    inline uint16_t registers[4] = {0x0000, 0x8583, 0x8000, 0x7FFF};
+
+    // Contadores
+    inline uint32_t transactions = 0;
+    inline uint32_t configWrites = 0;
+    inline uint64_t busNs = 0;
+    inline uint64_t cpuNs = 0;
+
+    inline void transaction(size_t bytes) {
+        transactions++;
+        MockArduino::nowNs += I2C_CALL_US * 1000ULL;
+        cpuNs += I2C_CALL_US * 1000ULL;
+        uint64_t ns = ((bytes + 1) * 9 + 2) * 1000000000ULL / clockHz;  // + dirección
+        MockArduino::nowNs += ns;
+        busNs += ns;
+    }
+
+    inline void reset() {
+        clockHz = 100000;
+        present = true;
+        pointer = 0;
+        registers[0] = 0x0000;
+        registers[1] = 0x8583;  // Valores de encendido
+        registers[2] = 0x8000;
+        registers[3] = 0x7FFF;
+        transactions = configWrites = 0;
+        busNs = cpuNs = 0;
+    }
+}
+
+class TwoWire {
+public:
+    bool begin(int = -1, int = -1, uint32_t frequency = 0) {
+        if (frequency != 0) MockWire::clockHz = frequency;
+        return true;
+    }
+    void setClock(uint32_t frequency) { MockWire::clockHz = frequency; }
+};
+
+inline TwoWire Wire;
+
+#endif // MOCK_WIRE_H
@@ -0,0 +1,217 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <HX710B.h>
+#include "PressureSensor.h"
+#include "PressureMath.h"
+#include "FaultMonitor.h"
+
+// ========================================
+// TESTS NATIVOS DEL ADS1115 Y BENCHMARK CONTRA EL HX710B
+// ========================================
+// Se compila con PRESSURE_USE_ADS1115=1 y src/Ads1115Pressure.cpp en el
+// entorno [env:native_ads1115]. Los dos drivers son los reales; el bus
+// I2C y el HX710B son los modelos de test/mock (Wire.h, Arduino.h).
+
+static constexpr uint8_t ALERT_PIN = 27;
+static constexpr uint8_t SDA_PIN = 21;
+static constexpr uint8_t SCL_PIN = 22;
+static constexpr uint8_t DOUT_PIN = 5;
+static constexpr uint8_t SCK_PIN = 4;
+static constexpr int READS = 10;
+
+void setUp(void) {
+    MockArduino::reset();
+    MockWire::reset();
+}
+
+void tearDown(void) {}
+
+// ========================================
+// TESTS DE PROTOCOLO
+// ========================================
+
+void test_begin_configures_ready_mode_and_pga() {
+    Ads1115Pressure sensor;
+    TEST_ASSERT_TRUE(sensor.begin(ALERT_PIN, SDA_PIN, SCL_PIN, Ads1115Pressure::RATE_16_SPS));
+
+    TEST_ASSERT_EQUAL_UINT32(SensorConfig::ADS1115_I2C_HZ, MockWire::clockHz);
+    TEST_ASSERT_EQUAL_UINT16(0x0000, MockWire::registers[2]);
+    TEST_ASSERT_EQUAL_UINT16(0x8000, MockWire::registers[3]);
+
+    // AIN0, PGA ±2.048 V (span de 2.0 V), continuo, 16 SPS, comparador con 1 conversión
+    TEST_ASSERT_EQUAL_UINT16(2048, PressureMath::ADS1115_FSR_MV);
+    TEST_ASSERT_EQUAL_UINT16(0x4000 | 0x0400 | (Ads1115Pressure::RATE_16_SPS << 5),
+                            MockWire::registers[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, MockWire::pointer);
+}
+
+void test_begin_fails_without_device() {
+    MockWire::present = false;
+    Ads1115Pressure sensor;
+    TEST_ASSERT_FALSE(sensor.begin(ALERT_PIN, SDA_PIN, SCL_PIN));
+}
+
+void test_read_converts_to_hx710b_counts() {
+    Ads1115Pressure sensor;
+    sensor.begin(ALERT_PIN, SDA_PIN, SCL_PIN);
+
+    // Salida a 0 Pa: 200 mV = 3200 códigos a 16 por mV
+    MockWire::registers[0] = 3200;
+    long value = -1;
+    TEST_ASSERT_TRUE(sensor.read_conversion(value));
+    TEST_ASSERT_EQUAL_INT32(PressureMath::rawFromAds1115(3200), (int32_t)value);
+
+    // Un read = una transacción de 2 bytes, sin tocar la configuración
+    uint32_t transactions = MockWire::transactions;
+    uint32_t writes = MockWire::configWrites;
+    sensor.read_conversion(value);
+    TEST_ASSERT_EQUAL_UINT32(transactions + 1, MockWire::transactions);
+    TEST_ASSERT_EQUAL_UINT32(writes, MockWire::configWrites);
+}
+
+void test_rate_change_applied_after_read() {
+    Ads1115Pressure sensor;
+    sensor.begin(ALERT_PIN, SDA_PIN, SCL_PIN, Ads1115Pressure::RATE_16_SPS);
+    uint32_t writes = MockWire::configWrites;
+
+    sensor.set_data_rate(Ads1115Pressure::RATE_64_SPS);
+    TEST_ASSERT_EQUAL_UINT32(writes, MockWire::configWrites);
+
+    long value;
+    TEST_ASSERT_TRUE(sensor.read_conversion(value));
+    TEST_ASSERT_EQUAL_UINT32(writes + 1, MockWire::configWrites);
+    TEST_ASSERT_EQUAL_UINT16(Ads1115Pressure::RATE_64_SPS, (MockWire::registers[1] >> 5) & 0x07);
+    TEST_ASSERT_EQUAL_UINT8(0, MockWire::pointer);  // Las lecturas siguen en conversión
+}
+
+// ========================================
+// LÍMITES DE FAULTMONITOR EN LA ESCALA DEL ADS1115
+// ========================================
+
+// Lecturas del driver alrededor de code (con ruido de ±2 códigos) hasta
+// la primera falla o count muestras a 16 SPS
+static Fault::Code faultAfterSamples(Ads1115Pressure& sensor, FaultMonitor& monitor,
+                                     int32_t code, uint32_t count) {
+    uint32_t nowUs = 0;
+    monitor.reset(nowUs);
+    for (uint32_t i = 0; i < count && monitor.getFault() == Fault::NONE; i++) {
+        int32_t noisy = code + (int32_t)(i * 7 % 5) - 2;
+        if (noisy > INT16_MAX) noisy = INT16_MAX;
+        MockWire::registers[0] = (uint16_t)(int16_t)noisy;
+        long value = 0;
+        sensor.read_conversion(value);
+        nowUs += 62500;
+        monitor.checkPressureSample((int32_t)value, nowUs);
+        monitor.checkPressureTimeout(nowUs);
+    }
+    return monitor.getFault();
+}
+
+void test_full_span_is_not_a_fault() {
+    Ads1115Pressure sensor;
+    sensor.begin(ALERT_PIN, SDA_PIN, SCL_PIN);
+    FaultMonitor monitor;
+
+    // 0 Pa y el final del span: sin falla, aun más allá del umbral de congelado
+    constexpr int32_t zeroCode = (int32_t)SensorConfig::ADS1115_ZERO_MV * 32768 / PressureMath::ADS1115_FSR_MV;
+    constexpr int32_t spanCode = (int32_t)PressureMath::ADS1115_MAX_MV * 32768 / PressureMath::ADS1115_FSR_MV;
+    TEST_ASSERT_EQUAL(Fault::NONE, faultAfterSamples(sensor, monitor, zeroCode, 300));
+    TEST_ASSERT_EQUAL(Fault::NONE, faultAfterSamples(sensor, monitor, spanCode, 300));
+
+    // Tope del PGA (sobrepresión o sensor en corto) y 0 V (cable cortado): E11
+    TEST_ASSERT_EQUAL(Fault::PRESSURE_RANGE, faultAfterSamples(sensor, monitor, INT16_MAX, 10));
+    TEST_ASSERT_EQUAL(Fault::PRESSURE_RANGE, faultAfterSamples(sensor, monitor, 0, 10));
+}
+
+// ========================================
+// BENCHMARK: HX710B (BIT-BANGING) CONTRA ADS1115 (I2C)
+// ========================================
+
+// Costo por lectura: tiempo total de la llamada, CPU ocupada e IRQ off
+struct ReadCost {
+    uint64_t totalNs;
+    uint64_t cpuNs;
+    uint64_t irqOffNs;
+    uint64_t irqOffMaxNs;
+};
+
+static void measureHx710b(ReadCost& cost) {
+    MockArduino::hxDoutPin = DOUT_PIN;
+    MockArduino::hxSckPin = SCK_PIN;
+    HX710B sensor;
+    sensor.begin(DOUT_PIN, SCK_PIN, HX710B_DIFF_40HZ);
+
+    cost = ReadCost{};
+    for (int i = 0; i < READS; i++) {
+        MockArduino::hxBit = 0;
+        MockArduino::hxValue = 0x123456;
+        uint64_t start = MockArduino::nowNs;
+        sensor.read();
+        cost.totalNs += MockArduino::nowNs - start;
+    }
+    // Bit-banging: la CPU está ocupada toda la lectura
+    cost.cpuNs = cost.totalNs;
+    cost.irqOffNs = MockArduino::criticalTotalNs;
+    cost.irqOffMaxNs = MockArduino::criticalMaxNs;
+}
+
+static void measureAds1115(ReadCost& cost) {
+    Ads1115Pressure sensor;
+    TEST_ASSERT_TRUE(sensor.begin(ALERT_PIN, SDA_PIN, SCL_PIN, Ads1115Pressure::RATE_64_SPS));
+    MockWire::registers[0] = 3200;
+    MockArduino::criticalTotalNs = MockArduino::criticalMaxNs = 0;
+
+    cost = ReadCost{};
+    uint64_t cpuStart = MockWire::cpuNs;
+    for (int i = 0; i < READS; i++) {
+        long value;
+        uint64_t start = MockArduino::nowNs;
+        TEST_ASSERT_TRUE(sensor.read_conversion(value));
+        cost.totalNs += MockArduino::nowNs - start;
+    }
+    // Driver I2C: la tarea espera bloqueada mientras el periférico mueve los bits
+    cost.cpuNs = MockWire::cpuNs - cpuStart;
+    cost.irqOffNs = MockArduino::criticalTotalNs;
+    cost.irqOffMaxNs = MockArduino::criticalMaxNs;
+}
+
+void test_benchmark_hx710b_vs_ads1115() {
+    ReadCost hx{}, ads{};
+    measureHx710b(hx);
+    MockArduino::reset();
+    MockWire::reset();
+    measureAds1115(ads);
+
+    // Tasas usadas en lavado: HX710B a 40 SPS, ADS1115 a 64 SPS
+    printf("\n[BENCH] Lectura de presión (%d muestras)\n", READS);
+    printf("[BENCH] HX710B:  %5llu us/lectura, CPU %5llu us, IRQ off %5llu us (tramo max %llu us), "
+           "CPU a 40 SPS %llu us/s\n",
+           (unsigned long long)(hx.totalNs / READS / 1000),
+           (unsigned long long)(hx.cpuNs / READS / 1000),
+           (unsigned long long)(hx.irqOffNs / READS / 1000),
+           (unsigned long long)(hx.irqOffMaxNs / 1000),
+           (unsigned long long)(hx.cpuNs / READS * 40 / 1000));
+    printf("[BENCH] ADS1115: %5llu us/lectura, CPU %5llu us, IRQ off %5llu us (tramo max %llu us), "
+           "CPU a 64 SPS %llu us/s\n",
+           (unsigned long long)(ads.totalNs / READS / 1000),
+           (unsigned long long)(ads.cpuNs / READS / 1000),
+           (unsigned long long)(ads.irqOffNs / READS / 1000),
+           (unsigned long long)(ads.irqOffMaxNs / 1000),
+           (unsigned long long)(ads.cpuNs / READS * 64 / 1000));
+
+    // El ADS1115 no deshabilita interrupciones y ocupa menos CPU por lectura
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)ads.irqOffNs);
+    TEST_ASSERT_TRUE(hx.irqOffNs > 0);
+    TEST_ASSERT_TRUE(ads.cpuNs < hx.cpuNs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_configures_ready_mode_and_pga);
+    RUN_TEST(test_begin_fails_without_device);
+    RUN_TEST(test_read_converts_to_hx710b_counts);
+    RUN_TEST(test_rate_change_applied_after_read);
+    RUN_TEST(test_full_span_is_not_a_fault);
+    RUN_TEST(test_benchmark_hx710b_vs_ads1115);
+    return UNITY_END();
+}
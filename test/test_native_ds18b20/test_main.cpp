@@ -0,0 +1,336 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <OneWire.h>
+#include "Ds18b20Reader.h"
+
+// ========================================
+// TESTS NATIVOS DEL DS18B20 (lectura por plazo y frecuencia de loop())
+// ========================================
+
+static const uint8_t ADDR[8] = {0x28, 0xFF, 0x64, 0x1E, 0x0C, 0x31, 0x18, 0x66};
+static constexpr int16_t RAW_25C = 25 * 16 + 8;     // 25.5 °C
+static constexpr uint32_t LOOP_WORK_US = 20;        // Resto de loop() (~50 kHz sin sensor)
+static constexpr uint32_t INTERVAL_MS = 500;        // Timing::SENSOR_READ_INTERVAL_MS
+static constexpr uint32_t BENCH_MS = 10000;
+
+OneWire bus;
+
+void setUp(void) {
+    MockArduino::reset();
+    MockOneWire::reset();
+}
+
+void tearDown(void) {}
+
+// Ruta original: requestTemperatures() + isConversionComplete() en cada pasada
+// + getTempC() (isConnected -> readScratchPad de 9 bytes + reset final)
+struct LegacyReader {
+    bool converting = false;
+    unsigned long lastRead = 0;
+    float temperature = 0;
+
+    void update() {
+        if (converting) {
+            if (bus.read_bit() == 1) {
+                uint8_t data[9];
+                bus.reset();
+                bus.select(ADDR);
+                bus.write(0xBE);
+                bus.read_bytes(data, 9);
+                bus.reset();
+                converting = false;
+                lastRead = millis();
+                if (OneWire::crc8(data, 8) == data[8]) {
+                    temperature = (int16_t)((data[1] << 8) | data[0]) * 0.0625f;
+                }
+            }
+        } else if (millis() - lastRead >= INTERVAL_MS) {
+            bus.reset();
+            bus.skip();
+            bus.write(0x44);
+            converting = true;
+        }
+    }
+};
+
+// Misma lógica que TemperatureBus::update() con un solo sensor
+struct DeadlineReader {
+    Ds18b20Reader reader;
+    bool converting = false;
+    unsigned long lastRead = 0;
+    float temperature = 0;
+
+    explicit DeadlineReader(uint8_t resolution) : reader(bus, resolution) {}
+
+    void update() {
+        unsigned long now = millis();
+        if (converting) {
+            if (reader.conversionDue(now)) {
+                int16_t raw = 0;
+                if (reader.readTemperature(ADDR, raw) == Ds18b20Reader::READ_OK) {
+                    temperature = Ds18b20Reader::toCelsius(raw);
+                }
+                reader.cancel();
+                converting = false;
+                lastRead = now;
+            }
+        } else if (now - lastRead >= INTERVAL_MS) {
+            converting = reader.startConversion(now);
+        }
+    }
+};
+
+struct LoopStats {
+    uint32_t loops;
+    uint32_t conversions;
+    uint64_t irqOffNs;
+    uint64_t busNs;
+};
+
+template <typename Reader>
+static LoopStats runLoop(Reader& reader) {
+    LoopStats stats = {0, 0, 0, 0};
+    while (millis() < BENCH_MS) {
+        reader.update();
+        MockArduino::nowNs += LOOP_WORK_US * 1000ULL;
+        stats.loops++;
+    }
+    stats.conversions = MockOneWire::conversions;
+    stats.irqOffNs = MockArduino::criticalTotalNs;
+    stats.busNs = MockOneWire::busNs;
+    return stats;
+}
+
+// ========================================
+// TESTS DE PROTOCOLO
+// ========================================
+
+void test_conversion_time_matches_resolution() {
+    TEST_ASSERT_EQUAL(94, Ds18b20Reader::conversionTimeMs(9));
+    TEST_ASSERT_EQUAL(188, Ds18b20Reader::conversionTimeMs(10));
+    TEST_ASSERT_EQUAL(375, Ds18b20Reader::conversionTimeMs(11));
+    TEST_ASSERT_EQUAL(750, Ds18b20Reader::conversionTimeMs(12));
+}
+
+void test_no_bus_traffic_before_deadline() {
+    MockOneWire::setTemperature(RAW_25C, 9);
+    Ds18b20Reader reader(bus, 9);
+    unsigned long start = millis();
+    TEST_ASSERT_TRUE(reader.startConversion(start));
+    uint32_t slots = MockOneWire::bitSlots;
+
+    MockArduino::nowNs = (start + 93) * 1000000ULL;
+    TEST_ASSERT_FALSE(reader.conversionDue(millis()));
+    TEST_ASSERT_EQUAL(slots, MockOneWire::bitSlots);
+
+    MockArduino::nowNs = (start + 94) * 1000000ULL;
+    TEST_ASSERT_TRUE(reader.conversionDue(millis()));
+}
+
+void test_reads_temperature_with_crc() {
+    MockOneWire::setTemperature(RAW_25C, 12);
+    Ds18b20Reader reader(bus, 12);
+    int16_t raw = 0;
+    TEST_ASSERT_EQUAL(Ds18b20Reader::READ_OK, reader.readTemperature(ADDR, raw));
+    TEST_ASSERT_EQUAL_INT16(RAW_25C, raw);
+
+    // Temperatura negativa
+    MockOneWire::setTemperature(-10 * 16 - 8, 12);
+    TEST_ASSERT_EQUAL(Ds18b20Reader::READ_OK, reader.readTemperature(ADDR, raw));
+    TEST_ASSERT_EQUAL_FLOAT(-10.5f, Ds18b20Reader::toCelsius(raw));
+}
+
+void test_low_resolution_masks_undefined_bits() {
+    MockOneWire::setTemperature(RAW_25C | 0x07, 9);  // Bits 0..2 indefinidos a 9 bits
+    Ds18b20Reader reader(bus, 9);
+    int16_t raw = 0;
+    TEST_ASSERT_EQUAL(Ds18b20Reader::READ_OK, reader.readTemperature(ADDR, raw));
+    TEST_ASSERT_EQUAL_INT16(RAW_25C, raw);
+}
+
+void test_detects_corrupt_scratchpad_and_missing_device() {
+    MockOneWire::setTemperature(RAW_25C, 12);
+    MockOneWire::scratchpad[0] ^= 0x10;
+    Ds18b20Reader reader(bus, 12);
+    int16_t raw = 0;
+    TEST_ASSERT_EQUAL(Ds18b20Reader::READ_CRC_ERROR, reader.readTemperature(ADDR, raw));
+
+    // Bus flotante: todo en 0xFF
+    memset(MockOneWire::scratchpad, 0xFF, sizeof(MockOneWire::scratchpad));
+    TEST_ASSERT_EQUAL(Ds18b20Reader::READ_CRC_ERROR, reader.readTemperature(ADDR, raw));
+
+    MockOneWire::present = false;
+    TEST_ASSERT_EQUAL(Ds18b20Reader::READ_NO_DEVICE, reader.readTemperature(ADDR, raw));
+    TEST_ASSERT_FALSE(reader.startConversion(millis()));
+}
+
+void test_without_crc_reads_only_temperature_bytes() {
+    MockOneWire::setTemperature(RAW_25C, 12);
+    Ds18b20Reader reader(bus, 12, false);
+    int16_t raw = 0;
+    TEST_ASSERT_EQUAL(Ds18b20Reader::READ_OK, reader.readTemperature(ADDR, raw));
+    TEST_ASSERT_EQUAL_INT16(RAW_25C, raw);
+
+    // Match ROM (9 bytes escritos) + 0xBE + 2 bytes leídos
+    TEST_ASSERT_EQUAL((9 + 1) * 8 + 2 * 8, MockOneWire::bitSlots);
+}
+
+// Lectura por el bus y comparación con TH/TL como la hace el sensor
+static void checkAlarmAt(int16_t raw, int8_t th, int8_t tl, bool expected) {
+    MockOneWire::setTemperature(raw, 12);
+    Ds18b20Reader reader(bus, 12);
+    int16_t read = 0;
+    TEST_ASSERT_EQUAL(Ds18b20Reader::READ_OK, reader.readTemperature(ADDR, read));
+    TEST_ASSERT_EQUAL_INT16(raw, read);
+    if (expected) TEST_ASSERT_TRUE(Ds18b20Reader::isAlarm(read, th, tl));
+    else TEST_ASSERT_FALSE(Ds18b20Reader::isAlarm(read, th, tl));
+}
+
+void test_alarm_compares_truncated_reading() {
+    constexpr int8_t TH = 60;
+    constexpr int8_t TL = 5;
+    constexpr int16_t HALF = 8;  // 0.5 °C en 1/16
+
+    checkAlarmAt(TH * 16 - HALF, TH, TL, false);  // 59.5 -> 59
+    checkAlarmAt(TH * 16, TH, TL, true);
+    checkAlarmAt(TH * 16 + HALF, TH, TL, true);
+    checkAlarmAt(TL * 16 + HALF, TH, TL, true);   // 5.5 -> 5 = TL
+    checkAlarmAt(TL * 16, TH, TL, true);
+    checkAlarmAt(TL * 16 - HALF, TH, TL, true);
+    checkAlarmAt((TL + 1) * 16, TH, TL, false);
+
+    // Bajo cero la parte entera redondea hacia -inf: -0.5 -> -1
+    checkAlarmAt(-HALF, TH, -1, true);
+    checkAlarmAt(0, TH, -1, false);
+}
+
+void test_update_config_skips_matching_sensor() {
+    MockOneWire::setTemperature(RAW_25C, 12);  // TH 75, TL 70 (fábrica)
+    Ds18b20Reader reader(bus, 12);
+
+    TEST_ASSERT_FALSE(reader.updateConfig(ADDR, 75, 70, 12));
+    TEST_ASSERT_EQUAL(0, MockOneWire::configWrites);
+
+    TEST_ASSERT_TRUE(reader.updateConfig(ADDR, 90, -55, 9));
+    TEST_ASSERT_EQUAL(1, MockOneWire::configWrites);
+
+    int8_t th, tl;
+    uint8_t bits;
+    TEST_ASSERT_TRUE(reader.readConfig(ADDR, th, tl, bits));
+    TEST_ASSERT_EQUAL(90, th);
+    TEST_ASSERT_EQUAL(-55, tl);
+    TEST_ASSERT_EQUAL(9, bits);
+
+    // Reinicio en caliente: el sensor ya la tiene
+    TEST_ASSERT_FALSE(reader.updateConfig(ADDR, 90, -55, 9));
+    TEST_ASSERT_EQUAL(1, MockOneWire::configWrites);
+
+    // Sin respuesta no se da por configurado
+    MockOneWire::present = false;
+    TEST_ASSERT_FALSE(reader.updateConfig(ADDR, 90, -55, 9));
+}
+
+// ========================================
+// BENCHMARK: FRECUENCIA DE loop()
+// ========================================
+
+static void benchmarkResolution(uint8_t resolution) {
+    MockArduino::reset();
+    MockOneWire::reset();
+    MockOneWire::setTemperature(RAW_25C, resolution);
+    LegacyReader legacy;
+    LoopStats before = runLoop(legacy);
+
+    MockArduino::reset();
+    MockOneWire::reset();
+    DeadlineReader deadline(resolution);
+    LoopStats after = runLoop(deadline);
+
+    printf("[BENCH] DS18B20 %u bits, loop() con %u us de trabajo, %u s:\n",
+           resolution, LOOP_WORK_US, BENCH_MS / 1000);
+    printf("  sondeo isConversionComplete(): %7.0f loops/s, %u conversiones, %.1f ms con IRQ off\n",
+           before.loops * 1000.0 / BENCH_MS, before.conversions, before.irqOffNs / 1e6);
+    printf("  plazo por resolución:         %7.0f loops/s, %u conversiones, %.1f ms con IRQ off\n",
+           after.loops * 1000.0 / BENCH_MS, after.conversions, after.irqOffNs / 1e6);
+    printf("  CPU por conversión (bit-banging): %.0f us -> %.0f us\n",
+           before.busNs / 1e3 / before.conversions, after.busNs / 1e3 / after.conversions);
+
+    TEST_ASSERT_EQUAL_FLOAT(25.5f, legacy.temperature);
+    TEST_ASSERT_EQUAL_FLOAT(25.5f, deadline.temperature);
+    TEST_ASSERT_TRUE(after.loops > before.loops);
+    TEST_ASSERT_TRUE(after.irqOffNs < before.irqOffNs);
+}
+
+void test_benchmark_loop_rate_9_bits() {
+    benchmarkResolution(9);
+}
+
+void test_benchmark_loop_rate_12_bits() {
+    benchmarkResolution(12);
+}
+
+// ========================================
+// BENCHMARK: BIT-BANGING vs RMT
+// ========================================
+
+struct BackendCost {
+    uint32_t conversions;
+    uint32_t transfers;
+    uint64_t cpuNs;
+    uint64_t busNs;
+    uint64_t irqOffNs;
+    uint64_t irqOffMaxNs;
+};
+
+static void measureBackend(bool rmt, BackendCost& cost) {
+    MockArduino::reset();
+    MockOneWire::reset();
+    MockOneWire::rmt = rmt;
+    MockOneWire::setTemperature(RAW_25C, 12);
+    DeadlineReader deadline(12);
+    runLoop(deadline);
+    TEST_ASSERT_EQUAL_FLOAT(25.5f, deadline.temperature);
+    cost = BackendCost{MockOneWire::conversions, MockOneWire::transfers, MockOneWire::cpuNs,
+                       MockOneWire::busNs, MockArduino::criticalTotalNs, MockArduino::criticalMaxNs};
+}
+
+void test_benchmark_bitbang_vs_rmt() {
+    BackendCost bitbang, rmt;
+    measureBackend(false, bitbang);
+    measureBackend(true, rmt);
+
+    // La CPU del RMT es un modelo (RMT_CALL_US por transferencia, estimado):
+    // en placa la mide OneWireRmt::getBlockedUs() en el log de cada ronda
+    printf("[BENCH] DS18B20 por ronda (conversión + lectura con CRC, 12 bits, modelo de tiempos):\n");
+    printf("  bit-banging: %5.0f us de bus, %5.0f us de CPU, %4.0f us con IRQ off (máx %.0f us)\n",
+           bitbang.busNs / 1e3 / bitbang.conversions, bitbang.cpuNs / 1e3 / bitbang.conversions,
+           bitbang.irqOffNs / 1e3 / bitbang.conversions, bitbang.irqOffMaxNs / 1e3);
+    printf("  RMT:         %5.0f us de bus, %5.0f us de CPU (modelo: %u transferencias x %u us estimados), "
+           "%4.0f us con IRQ off\n",
+           rmt.busNs / 1e3 / rmt.conversions, rmt.cpuNs / 1e3 / rmt.conversions,
+           rmt.transfers / rmt.conversions, MockOneWire::RMT_CALL_US,
+           rmt.irqOffNs / 1e3 / rmt.conversions);
+
+    TEST_ASSERT_EQUAL(bitbang.conversions, rmt.conversions);
+    TEST_ASSERT_EQUAL(bitbang.busNs, bitbang.cpuNs);  // Bit-banging: todo el bus es CPU
+    TEST_ASSERT_EQUAL(0, rmt.irqOffNs);
+    TEST_ASSERT_TRUE(rmt.cpuNs * 10 < bitbang.cpuNs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_conversion_time_matches_resolution);
+    RUN_TEST(test_no_bus_traffic_before_deadline);
+    RUN_TEST(test_reads_temperature_with_crc);
+    RUN_TEST(test_low_resolution_masks_undefined_bits);
+    RUN_TEST(test_detects_corrupt_scratchpad_and_missing_device);
+    RUN_TEST(test_without_crc_reads_only_temperature_bytes);
+    RUN_TEST(test_alarm_compares_truncated_reading);
+    RUN_TEST(test_update_config_skips_matching_sensor);
+    RUN_TEST(test_benchmark_loop_rate_9_bits);
+    RUN_TEST(test_benchmark_loop_rate_12_bits);
+    RUN_TEST(test_benchmark_bitbang_vs_rmt);
+
+    return UNITY_END();
+}
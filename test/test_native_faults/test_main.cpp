@@ -0,0 +1,171 @@
+#include <unity.h>
+#include "FaultMonitor.h"
+
+// ========================================
+// TESTS NATIVOS: DETECCIÓN DE FALLAS Y LATENCIA DE PEOR CASO
+// ========================================
+
+static constexpr uint32_t PERIOD_US = 100000;  // HX710B a 10 Hz
+static const int32_t RAW_EMPTY = PressureMath::rawThresholdForPascal(565);
+
+FaultMonitor monitor;
+uint32_t nowUs;
+
+void setUp(void) {
+    nowUs = 0;
+    monitor.reset(nowUs);
+}
+void tearDown(void) {}
+
+// Muestra sana: tanque vacío con algunas cuentas de ruido
+static void healthySample(uint32_t i) {
+    nowUs += PERIOD_US;
+    monitor.checkPressureSample(RAW_EMPTY + (int32_t)(i * 7 % 13), nowUs);
+    monitor.checkPressureTimeout(nowUs);
+}
+
+// Muestras hasta detectar la falla (0 si no se detecta en maxSamples)
+static uint32_t samplesUntilFault(int32_t raw, uint32_t maxSamples) {
+    for (uint32_t i = 1; i <= maxSamples; i++) {
+        nowUs += PERIOD_US;
+        monitor.checkPressureSample(raw, nowUs);
+        if (monitor.getFault() != Fault::NONE) return i;
+    }
+    return 0;
+}
+
+void test_healthy_signal_has_no_fault(void) {
+    for (uint32_t i = 0; i < 1000; i++) healthySample(i);
+    TEST_ASSERT_EQUAL(Fault::NONE, monitor.getFault());
+
+    // Un llenado rápido (~20 Pa/s) tampoco es un salto
+    for (uint32_t i = 0; i < 100; i++) {
+        nowUs += PERIOD_US;
+        monitor.checkPressureSample(RAW_EMPTY + PressureMath::rawFromPascalDelta(2 * i) + (i & 1), nowUs);
+    }
+    TEST_ASSERT_EQUAL(Fault::NONE, monitor.getFault());
+}
+
+void test_timeout_within_documented_latency(void) {
+    for (uint32_t i = 0; i < 10; i++) healthySample(i);
+    uint32_t lastSampleUs = nowUs;
+
+    // Ciclos de 20 ms sin muestras
+    while (monitor.getFault() == Fault::NONE) {
+        nowUs += 20000;
+        monitor.checkPressureTimeout(nowUs);
+    }
+    TEST_ASSERT_EQUAL(Fault::PRESSURE_TIMEOUT, monitor.getFault());
+    TEST_ASSERT_UINT32_WITHIN(20000, SensorConfig::FAULT_PRESSURE_TIMEOUT_MS * 1000,
+                              nowUs - lastSampleUs);
+}
+
+void test_saturation_after_range_samples(void) {
+    for (uint32_t i = 0; i < 10; i++) healthySample(i);
+    TEST_ASSERT_EQUAL(SensorConfig::FAULT_RANGE_SAMPLES, samplesUntilFault((1L << 23) - 1, 10));
+    TEST_ASSERT_EQUAL(Fault::PRESSURE_RANGE, monitor.getFault());
+
+    monitor.reset(nowUs);
+    TEST_ASSERT_EQUAL(SensorConfig::FAULT_RANGE_SAMPLES, samplesUntilFault(-(1L << 23), 10));
+    TEST_ASSERT_EQUAL(Fault::PRESSURE_RANGE, monitor.getFault());
+}
+
+void test_short_out_of_range_burst_is_ignored(void) {
+    // Ráfagas de FAULT_RANGE_SAMPLES - 1 muestras fuera de rango, espaciadas
+    for (uint32_t i = 0; i < 200; i++) {
+        if (i % 50 == 0) samplesUntilFault(PressureMath::rawThresholdForPascal(900),
+                                           SensorConfig::FAULT_RANGE_SAMPLES - 1);
+        else healthySample(i);
+    }
+    TEST_ASSERT_EQUAL(Fault::NONE, monitor.getFault());
+}
+
+void test_stuck_after_identical_samples(void) {
+    for (uint32_t i = 0; i < 10; i++) healthySample(i);
+    TEST_ASSERT_EQUAL(SensorConfig::FAULT_STUCK_SAMPLES, samplesUntilFault(RAW_EMPTY + 3, 100));
+    TEST_ASSERT_EQUAL(Fault::PRESSURE_STUCK, monitor.getFault());
+}
+
+void test_repeated_jumps_raise_rate_fault(void) {
+    for (uint32_t i = 0; i < 40; i++) healthySample(i);
+
+    // Contacto intermitente: +150 Pa una muestra sí y otra no (dentro de rango)
+    int32_t jump = PressureMath::rawFromPascalDelta(150);
+    uint32_t samples = 0;
+    for (uint32_t i = 0; i < 20 && monitor.getFault() == Fault::NONE; i++) {
+        nowUs += PERIOD_US;
+        monitor.checkPressureSample(RAW_EMPTY + ((i & 1) ? jump : 0) + (int32_t)i, nowUs);
+        samples++;
+    }
+    TEST_ASSERT_EQUAL(Fault::PRESSURE_RATE, monitor.getFault());
+    TEST_ASSERT_EQUAL(SensorConfig::FAULT_RATE_HITS + 1, samples);  // La primera no salta
+}
+
+void test_isolated_spike_is_ignored(void) {
+    int32_t spike = PressureMath::rawFromPascalDelta(150);
+    for (uint32_t i = 0; i < 200; i++) {
+        nowUs += PERIOD_US;
+        monitor.checkPressureSample(RAW_EMPTY + (i % 50 == 0 ? spike : 0) + (int32_t)(i & 3), nowUs);
+    }
+    TEST_ASSERT_EQUAL(Fault::NONE, monitor.getFault());
+}
+
+void test_temperature_invalid_rounds(void) {
+    monitor.checkTemperatureRound(true, 40.0);
+    for (uint8_t i = 1; i < SensorConfig::FAULT_TEMP_ROUNDS; i++) {
+        monitor.checkTemperatureRound(false, 0);
+        TEST_ASSERT_EQUAL(Fault::NONE, monitor.getFault());
+    }
+    monitor.checkTemperatureRound(false, 0);
+    TEST_ASSERT_EQUAL(Fault::TEMP_TIMEOUT, monitor.getFault());
+}
+
+void test_temperature_range_and_rate(void) {
+    monitor.checkTemperatureRound(true, 110.0);
+    TEST_ASSERT_EQUAL(Fault::NONE, monitor.getFault());
+    monitor.checkTemperatureRound(true, 110.0);
+    TEST_ASSERT_EQUAL(Fault::TEMP_RANGE, monitor.getFault());
+
+    // Lecturas que saltan 30 °C entre rondas
+    monitor.reset(nowUs);
+    uint8_t rounds = 0;
+    while (monitor.getFault() == Fault::NONE && rounds < 20) {
+        monitor.checkTemperatureRound(true, (rounds & 1) ? 60.0 : 30.0);
+        rounds++;
+    }
+    TEST_ASSERT_EQUAL(Fault::TEMP_RATE, monitor.getFault());
+    TEST_ASSERT_EQUAL(SensorConfig::FAULT_TEMP_RATE_HITS + 1, rounds);
+}
+
+void test_first_fault_is_latched_until_reset(void) {
+    for (uint32_t i = 0; i < 10; i++) healthySample(i);
+    samplesUntilFault((1L << 23) - 1, 10);
+    monitor.checkTemperatureRound(false, 0);
+    monitor.checkTemperatureRound(false, 0);
+    monitor.checkTemperatureRound(false, 0);
+    for (uint32_t i = 0; i < 10; i++) healthySample(i);
+    TEST_ASSERT_EQUAL(Fault::PRESSURE_RANGE, monitor.getFault());
+    TEST_ASSERT_EQUAL_STRING("E11 Presion fuera de rango", Fault::describe(monitor.getFault()));
+
+    monitor.reset(nowUs);
+    TEST_ASSERT_EQUAL(Fault::NONE, monitor.getFault());
+    for (uint32_t i = 0; i < 10; i++) healthySample(i);
+    TEST_ASSERT_EQUAL(Fault::NONE, monitor.getFault());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_healthy_signal_has_no_fault);
+    RUN_TEST(test_timeout_within_documented_latency);
+    RUN_TEST(test_saturation_after_range_samples);
+    RUN_TEST(test_short_out_of_range_burst_is_ignored);
+    RUN_TEST(test_stuck_after_identical_samples);
+    RUN_TEST(test_repeated_jumps_raise_rate_fault);
+    RUN_TEST(test_isolated_spike_is_ignored);
+    RUN_TEST(test_temperature_invalid_rounds);
+    RUN_TEST(test_temperature_range_and_rate);
+    RUN_TEST(test_first_fault_is_latched_until_reset);
+
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <HX710B.h>
+
+// ========================================
+// TESTS NATIVOS DEL HX710B (lectura y tiempo con interrupciones off)
+// ========================================
+
+static constexpr uint8_t DOUT_PIN = 5;
+static constexpr uint8_t SCK_PIN = 4;
+static constexpr int READS = 10;  // Una llamada a pascal() = 10 lecturas
+
+// Definido en HX710B.cpp
+uint8_t shiftInSlow(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder);
+
+HX710B sensor;
+
+void setUp(void) {
+    MockArduino::reset();
+    MockArduino::hxDoutPin = DOUT_PIN;
+    MockArduino::hxSckPin = SCK_PIN;
+    sensor.begin(DOUT_PIN, SCK_PIN);
+}
+
+void tearDown(void) {}
+
+// Secuencia original: 24 bits + 128 pulsos, todo dentro de la sección crítica
+static long legacyRead() {
+    uint8_t data[3];
+    MockArduino::enterCritical();
+    data[2] = shiftInSlow(DOUT_PIN, SCK_PIN, MSBFIRST);
+    data[1] = shiftInSlow(DOUT_PIN, SCK_PIN, MSBFIRST);
+    data[0] = shiftInSlow(DOUT_PIN, SCK_PIN, MSBFIRST);
+    for (unsigned int i = 0; i < 128; i++) {
+        digitalWrite(SCK_PIN, HIGH);
+        delayMicroseconds(1);
+        digitalWrite(SCK_PIN, LOW);
+        delayMicroseconds(1);
+    }
+    MockArduino::exitCritical();
+    long value = ((long)data[2] << 16) | ((long)data[1] << 8) | data[0];
+    return (data[2] & 0x80) ? (value | ~0xFFFFFFL) : value;
+}
+
+// ========================================
+// TESTS DE PROTOCOLO
+// ========================================
+
+void test_read_sign_extends_24_bits() {
+    // long es de 32 bits en el ESP32; en el host se trunca igual para comparar
+    MockArduino::hxValue = 0x800001;
+    TEST_ASSERT_EQUAL_INT32(-8388607, (int32_t)sensor.read());
+
+    MockArduino::reset();
+    MockArduino::hxValue = 0x123456;
+    TEST_ASSERT_EQUAL(0x123456L, sensor.read());
+}
+
+void test_mode_sets_total_pulses() {
+    const uint8_t modes[3] = {HX710B_DIFF_10HZ, HX710B_DVDD_40HZ, HX710B_DIFF_40HZ};
+    for (int i = 0; i < 3; i++) {
+        MockArduino::reset();
+        sensor.set_mode(modes[i]);
+        sensor.read();
+        TEST_ASSERT_EQUAL_UINT32(25 + i, MockArduino::hxSckPulses);
+    }
+}
+
+void test_invalid_mode_falls_back_to_10hz() {
+    sensor.set_mode(7);
+    TEST_ASSERT_EQUAL(HX710B_DIFF_10HZ, sensor.get_mode());
+}
+
+// ========================================
+// BENCHMARK: TIEMPO CON INTERRUPCIONES DESHABILITADAS
+// ========================================
+
+// Tiempo con interrupciones off de cada lectura (suma de sus secciones
+// críticas): promedio y máximo salen de las mismas READS muestras
+struct IrqOffTimes {
+    uint64_t totalNs;
+    uint64_t maxReadNs;
+    uint64_t maxSectionNs;  // Sección crítica más larga
+};
+
+template <typename ReadFn>
+static void measureReads(ReadFn readOnce, IrqOffTimes& times) {
+    MockArduino::reset();
+    MockArduino::hxValue = 0x0ABCDE;
+    times = {0, 0, 0};
+    for (int i = 0; i < READS; i++) {
+        MockArduino::hxBit = 0;
+        uint64_t before = MockArduino::criticalTotalNs;
+        TEST_ASSERT_EQUAL(0x0ABCDEL, readOnce());
+        uint64_t readNs = MockArduino::criticalTotalNs - before;
+        times.totalNs += readNs;
+        if (readNs > times.maxReadNs) times.maxReadNs = readNs;
+    }
+    times.maxSectionNs = MockArduino::criticalMaxNs;
+}
+
+void test_benchmark_interrupt_off_time() {
+    IrqOffTimes legacy, current;
+    measureReads([] { return legacyRead(); }, legacy);
+    measureReads([] { return sensor.read(); }, current);
+
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "IRQ off por lectura (prom/max): antes %.1f/%.1f us | ahora %.1f/%.1f us; "
+             "sección más larga: antes %.1f us | ahora %.1f us",
+             legacy.totalNs / 1000.0 / READS, legacy.maxReadNs / 1000.0,
+             current.totalNs / 1000.0 / READS, current.maxReadNs / 1000.0,
+             legacy.maxSectionNs / 1000.0, current.maxSectionNs / 1000.0);
+    TEST_MESSAGE(msg);
+
+    // La sección crítica más larga debe ser solo el desplazamiento de 24 bits
+    TEST_ASSERT_TRUE(current.maxSectionNs < legacy.maxSectionNs / 4);
+    TEST_ASSERT_TRUE(current.totalNs < legacy.totalNs / 4);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // Tests de protocolo
+    RUN_TEST(test_read_sign_extends_24_bits);
+    RUN_TEST(test_mode_sets_total_pulses);
+    RUN_TEST(test_invalid_mode_falls_back_to_10hz);
+
+    // Benchmark
+    RUN_TEST(test_benchmark_interrupt_off_time);
+
+    return UNITY_END();
+}
@@ -0,0 +1,330 @@
+#include <unity.h>
+#include "LevelCalibration.h"
+#include "PressureFilter.h"
+#include "FillRateEstimator.h"
+#include <math.h>
+
+// ========================================
+// TESTS NATIVOS: CALIBRACIÓN, FILTRO Y NIVEL
+// ========================================
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Tanque de referencia: 1000 cuentas por nivel, vacío en 10000
+static LevelCalibration linearCalibration() {
+    LevelCalibration cal;
+    for (uint16_t level = 0; level <= 400; level += 100) {
+        cal.addPoint(10000 + level * 10, level);
+    }
+    return cal;
+}
+
+void test_interpolates_between_points(void) {
+    LevelCalibration cal = linearCalibration();
+    TEST_ASSERT_TRUE(cal.isValid());
+    TEST_ASSERT_EQUAL_UINT16(0, cal.levelCentiFromRaw(10000));
+    TEST_ASSERT_EQUAL_UINT16(150, cal.levelCentiFromRaw(11500));
+    TEST_ASSERT_EQUAL_UINT16(399, cal.levelCentiFromRaw(13999));
+    TEST_ASSERT_EQUAL_UINT16(400, cal.levelCentiFromRaw(14000));
+
+    // Tramos de distinta pendiente
+    LevelCalibration bent;
+    bent.addPoint(0, 0);
+    bent.addPoint(1000, 100);
+    bent.addPoint(1500, 200);
+    TEST_ASSERT_EQUAL_UINT16(50, bent.levelCentiFromRaw(500));
+    TEST_ASSERT_EQUAL_UINT16(150, bent.levelCentiFromRaw(1250));
+}
+
+void test_extrapolates_with_end_segments(void) {
+    LevelCalibration cal;
+    cal.addPoint(11000, 100);
+    cal.addPoint(12000, 200);
+
+    // Por debajo del primer punto y por encima del último: tramo extremo
+    TEST_ASSERT_EQUAL_UINT16(50, cal.levelCentiFromRaw(10500));
+    TEST_ASSERT_EQUAL_UINT16(300, cal.levelCentiFromRaw(13000));
+
+    // Limitado a 0..MAX_LEVEL_CENTI
+    TEST_ASSERT_EQUAL_UINT16(0, cal.levelCentiFromRaw(5000));
+    TEST_ASSERT_EQUAL_UINT16(LevelCalibration::MAX_LEVEL_CENTI, cal.levelCentiFromRaw(20000));
+}
+
+void test_raw_for_level_is_inverse(void) {
+    LevelCalibration cal = linearCalibration();
+    for (uint16_t level = 0; level <= 400; level += 25) {
+        int32_t raw = cal.rawForLevelCenti(level);
+        TEST_ASSERT_EQUAL_UINT16(level, cal.levelCentiFromRaw(raw));
+        TEST_ASSERT_TRUE(cal.levelCentiFromRaw(raw - 1) < level || level == 0);
+    }
+}
+
+void test_insertion_keeps_order_and_rejects_non_monotonic(void) {
+    LevelCalibration cal;
+    TEST_ASSERT_TRUE(cal.addPoint(12000, 200));
+    TEST_ASSERT_TRUE(cal.addPoint(10000, 0));
+    TEST_ASSERT_TRUE(cal.addPoint(11000, 100));
+    TEST_ASSERT_EQUAL_UINT8(3, cal.size());
+    TEST_ASSERT_EQUAL_INT32(10000, cal.point(0).raw);
+    TEST_ASSERT_EQUAL_INT32(12000, cal.point(2).raw);
+
+    TEST_ASSERT_FALSE(cal.addPoint(11500, 50));   // Más cuentas, menos nivel
+    TEST_ASSERT_FALSE(cal.addPoint(11000, 150));  // Mismas cuentas que otro punto
+    TEST_ASSERT_EQUAL_UINT8(3, cal.size());
+}
+
+void test_replacing_a_level_keeps_neighbours(void) {
+    LevelCalibration cal = linearCalibration();
+    TEST_ASSERT_TRUE(cal.addPoint(12100, 200));
+    TEST_ASSERT_EQUAL_UINT8(5, cal.size());
+    TEST_ASSERT_EQUAL_INT32(12100, cal.point(2).raw);
+    TEST_ASSERT_EQUAL_UINT16(200, cal.point(2).levelCenti);
+    TEST_ASSERT_TRUE(cal.isValid());
+}
+
+void test_rejected_replace_keeps_previous_point(void) {
+    LevelCalibration cal = linearCalibration();
+
+    // Nueva captura del nivel 2.00 por encima del punto 3.00: se rechaza y
+    // el punto 2.00 anterior sigue ahí
+    TEST_ASSERT_FALSE(cal.addPoint(13500, 200));
+    TEST_ASSERT_FALSE(cal.addPoint(10500, 200));
+    TEST_ASSERT_EQUAL_UINT8(5, cal.size());
+    TEST_ASSERT_EQUAL_INT32(12000, cal.point(2).raw);
+    TEST_ASSERT_EQUAL_UINT16(200, cal.point(2).levelCenti);
+    TEST_ASSERT_EQUAL_UINT16(200, cal.levelCentiFromRaw(12000));
+}
+
+void test_full_table_still_accepts_replacements(void) {
+    LevelCalibration cal;
+    for (uint8_t i = 0; i < LevelCalibration::MAX_POINTS; i++) {
+        TEST_ASSERT_TRUE(cal.addPoint(10000 + i * 100, i * 25));
+    }
+    TEST_ASSERT_FALSE(cal.addPoint(20000, 399));  // Nivel nuevo: tabla llena
+    TEST_ASSERT_TRUE(cal.addPoint(10050, 25));    // Reemplazo: entra
+    TEST_ASSERT_EQUAL_UINT8(LevelCalibration::MAX_POINTS, cal.size());
+    TEST_ASSERT_EQUAL_INT32(10050, cal.point(1).raw);
+}
+
+void test_load_rejects_invalid_tables(void) {
+    const CalibrationPoint good[] = {{10000, 0}, {12000, 200}};
+    const CalibrationPoint bad[] = {{12000, 0}, {10000, 200}};
+    LevelCalibration cal = linearCalibration();
+
+    TEST_ASSERT_FALSE(cal.load(bad, 2));
+    TEST_ASSERT_EQUAL_UINT8(5, cal.size());  // Sin cambios
+    TEST_ASSERT_TRUE(cal.load(good, 2));
+    TEST_ASSERT_EQUAL_UINT16(100, cal.levelCentiFromRaw(11000));
+
+    LevelCalibration defaults = LevelCalibration::fromConfig();
+    TEST_ASSERT_TRUE(defaults.isValid());
+    PressureMath::LevelTable table;
+    TEST_ASSERT_TRUE(defaults.buildLevelTable(table));
+    for (uint8_t i = 0; i < PressureMath::LEVEL_COUNT; i++) {
+        TEST_ASSERT_EQUAL_INT32(PressureMath::DEFAULT_LEVEL_TABLE.raw[i], table.raw[i]);
+    }
+}
+
+// ========================================
+// Filtro de presión
+// ========================================
+
+void test_median_rejects_isolated_spike(void) {
+    MedianFilter<5> median;
+    for (int i = 0; i < 5; i++) median.add(1000);
+    TEST_ASSERT_EQUAL_INT32(1000, median.add(900000));  // Burbuja
+    TEST_ASSERT_EQUAL_INT32(1000, median.add(1000));
+    TEST_ASSERT_EQUAL_INT32(1000, median.add(-900000));
+}
+
+void test_filter_primes_after_median_and_ema_settle(void) {
+    PressureFilter filter;
+    TEST_ASSERT_FALSE(filter.hasValue());
+    TEST_ASSERT_FALSE(filter.isPrimed());
+
+    filter.add(50000);
+    TEST_ASSERT_TRUE(filter.hasValue());  // La EMA arranca en la primera muestra
+    for (uint16_t i = 1; i < PressureFilter::PRIME_SAMPLES; i++) {
+        TEST_ASSERT_FALSE(filter.isPrimed());
+        filter.add(50000);
+    }
+    TEST_ASSERT_TRUE(filter.isPrimed());
+    TEST_ASSERT_EQUAL_INT32(50000, filter.value());
+
+    filter.reset();
+    TEST_ASSERT_FALSE(filter.hasValue());
+    TEST_ASSERT_FALSE(filter.isPrimed());
+}
+
+void test_filter_step_response(void) {
+    static constexpr int32_t BASE = 40000;
+    static constexpr int32_t STEP = 8000;
+    PressureFilter filter;
+    for (uint16_t i = 0; i < PressureFilter::PRIME_SAMPLES; i++) filter.add(BASE);
+
+    // La mediana demora el escalón media ventana; después la EMA sube sin
+    // pasarse y en PRIME_SAMPLES muestras queda a menos del 5 %
+    int32_t previous = filter.value();
+    uint16_t delay = 0;
+    for (uint16_t i = 1; i <= PressureFilter::PRIME_SAMPLES; i++) {
+        int32_t value = filter.add(BASE + STEP);
+        TEST_ASSERT_TRUE(value >= previous);
+        TEST_ASSERT_TRUE(value <= BASE + STEP);
+        if (value == BASE) delay = i;
+        previous = value;
+    }
+    TEST_ASSERT_EQUAL_UINT16(SensorConfig::PRESSURE_MEDIAN_SIZE / 2, delay);
+    TEST_ASSERT_TRUE(BASE + STEP - previous < STEP / 20);
+}
+
+void test_level_hysteresis_band(void) {
+    const PressureMath::LevelTable& table = PressureMath::DEFAULT_LEVEL_TABLE;
+    LevelHysteresis hysteresis(100);
+
+    TEST_ASSERT_EQUAL_UINT8(0, hysteresis.update(table.raw[0] - 1, table));
+    TEST_ASSERT_EQUAL_UINT8(1, hysteresis.update(table.raw[0], table));
+
+    // Bajar exige caer más de una banda por debajo del umbral
+    TEST_ASSERT_EQUAL_UINT8(1, hysteresis.update(table.raw[0] - 100, table));
+    TEST_ASSERT_EQUAL_UINT8(0, hysteresis.update(table.raw[0] - 101, table));
+
+    // Un salto grande sube varios niveles de una vez
+    TEST_ASSERT_EQUAL_UINT8(4, hysteresis.update(table.raw[3] + 5, table));
+}
+
+// ========================================
+// Velocidad de llenado
+// ========================================
+
+static constexpr int32_t FILL_RATE = 5000;      // Cuentas/s
+static constexpr int32_t SLOSH_AMPLITUDE = 300; // Cuentas
+static constexpr uint32_t SLOSH_PERIOD_MS = 700;
+
+// Llenado (rate cuentas/s) con oleaje superpuesto
+static int32_t fillSample(uint32_t ms, int32_t rate) {
+    double slosh = SLOSH_AMPLITUDE * sin(2.0 * M_PI * ms / SLOSH_PERIOD_MS);
+    return 40000 + (int32_t)((int64_t)rate * ms / 1000) + (int32_t)lround(slosh);
+}
+
+void test_rate_of_clean_ramp(void) {
+    FillRateEstimator estimator;
+    for (uint32_t i = 0; i < FillRateEstimator::WINDOW; i++) {
+        estimator.add(40000 + FILL_RATE * (int32_t)i / 10, i * 100);
+    }
+    TEST_ASSERT_TRUE(estimator.isReady());
+    TEST_ASSERT_INT_WITHIN(1, FILL_RATE, estimator.getRate());
+
+    // 2500 cuentas a 5000 cuentas/s: medio segundo
+    TEST_ASSERT_UINT32_WITHIN(2, 500, estimator.msToReach(50000, 52500));
+    TEST_ASSERT_EQUAL_UINT32(0, estimator.msToReach(52500, 52500));
+}
+
+void test_not_ready_until_window_full(void) {
+    FillRateEstimator estimator;
+    for (uint32_t i = 0; i + 1 < FillRateEstimator::WINDOW; i++) {
+        estimator.add(40000 + FILL_RATE * (int32_t)i / 10, i * 100);
+    }
+    TEST_ASSERT_FALSE(estimator.isReady());
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, estimator.msToReach(40000, 50000));
+}
+
+void test_slosh_does_not_bias_rate(void) {
+    FillRateEstimator estimator;
+    int32_t worst = 0;
+    for (uint32_t ms = 0; ms < 20000; ms += 100) {
+        estimator.add(fillSample(ms, FILL_RATE), ms);
+        if (estimator.isReady()) {
+            int32_t error = abs(estimator.getRate() - FILL_RATE);
+            if (error > worst) worst = error;
+        }
+    }
+    // La regresión sobre ~2 periodos de oleaje promedia la oscilación
+    TEST_ASSERT_TRUE(worst < FILL_RATE / 5);
+}
+
+void test_slosh_without_fill_gives_no_estimate(void) {
+    FillRateEstimator estimator;
+    for (uint32_t ms = 0; ms < 20000; ms += 100) {
+        estimator.add(fillSample(ms, 0), ms);
+        if (estimator.isReady()) {
+            TEST_ASSERT_TRUE(estimator.getRate() < SensorConfig::FILL_MIN_RATE);
+            TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, estimator.msToReach(40000, 41000));
+        }
+    }
+}
+
+void test_rate_with_gaps_from_rejected_samples(void) {
+    // Durante la agitación solo llegan las muestras de las pausas del motor:
+    // marcas de tiempo irregulares, la pendiente sale igual
+    FillRateEstimator estimator;
+    uint32_t ms = 0;
+    for (uint32_t i = 0; i < 3 * FillRateEstimator::WINDOW; i++) {
+        ms += (i % 4 == 3) ? 1200 : 100;
+        estimator.add(40000 + (int32_t)((int64_t)FILL_RATE * ms / 1000), ms);
+    }
+    TEST_ASSERT_INT_WITHIN(1, FILL_RATE, estimator.getRate());
+}
+
+// Llenado simulado a un paso de nivel (1000 cuentas) por segundo con la
+// latencia real de la válvula; el corte usa la latencia estimada
+static void simulateFill(uint32_t estimatedMs, uint32_t actualMs, int32_t& finalRaw) {
+    const int32_t rate = 1000;
+    const int32_t targetRaw = 12000;  // Nivel 2 de linearCalibration()
+    const int32_t stepRaw = 1000;
+    const int32_t maxLead = stepRaw * SensorConfig::FILL_CUTOFF_MAX_LEAD_PCT / 100;
+    int32_t raw = 10000;
+    while (!FillRateEstimator::shouldCutOff(rate, raw, targetRaw, maxLead,
+                                            FillRateEstimator::clampLatency(estimatedMs))) {
+        raw += rate / 10;  // Muestras a 10 Hz
+    }
+    finalRaw = raw + (int32_t)((int64_t)rate * actualMs / 1000);
+}
+
+void test_predictive_cutoff_stays_within_one_level(void) {
+    // Latencias estimadas de todo el rango (y fuera de él) contra la real
+    const uint32_t estimates[] = {0, SensorConfig::FILL_LATENCY_DEFAULT_MS, 3000, 60000};
+    for (uint32_t estimatedMs : estimates) {
+        int32_t finalRaw;
+        simulateFill(estimatedMs, SensorConfig::FILL_LATENCY_DEFAULT_MS, finalRaw);
+        TEST_ASSERT_INT_WITHIN(1000, 12000, finalRaw);
+    }
+
+    // Nivel ya alcanzado: corta aunque no haya pendiente
+    TEST_ASSERT_TRUE(FillRateEstimator::shouldCutOff(0, 12000, 12000, 500, 0));
+    // Lejos del objetivo no corta por una latencia enorme
+    TEST_ASSERT_FALSE(FillRateEstimator::shouldCutOff(FILL_RATE, 10000, 12000, 500, UINT32_MAX));
+}
+
+void test_learned_latency_is_clamped(void) {
+    TEST_ASSERT_EQUAL_UINT16(SensorConfig::FILL_LATENCY_MIN_MS, FillRateEstimator::clampLatency(0));
+    TEST_ASSERT_EQUAL_UINT16(SensorConfig::FILL_LATENCY_MAX_MS, FillRateEstimator::clampLatency(70000));
+    TEST_ASSERT_EQUAL_UINT16(SensorConfig::FILL_LATENCY_DEFAULT_MS,
+                             FillRateEstimator::clampLatency(SensorConfig::FILL_LATENCY_DEFAULT_MS));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_interpolates_between_points);
+    RUN_TEST(test_extrapolates_with_end_segments);
+    RUN_TEST(test_raw_for_level_is_inverse);
+    RUN_TEST(test_insertion_keeps_order_and_rejects_non_monotonic);
+    RUN_TEST(test_replacing_a_level_keeps_neighbours);
+    RUN_TEST(test_rejected_replace_keeps_previous_point);
+    RUN_TEST(test_full_table_still_accepts_replacements);
+    RUN_TEST(test_load_rejects_invalid_tables);
+    RUN_TEST(test_median_rejects_isolated_spike);
+    RUN_TEST(test_filter_primes_after_median_and_ema_settle);
+    RUN_TEST(test_filter_step_response);
+    RUN_TEST(test_level_hysteresis_band);
+    RUN_TEST(test_rate_of_clean_ramp);
+    RUN_TEST(test_not_ready_until_window_full);
+    RUN_TEST(test_slosh_does_not_bias_rate);
+    RUN_TEST(test_slosh_without_fill_gives_no_estimate);
+    RUN_TEST(test_rate_with_gaps_from_rejected_samples);
+    RUN_TEST(test_predictive_cutoff_stays_within_one_level);
+    RUN_TEST(test_learned_latency_is_clamped);
+
+    return UNITY_END();
+}
@@ -0,0 +1,1346 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "NextionShadow.h"
+#include "NextionFrame.h"
+#include "NextionFormat.h"
+#include "NextionAckQueue.h"
+#include "NextionBaud.h"
+#include "NextionParser.h"
+#include "NextionQuery.h"
+
+// ========================================
+// TESTS NATIVOS: ESPEJO, TRAMAS, FORMATEO, CONFIRMACIONES, VELOCIDAD Y
+// RECEPCIÓN NEXTION
+// ========================================
+
+NextionShadow shadow;
+NextionFrame frame;
+NextionAckQueue acks;
+
+void setUp(void) {
+    shadow = NextionShadow();
+    shadow.setPage(NextionConfig::PAGE_EXECUTION);
+    acks.reset();
+}
+void tearDown(void) {}
+
+static bool send(const char* cmd) {
+    return shadow.shouldSend(cmd, strlen(cmd));
+}
+
+void test_unchanged_value_is_skipped(void) {
+    TEST_ASSERT_TRUE(send("temperatura.txt=\"40\""));
+    TEST_ASSERT_FALSE(send("temperatura.txt=\"40\""));
+    TEST_ASSERT_FALSE(send("temperatura.txt=\"40\""));
+
+    const NextionShadow::PageStats& stats = shadow.getStats(NextionConfig::PAGE_EXECUTION);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.sentCommands);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.skippedCommands);
+    TEST_ASSERT_EQUAL_UINT32(2 * (strlen("temperatura.txt=\"40\"") + 3), stats.savedBytes);
+}
+
+void test_changed_value_is_sent(void) {
+    TEST_ASSERT_TRUE(send("temperatura.txt=\"40\""));
+    TEST_ASSERT_TRUE(send("temperatura.txt=\"41\""));
+    TEST_ASSERT_FALSE(send("temperatura.txt=\"41\""));
+    TEST_ASSERT_TRUE(send("temperatura.txt=\"40\""));
+
+    // Mismo valor en otro atributo u otro componente es otra clave
+    TEST_ASSERT_TRUE(send("nivel.txt=\"40\""));
+    TEST_ASSERT_TRUE(send("temperatura.bco=40"));
+    TEST_ASSERT_EQUAL_UINT8(3, shadow.size());
+}
+
+void test_page_change_clears_shadow(void) {
+    TEST_ASSERT_TRUE(send("fase.txt=\"LAVADO\""));
+    TEST_ASSERT_FALSE(send("fase.txt=\"LAVADO\""));
+
+    shadow.setPage(NextionConfig::PAGE_SELECTION);
+    TEST_ASSERT_EQUAL_UINT8(0, shadow.size());
+    shadow.setPage(NextionConfig::PAGE_EXECUTION);
+    TEST_ASSERT_TRUE(send("fase.txt=\"LAVADO\""));
+
+    shadow.invalidate();
+    TEST_ASSERT_TRUE(send("fase.txt=\"LAVADO\""));
+}
+
+void test_touch_forgets_only_val_attributes(void) {
+    TEST_ASSERT_TRUE(send("bt0.val=1"));
+    TEST_ASSERT_TRUE(send("bt0.bco=2016"));
+    TEST_ASSERT_TRUE(send("tsw 24,1"));
+
+    shadow.invalidateTouchable();
+    TEST_ASSERT_TRUE(send("bt0.val=1"));
+    TEST_ASSERT_FALSE(send("bt0.bco=2016"));
+    TEST_ASSERT_FALSE(send("tsw 24,1"));
+}
+
+void test_commands_without_key_always_sent(void) {
+    TEST_ASSERT_TRUE(send("page 2"));
+    TEST_ASSERT_TRUE(send("page 2"));
+    TEST_ASSERT_TRUE(send("bkcmd=0"));
+    TEST_ASSERT_TRUE(send("bkcmd=0"));
+    TEST_ASSERT_TRUE(send("ref 0"));
+    TEST_ASSERT_TRUE(send("ref 0"));
+    TEST_ASSERT_EQUAL_UINT8(0, shadow.size());
+    TEST_ASSERT_EQUAL_UINT32(6, shadow.getStats(NextionConfig::PAGE_EXECUTION).sentCommands);
+}
+
+void test_tsw_and_vis_keys(void) {
+    TEST_ASSERT_TRUE(send("tsw 24,1"));
+    TEST_ASSERT_FALSE(send("tsw 24,1"));
+    TEST_ASSERT_TRUE(send("tsw 24,0"));
+    TEST_ASSERT_TRUE(send("tsw 25,0"));
+
+    TEST_ASSERT_TRUE(send("vis tiempo_ejec,1"));
+    TEST_ASSERT_FALSE(send("vis tiempo_ejec,1"));
+    TEST_ASSERT_TRUE(send("vis tiempo_ejec,0"));
+    TEST_ASSERT_EQUAL_UINT8(3, shadow.size());
+}
+
+void test_stats_are_kept_per_page(void) {
+    send("fase.txt=\"LLENADO\"");
+    send("fase.txt=\"LLENADO\"");
+
+    shadow.setPage(NextionConfig::PAGE_EDIT);
+    send("nivel.txt=\"2\"");
+    shadow.recordSent(strlen("page 5"));
+
+    const NextionShadow::PageStats& exec = shadow.getStats(NextionConfig::PAGE_EXECUTION);
+    const NextionShadow::PageStats& edit = shadow.getStats(NextionConfig::PAGE_EDIT);
+    TEST_ASSERT_EQUAL_UINT32(1, exec.sentCommands);
+    TEST_ASSERT_EQUAL_UINT32(1, exec.skippedCommands);
+    TEST_ASSERT_EQUAL_UINT32(2, edit.sentCommands);
+    TEST_ASSERT_EQUAL_UINT32(0, edit.skippedCommands);
+    TEST_ASSERT_EQUAL_UINT32(strlen("nivel.txt=\"2\"") + strlen("page 5") + 6, edit.sentBytes);
+}
+
+void test_full_shadow_still_sends(void) {
+    char cmd[32];
+    for (uint8_t i = 0; i < NextionShadow::MAX_ENTRIES + 4; i++) {
+        snprintf(cmd, sizeof(cmd), "t%u.txt=\"x\"", i);
+        TEST_ASSERT_TRUE(send(cmd));
+    }
+    TEST_ASSERT_EQUAL_UINT8(NextionShadow::MAX_ENTRIES, shadow.size());
+
+    // Los que no entraron se siguen enviando
+    snprintf(cmd, sizeof(cmd), "t%u.txt=\"x\"", NextionShadow::MAX_ENTRIES + 1);
+    TEST_ASSERT_TRUE(send(cmd));
+    TEST_ASSERT_FALSE(send("t0.txt=\"x\""));
+}
+
+// Página de edición: cada tecla reenviaba los 6 textos y las 4 tandas
+void test_edit_keypress_sends_only_changed_field(void) {
+    char cmd[48];
+    shadow.setPage(NextionConfig::PAGE_EDIT);
+
+    uint8_t values[6] = {2, 40, 30, 10, 3, 1};
+    const char* fields[6] = {"nivel", "temperatura", "tiempo", "rotacion", "centrifugado", "tanda"};
+    for (uint8_t key = 0; key < 10; key++) {
+        if (key > 0) values[key % 6]++;  // La tecla cambia un campo
+        for (uint8_t i = 0; i < 6; i++) {
+            snprintf(cmd, sizeof(cmd), "%s.txt=\"%u\"", fields[i], values[i]);
+            send(cmd);
+        }
+        for (uint8_t t = 0; t < 4; t++) {
+            snprintf(cmd, sizeof(cmd), "tsw %u,%u", 20 + t, t == values[5] % 4 ? 0 : 1);
+            send(cmd);
+            snprintf(cmd, sizeof(cmd), "tanda%u.bco=%u", t + 1, t == values[5] % 4 ? 2016 : 50712);
+            send(cmd);
+        }
+    }
+
+    const NextionShadow::PageStats& stats = shadow.getStats(NextionConfig::PAGE_EDIT);
+    // Primera pasada completa (14) y luego 1 campo por tecla, más las tandas de la tecla "tanda"
+    TEST_ASSERT_EQUAL_UINT32(10 * 14, stats.sentCommands + stats.skippedCommands);
+    TEST_ASSERT_LESS_THAN(14 + 9 * 5, stats.sentCommands);
+    TEST_ASSERT_GREATER_THAN(stats.sentBytes, stats.savedBytes);
+}
+
+// ========================================
+// Tramas
+// ========================================
+
+static bool add(const char* cmd) {
+    return frame.add(cmd, strlen(cmd));
+}
+
+// Texto de la trama con los terminadores como '|'
+static const char* frameText() {
+    static char text[NextionFrame::CAPACITY + 1];
+    for (size_t i = 0; i < frame.size(); i++) {
+        text[i] = frame.data()[i] == 0xFF ? '|' : (char)frame.data()[i];
+    }
+    text[frame.size()] = '\0';
+    return text;
+}
+
+void test_frame_packs_terminated_commands(void) {
+    frame.begin(false);
+    TEST_ASSERT_TRUE(add("t0.txt=\"a\""));
+    TEST_ASSERT_TRUE(add("n0.val=5"));
+    frame.finish();
+    TEST_ASSERT_EQUAL_STRING("t0.txt=\"a\"|||n0.val=5|||", frameText());
+    TEST_ASSERT_EQUAL_UINT16(2, frame.getCommands());
+}
+
+void test_atomic_frame_wraps_in_ref_stop_star(void) {
+    frame.begin(true);
+    TEST_ASSERT_TRUE(add("t0.txt=\"a\""));
+    TEST_ASSERT_TRUE(add("n0.val=5"));
+    frame.finish();
+    frame.finish();  // Idempotente
+    TEST_ASSERT_EQUAL_STRING("ref_stop|||t0.txt=\"a\"|||n0.val=5|||ref_star|||", frameText());
+}
+
+void test_empty_atomic_frame_sends_nothing(void) {
+    frame.begin(true);
+    frame.finish();
+    TEST_ASSERT_EQUAL(0, frame.size());
+}
+
+void test_full_frame_drains_and_keeps_ref_star(void) {
+    char cmd[32];
+    size_t written = 0;
+    uint16_t added = 0;
+    frame.begin(true);
+
+    for (uint16_t i = 0; i < 100; i++) {
+        snprintf(cmd, sizeof(cmd), "t%u.txt=\"valor\"", i);
+        if (!add(cmd)) {
+            // Siempre queda lugar para el ref_star
+            TEST_ASSERT_LESS_OR_EQUAL(NextionFrame::CAPACITY - 11, frame.size());
+            written += frame.size();
+            frame.drain();
+            TEST_ASSERT_TRUE(add(cmd));
+        }
+        added++;
+    }
+    frame.finish();
+    written += frame.size();
+
+    // Un solo ref_stop al comienzo y un solo ref_star al final
+    const char* tail = frameText();
+    TEST_ASSERT_EQUAL_STRING("ref_star|||", tail + strlen(tail) - 11);
+    TEST_ASSERT_TRUE(strstr(tail, "ref_stop") == NULL);
+
+    size_t expected = 11 + 11;
+    for (uint16_t i = 0; i < added; i++) {
+        expected += snprintf(cmd, sizeof(cmd), "t%u.txt=\"valor\"", i) + 3;
+    }
+    TEST_ASSERT_EQUAL(expected, written);
+}
+
+// Página de ejecución completa: una escritura en lugar de 4 por comando
+void test_execution_page_fits_one_frame(void) {
+    const char* page[] = {
+        "progr_ejec.txt=\"P22\"", "fase_ejec.txt=\"Centrifugado\"", "tanda_ejec.txt=\"4\"",
+        "tiempo_ejec.txt=\"59:59\"", "tiempo_total.txt=\"99:59\"", "temp_ejec.txt=\"100.0 C\"",
+        "nivel_ejec.txt=\"4.0\"", "barra_nivel.val=100", "barra_temp.val=100",
+        "centrif_ejec.txt=\"Si\"", "agua_ejec.txt=\"Caliente\"", "vis tiempo_ejec,1"
+    };
+    frame.begin(true);
+    for (const char* cmd : page) {
+        TEST_ASSERT_TRUE(add(cmd));
+    }
+    frame.finish();
+    TEST_ASSERT_LESS_OR_EQUAL(NextionFrame::CAPACITY, frame.size());
+    TEST_ASSERT_EQUAL_UINT16(12, frame.getCommands());
+}
+
+// ========================================
+// Formateo sin snprintf
+// ========================================
+
+using namespace NextionFormat;
+
+static char text[64];
+
+static Writer writer() {
+    return Writer(text, sizeof(text));
+}
+
+void test_prefixes_are_built_at_compile_time(void) {
+    static constexpr auto TXT_FASE = txt("fase_ejec");
+    static constexpr auto VAL_BARRA = val("barra_nivel");
+    static_assert(TXT_FASE.length == 15, "fase_ejec.txt=\" tiene 15 caracteres");
+    static_assert(TXT_FASE.text[14] == '"' && VAL_BARRA.text[VAL_BARRA.length - 1] == '=',
+                  "Prefijos armados en compilación");
+
+    TEST_ASSERT_EQUAL_STRING("fase_ejec.txt=\"", TXT_FASE.text);
+    TEST_ASSERT_EQUAL_STRING("barra_nivel.val=", VAL_BARRA.text);
+    TEST_ASSERT_EQUAL_STRING("tanda1.bco=", bco("tanda1").text);
+}
+
+void test_integer_writers(void) {
+    TEST_ASSERT_EQUAL_STRING("0", writer().number(0).c_str());
+    TEST_ASSERT_EQUAL_STRING("4294967295", writer().number(4294967295u).c_str());
+    TEST_ASSERT_EQUAL_STRING("-2147483648", writer().integer(INT32_MIN).c_str());
+    TEST_ASSERT_EQUAL_STRING("P22", writer().put('P').number(22).c_str());
+}
+
+void test_fixed_point_and_time_writers(void) {
+    TEST_ASSERT_EQUAL_STRING("40.5", writer().fixed(405, 1).c_str());
+    TEST_ASSERT_EQUAL_STRING("-0.5", writer().fixed(-5, 1).c_str());
+    TEST_ASSERT_EQUAL_STRING("2.07", writer().fixed(207, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("0.00", writer().fixed(0, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("7", writer().fixed(7, 0).c_str());
+
+    TEST_ASSERT_EQUAL_STRING("00:00", writer().mmss(0).c_str());
+    TEST_ASSERT_EQUAL_STRING("01:05", writer().mmss(65).c_str());
+    TEST_ASSERT_EQUAL_STRING("99:59", writer().mmss(5999).c_str());
+    TEST_ASSERT_EQUAL_STRING("100:00", writer().mmss(6000).c_str());
+}
+
+// Mismo texto que los snprintf reemplazados
+void test_writers_match_snprintf(void) {
+    char expected[32];
+    for (uint32_t s = 0; s < 65536; s += 7) {
+        snprintf(expected, sizeof(expected), "%02d:%02d", (int)(s / 60), (int)(s % 60));
+        TEST_ASSERT_EQUAL_STRING(expected, writer().mmss(s).c_str());
+    }
+    for (uint32_t centi = 0; centi < 65536; centi += 3) {
+        snprintf(expected, sizeof(expected), "%u.%u", centi / 100, (centi % 100) / 10);
+        TEST_ASSERT_EQUAL_STRING(expected, writer().fixed(centi / 10, 1).c_str());
+        snprintf(expected, sizeof(expected), "%u.%02u", centi / 100, centi % 100);
+        TEST_ASSERT_EQUAL_STRING(expected, writer().fixed(centi, 2).c_str());
+    }
+
+    // Temperatura: pasos del DS18B20 (1/16 °C, mitades exactas) y valores arbitrarios
+    for (int32_t sixteenths = -55 * 16; sixteenths <= 125 * 16; sixteenths++) {
+        float t = sixteenths / 16.0f;
+        snprintf(expected, sizeof(expected), "%.1f C", t);
+        TEST_ASSERT_EQUAL_STRING(expected, writer().fixed((int32_t)lrint(t * 10.0), 1).text(" C").c_str());
+    }
+    for (float t = -20.0f; t < 120.0f; t += 0.013f) {
+        snprintf(expected, sizeof(expected), "%.1f C", t);
+        if (strcmp(expected, "-0.0 C") == 0) continue;  // El escritor da "0.0 C"
+        TEST_ASSERT_EQUAL_STRING(expected, writer().fixed((int32_t)lrint(t * 10.0), 1).text(" C").c_str());
+    }
+}
+
+void test_writer_flags_overflow(void) {
+    char small[4];
+    Writer w(small, sizeof(small));
+    w.number(12345);
+    TEST_ASSERT_TRUE(w.overflowed());
+    TEST_ASSERT_EQUAL(4, w.size());
+    TEST_ASSERT_EQUAL_STRING("123", w.c_str());
+}
+
+void test_reserved_command_only_kept_on_commit(void) {
+    frame.begin(true);
+    Writer w(frame.reserve(32), 32);
+    w.prefix(val("n0")).number(5);
+    frame.finish();
+    TEST_ASSERT_EQUAL(0, frame.size());  // Descartado (espejo): ni ref_stop
+
+    frame.begin(true);
+    w = Writer(frame.reserve(32), 32);
+    w.prefix(val("n0")).number(5);
+    frame.commit(w.size());
+    frame.finish();
+    TEST_ASSERT_EQUAL_STRING("ref_stop|||n0.val=5|||ref_star|||", frameText());
+}
+
+// ========================================
+// BENCHMARK: ACTUALIZACIÓN DE LA PÁGINA DE EJECUCIÓN
+// ========================================
+
+struct ExecutionValues {
+    uint8_t program;
+    const char* phase;
+    uint8_t process;
+    uint16_t phaseTime;
+    uint16_t totalTime;
+    float temperature;
+    uint16_t levelCenti;
+};
+
+static ExecutionValues executionValues(uint32_t i) {
+    return {22, "Lavado", (uint8_t)(i % 4), (uint16_t)(i % 3600), 3600,
+            20.0f + (i % 1280) / 16.0f, (uint16_t)(i % 400)};
+}
+
+// Camino anterior: snprintf del valor y snprintf del comando
+static void legacyText(const char* component, const char* value) {
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "%s.txt=\"%s\"", component, value);
+    frame.add(cmd, strlen(cmd));
+}
+
+static void legacyNumber(const char* component, uint32_t value) {
+    char cmd[64];
+    snprintf(cmd, sizeof(cmd), "%s.val=%lu", component, (unsigned long)value);
+    frame.add(cmd, strlen(cmd));
+}
+
+static void legacyUpdate(const ExecutionValues& v) {
+    char buffer[32];
+    frame.begin(true);
+    snprintf(buffer, sizeof(buffer), "P%d", v.program);
+    legacyText("progr_ejec", buffer);
+    legacyText("fase_ejec", v.phase);
+    snprintf(buffer, sizeof(buffer), "%d", v.process + 1);
+    legacyText("tanda_ejec", buffer);
+    snprintf(buffer, sizeof(buffer), "%02d:%02d", v.phaseTime / 60, v.phaseTime % 60);
+    legacyText("tiempo_ejec", buffer);
+    snprintf(buffer, sizeof(buffer), "%02d:%02d", v.totalTime / 60, v.totalTime % 60);
+    legacyText("tiempo_total", buffer);
+    snprintf(buffer, sizeof(buffer), "%.1f C", v.temperature);
+    legacyText("temp_ejec", buffer);
+    snprintf(buffer, sizeof(buffer), "%u.%u", v.levelCenti / 100, (v.levelCenti % 100) / 10);
+    legacyText("nivel_ejec", buffer);
+    legacyNumber("barra_nivel", v.levelCenti / 4);
+    legacyNumber("barra_temp", (uint32_t)v.temperature);
+    legacyText("centrif_ejec", "Si");
+    legacyText("agua_ejec", "Caliente");
+    frame.finish();
+}
+
+// Camino nuevo: prefijos constexpr y escritura directa en la trama
+static Writer benchWriter;
+
+static Writer& beginValue() {
+    benchWriter = Writer(frame.reserve(NextionConfig::MAX_COMMAND_LEN), NextionConfig::MAX_COMMAND_LEN);
+    return benchWriter;
+}
+
+static void endValue() {
+    frame.commit(benchWriter.size());
+}
+
+static void writerUpdate(const ExecutionValues& v) {
+    static constexpr auto TXT_PROGR = txt("progr_ejec");
+    static constexpr auto TXT_FASE = txt("fase_ejec");
+    static constexpr auto TXT_TANDA = txt("tanda_ejec");
+    static constexpr auto TXT_TIEMPO = txt("tiempo_ejec");
+    static constexpr auto TXT_TOTAL = txt("tiempo_total");
+    static constexpr auto TXT_TEMP = txt("temp_ejec");
+    static constexpr auto TXT_NIVEL = txt("nivel_ejec");
+    static constexpr auto VAL_NIVEL = val("barra_nivel");
+    static constexpr auto VAL_TEMP = val("barra_temp");
+    static constexpr auto TXT_CENTRIF = txt("centrif_ejec");
+    static constexpr auto TXT_AGUA = txt("agua_ejec");
+
+    frame.begin(true);
+    beginValue().prefix(TXT_PROGR).put('P').number(v.program).quote(); endValue();
+    beginValue().prefix(TXT_FASE).text(v.phase).quote(); endValue();
+    beginValue().prefix(TXT_TANDA).number(v.process + 1).quote(); endValue();
+    beginValue().prefix(TXT_TIEMPO).mmss(v.phaseTime).quote(); endValue();
+    beginValue().prefix(TXT_TOTAL).mmss(v.totalTime).quote(); endValue();
+    beginValue().prefix(TXT_TEMP).fixed((int32_t)lrint(v.temperature * 10.0), 1).text(" C").quote(); endValue();
+    beginValue().prefix(TXT_NIVEL).fixed(v.levelCenti / 10, 1).quote(); endValue();
+    beginValue().prefix(VAL_NIVEL).number(v.levelCenti / 4); endValue();
+    beginValue().prefix(VAL_TEMP).number((uint32_t)v.temperature); endValue();
+    beginValue().prefix(TXT_CENTRIF).text("Si").quote(); endValue();
+    beginValue().prefix(TXT_AGUA).text("Caliente").quote(); endValue();
+    frame.finish();
+}
+
+void test_benchmark_execution_update(void) {
+    static constexpr uint32_t UPDATES = 20000;
+    static uint8_t legacyBytes[NextionFrame::CAPACITY];
+
+    // Mismos bytes por los dos caminos
+    for (uint32_t i = 0; i < 2000; i += 13) {
+        legacyUpdate(executionValues(i));
+        size_t legacySize = frame.size();
+        memcpy(legacyBytes, frame.data(), legacySize);
+        writerUpdate(executionValues(i));
+        TEST_ASSERT_EQUAL(legacySize, frame.size());
+        TEST_ASSERT_EQUAL_MEMORY(legacyBytes, frame.data(), legacySize);
+    }
+
+    uint32_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < UPDATES; i++) {
+        legacyUpdate(executionValues(i));
+        checksum += frame.size();
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < UPDATES; i++) {
+        writerUpdate(executionValues(i));
+        checksum -= frame.size();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double legacyNs = std::chrono::duration<double, std::nano>(middle - start).count() / UPDATES;
+    double writerNs = std::chrono::duration<double, std::nano>(end - middle).count() / UPDATES;
+    printf("[BENCH] Página de ejecución (11 comandos, trama atómica), %u actualizaciones:\n", UPDATES);
+    printf("  snprintf + copia a la trama:      %7.0f ns por actualización\n", legacyNs);
+    printf("  prefijos constexpr + en la trama: %7.0f ns por actualización (x%.1f)\n",
+           writerNs, legacyNs / writerNs);
+
+    TEST_ASSERT_EQUAL_UINT32(0, checksum);
+    TEST_ASSERT_TRUE(writerNs < legacyNs);
+}
+
+// ========================================
+// Confirmaciones (bkcmd=3)
+// ========================================
+
+static bool ack(const char* cmd, uint32_t nowUs) {
+    return acks.trackAcked(cmd, strlen(cmd), nowUs);
+}
+
+void test_plain_frames_are_matched_in_order(void) {
+    acks.trackPlain(3, 0);
+    acks.trackPlain(2, 1000);
+    TEST_ASSERT_EQUAL_UINT8(2, acks.pendingWrites());
+
+    acks.onReturn(NextionReturn::SUCCESS, 2000);
+    acks.onReturn(NextionReturn::SUCCESS, 2100);
+    TEST_ASSERT_FALSE(acks.onReturn(NextionReturn::INVALID_VARIABLE, 2200));  // Permanente
+    TEST_ASSERT_EQUAL_UINT8(1, acks.pendingWrites());
+    acks.onReturn(NextionReturn::SUCCESS, 3000);
+    TEST_ASSERT_TRUE(acks.onReturn(NextionReturn::BUFFER_OVERFLOW, 3500));    // Transitorio
+    TEST_ASSERT_FALSE(acks.hasPending());
+
+    // Una muestra por escritura, hasta la respuesta a su último comando
+    TEST_ASSERT_EQUAL_UINT32(2, acks.getLatency().count());
+    TEST_ASSERT_EQUAL_UINT32(2500, acks.getLatency().max());
+    TEST_ASSERT_EQUAL_UINT32(2, acks.getStats().plainErrors);
+    TEST_ASSERT_EQUAL_UINT32(0, acks.getStats().acked);
+}
+
+void test_acked_command_between_plain_frames(void) {
+    acks.trackPlain(2, 0);
+    TEST_ASSERT_TRUE(ack("page 2", 100));
+    acks.trackPlain(1, 200);
+
+    acks.onReturn(NextionReturn::SUCCESS, 1000);
+    acks.onReturn(NextionReturn::SUCCESS, 1100);
+    TEST_ASSERT_EQUAL_UINT32(0, acks.getStats().acked);
+    acks.onReturn(NextionReturn::SUCCESS, 1600);
+    TEST_ASSERT_EQUAL_UINT32(1, acks.getStats().acked);
+    acks.onReturn(NextionReturn::SUCCESS, 1700);
+
+    TEST_ASSERT_FALSE(acks.hasPending());
+    TEST_ASSERT_EQUAL_UINT32(3, acks.getLatency().count());
+    TEST_ASSERT_EQUAL_UINT32(0, acks.getStats().unexpected);
+    acks.onReturn(NextionReturn::SUCCESS, 1800);
+    TEST_ASSERT_EQUAL_UINT32(1, acks.getStats().unexpected);
+}
+
+void test_permanent_error_drops_without_retry(void) {
+    TEST_ASSERT_TRUE(ack("boton.txt=\"x\"", 0));
+    TEST_ASSERT_FALSE(acks.onReturn(NextionReturn::INVALID_VARIABLE, 500));
+
+    const char* cmd;
+    size_t len;
+    uint8_t slot;
+    TEST_ASSERT_FALSE(acks.nextRetry(cmd, len, slot));
+    TEST_ASSERT_EQUAL_UINT32(1, acks.getStats().dropped);
+    TEST_ASSERT_EQUAL_UINT8(NextionReturn::INVALID_VARIABLE, acks.getStats().lastError);
+}
+
+void test_buffer_overflow_is_retried(void) {
+    const char* cmd;
+    size_t len;
+    uint8_t slot;
+    TEST_ASSERT_TRUE(ack("page 2", 0));
+
+    // Reintentos hasta ACK_MAX_RETRIES; el último error descarta y avisa
+    for (uint8_t attempt = 0; attempt < NextionConfig::ACK_MAX_RETRIES; attempt++) {
+        TEST_ASSERT_FALSE(acks.onReturn(NextionReturn::BUFFER_OVERFLOW, 1000));
+        TEST_ASSERT_TRUE(acks.nextRetry(cmd, len, slot));
+        TEST_ASSERT_EQUAL(6, len);
+        TEST_ASSERT_EQUAL_MEMORY("page 2", cmd, len);
+        acks.trackResent(slot, 2000);
+        TEST_ASSERT_FALSE(acks.nextRetry(cmd, len, slot));
+    }
+    TEST_ASSERT_TRUE(acks.onReturn(NextionReturn::BUFFER_OVERFLOW, 3000));
+    TEST_ASSERT_FALSE(acks.nextRetry(cmd, len, slot));
+
+    const NextionAckQueue::Stats& stats = acks.getStats();
+    TEST_ASSERT_EQUAL_UINT32(NextionConfig::ACK_MAX_RETRIES, stats.retries);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.dropped);
+
+    // Con éxito en el reintento se confirma
+    TEST_ASSERT_TRUE(ack("page 3", 4000));
+    acks.onReturn(NextionReturn::BUFFER_OVERFLOW, 4500);
+    TEST_ASSERT_TRUE(acks.nextRetry(cmd, len, slot));
+    acks.trackResent(slot, 5000);
+    acks.onReturn(NextionReturn::SUCCESS, 5800);
+    TEST_ASSERT_EQUAL_UINT32(1, acks.getStats().acked);
+    TEST_ASSERT_EQUAL_UINT32(800, acks.getLatency().max());
+}
+
+void test_newer_command_supersedes_retry(void) {
+    const char* cmd;
+    size_t len;
+    uint8_t slot;
+
+    // "page 2" falla con "page 4" ya enviado: no se vuelve a la página vieja
+    TEST_ASSERT_TRUE(ack("page 2", 0));
+    TEST_ASSERT_TRUE(ack("page 4", 100));
+    acks.onReturn(NextionReturn::BUFFER_OVERFLOW, 500);
+    TEST_ASSERT_FALSE(acks.nextRetry(cmd, len, slot));
+    acks.onReturn(NextionReturn::SUCCESS, 600);
+
+    // Reintento pendiente y llega un valor nuevo del mismo atributo
+    TEST_ASSERT_TRUE(ack("mensaje.txt=\"A\"", 1000));
+    acks.onReturn(NextionReturn::BUFFER_OVERFLOW, 1500);
+    TEST_ASSERT_TRUE(ack("mensaje.txt=\"B\"", 1600));
+    TEST_ASSERT_FALSE(acks.nextRetry(cmd, len, slot));
+
+    // Otro atributo no se reemplaza
+    TEST_ASSERT_TRUE(ack("t0.txt=\"A\"", 2000));
+    acks.onReturn(NextionReturn::SUCCESS, 2100);                  // mensaje "B"
+    acks.onReturn(NextionReturn::BUFFER_OVERFLOW, 2200);          // t0 "A"
+    TEST_ASSERT_TRUE(ack("t1.txt=\"A\"", 2300));
+    TEST_ASSERT_TRUE(acks.nextRetry(cmd, len, slot));
+    TEST_ASSERT_EQUAL_MEMORY("t0.txt=\"A\"", cmd, len);
+    TEST_ASSERT_EQUAL_UINT32(2, acks.getStats().dropped);
+}
+
+void test_timeout_resynchronizes(void) {
+    const char* cmd;
+    size_t len;
+    uint8_t slot;
+    acks.trackPlain(4, 0);
+    TEST_ASSERT_TRUE(ack("page 2", 0));
+    acks.onReturn(NextionReturn::SUCCESS, 1000);
+
+    TEST_ASSERT_FALSE(acks.checkTimeout(1000 + NextionConfig::ACK_TIMEOUT_US - 1));
+    TEST_ASSERT_TRUE(acks.checkTimeout(1000 + NextionConfig::ACK_TIMEOUT_US));
+    TEST_ASSERT_FALSE(acks.hasPending());
+    TEST_ASSERT_EQUAL_UINT32(1, acks.getStats().timeouts);
+    TEST_ASSERT_TRUE(acks.nextRetry(cmd, len, slot));
+
+    // Sin nada pendiente no hay timeout
+    acks.trackResent(slot, 400000);
+    acks.onReturn(NextionReturn::SUCCESS, 401000);
+    TEST_ASSERT_FALSE(acks.checkTimeout(10000000));
+}
+
+void test_full_queue_rejects_acked(void) {
+    char cmd[16];
+    for (uint8_t i = 0; i < NextionAckQueue::CAPACITY; i++) {
+        snprintf(cmd, sizeof(cmd), "page %u", i);
+        TEST_ASSERT_TRUE(acks.canTrackAcked());
+        TEST_ASSERT_TRUE(ack(cmd, 0));
+    }
+    TEST_ASSERT_FALSE(acks.canTrackAcked());
+    TEST_ASSERT_FALSE(ack("page 6", 0));
+    TEST_ASSERT_EQUAL_UINT32(1, acks.getStats().rejected);
+
+    // Comandos sin confirmación siguen saliendo y se cuentan
+    for (uint8_t i = 0; i < 40; i++) acks.trackPlain(2, 0);
+    TEST_ASSERT_EQUAL_UINT8(NextionAckQueue::RING_SIZE, acks.pendingWrites());
+    for (uint8_t i = 0; i < NextionAckQueue::CAPACITY; i++) acks.onReturn(NextionReturn::SUCCESS, 100);
+    for (uint8_t i = 0; i < 80; i++) acks.onReturn(NextionReturn::SUCCESS, 200);
+    TEST_ASSERT_FALSE(acks.hasPending());
+    TEST_ASSERT_EQUAL_UINT32(0, acks.getStats().unexpected);
+}
+
+void test_plain_frames_wait_for_room_behind_acked(void) {
+    const char* cmd;
+    size_t len;
+    uint8_t slot;
+
+    // Anillo lleno con un confirmado al final
+    for (uint8_t i = 0; i < NextionAckQueue::RING_SIZE - 1; i++) acks.trackPlain(1, 0);
+    TEST_ASSERT_TRUE(ack("page 2", 0));
+    TEST_ASSERT_EQUAL_UINT8(NextionAckQueue::RING_SIZE, acks.pendingWrites());
+
+    // La trama no entra: se cuenta y entra al liberarse el primer lugar
+    acks.trackPlain(2, 100);
+    TEST_ASSERT_EQUAL_UINT32(1, acks.getStats().deferred);
+    acks.onReturn(NextionReturn::SUCCESS, 200);
+    TEST_ASSERT_EQUAL_UINT8(NextionAckQueue::RING_SIZE, acks.pendingWrites());
+
+    // Un confirmado posterior queda detrás de sus respuestas
+    TEST_ASSERT_FALSE(acks.canTrackAcked());
+    acks.onReturn(NextionReturn::SUCCESS, 250);
+    TEST_ASSERT_TRUE(ack("t0.txt=\"A\"", 300));
+    for (uint8_t i = 0; i < NextionAckQueue::RING_SIZE - 3; i++) acks.onReturn(NextionReturn::SUCCESS, 400);
+    acks.onReturn(NextionReturn::SUCCESS, 500);                   // page 2
+    TEST_ASSERT_EQUAL_UINT32(1, acks.getStats().acked);
+    acks.onReturn(NextionReturn::SUCCESS, 600);                   // Trama diferida
+    acks.onReturn(NextionReturn::SUCCESS, 600);
+    TEST_ASSERT_EQUAL_UINT32(1, acks.getStats().acked);
+    acks.onReturn(NextionReturn::BUFFER_OVERFLOW, 700);           // t0 "A"
+    TEST_ASSERT_TRUE(acks.nextRetry(cmd, len, slot));
+    TEST_ASSERT_EQUAL_MEMORY("t0.txt=\"A\"", cmd, len);
+
+    TEST_ASSERT_FALSE(acks.hasPending());
+    TEST_ASSERT_EQUAL_UINT32(0, acks.getStats().unexpected);
+    TEST_ASSERT_EQUAL_UINT32(0, acks.getStats().plainErrors);
+}
+
+void test_latency_percentiles(void) {
+    LatencyHistogram histogram;
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.percentileUs(50));
+
+    for (uint32_t i = 1; i <= 100; i++) histogram.add(i * 100);  // 0.1 .. 10 ms
+    TEST_ASSERT_UINT32_WITHIN(LatencyHistogram::WIDTH_US, 5000, histogram.percentileUs(50));
+    TEST_ASSERT_UINT32_WITHIN(LatencyHistogram::WIDTH_US, 9000, histogram.percentileUs(90));
+    TEST_ASSERT_UINT32_WITHIN(LatencyHistogram::WIDTH_US, 9900, histogram.percentileUs(99));
+    TEST_ASSERT_EQUAL_UINT32(10000, histogram.percentileUs(100));
+
+    // Fuera del rango del histograma: el máximo exacto
+    histogram.add(50000);
+    TEST_ASSERT_EQUAL_UINT32(50000, histogram.percentileUs(100));
+    TEST_ASSERT_EQUAL_UINT32(50000, histogram.max());
+}
+
+// ========================================
+// Negociación de velocidad
+// ========================================
+
+// Panel y cableado simulados: hasta maxReliable todo llega; por encima llega
+// una transferencia de cada dos (ningún sondeo triple pasa); deadBaud nada
+struct FakePanel {
+    uint32_t panelBaud = NextionConfig::BAUD_RATE;
+    uint32_t espBaud = 0;
+    uint32_t maxReliable = 921600;
+    uint32_t deadBaud = 0;
+    bool present = true;
+    uint32_t probes = 0;
+    uint32_t baudCommands = 0;
+    uint32_t transfers = 0;
+    uint32_t highest = 0;  // Velocidad más alta pedida al panel
+
+    // Para LinkRecovery: la respuesta a "get" llega como bytes
+    uint8_t reply[8] = {};
+    uint8_t replyLength = 0;
+    uint32_t baudChanges = 0;
+    uint32_t writes = 0;
+
+    void setBaud(uint32_t baud) {
+        espBaud = baud;
+        baudChanges++;
+    }
+
+    bool transfer() {
+        if (!present || espBaud != panelBaud || espBaud == deadBaud) return false;
+        if (espBaud <= maxReliable) return true;
+        return (transfers++ % 2) == 1;
+    }
+
+    void sendCommand(const char* cmd) {
+        writes++;
+        bool delivered = transfer();
+        if (strncmp(cmd, "get ", 4) == 0) {
+            probes++;
+            if (delivered) {
+                uint32_t nonce = (uint32_t)strtoul(cmd + 4, nullptr, 10);
+                const uint8_t bytes[8] = {0x71, (uint8_t)nonce, (uint8_t)(nonce >> 8), (uint8_t)(nonce >> 16),
+                                          (uint8_t)(nonce >> 24), 0xFF, 0xFF, 0xFF};
+                memcpy(reply, bytes, sizeof(reply));
+                replyLength = sizeof(reply);
+            }
+            return;
+        }
+        if (strncmp(cmd, "baud=", 5) != 0) return;
+        baudCommands++;
+        if (delivered) {
+            panelBaud = (uint32_t)strtoul(cmd + 5, nullptr, 10);
+            if (panelBaud > highest) highest = panelBaud;
+        }
+    }
+
+    bool probe() {
+        probes++;
+        return transfer();
+    }
+};
+
+void test_probe_reply_matcher(void) {
+    uint32_t nonce = NextionBaud::makeNonce(12345);
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t byte = (uint8_t)(nonce >> (8 * i));
+        TEST_ASSERT_TRUE(byte >= 0x20 && byte <= 0x6F);
+    }
+
+    NextionBaud::ProbeMatcher matcher(nonce);
+    const uint8_t noise[] = {0x1A, 0xFF, 0xFF, 0xFF, 0x71, 0x00, 0x71};  // Error y 0x71 cortado
+    for (uint8_t byte : noise) TEST_ASSERT_FALSE(matcher.feed(byte));
+
+    uint8_t reply[8] = {0x71, (uint8_t)nonce, (uint8_t)(nonce >> 8), (uint8_t)(nonce >> 16),
+                        (uint8_t)(nonce >> 24), 0xFF, 0xFF, 0xFF};
+    for (uint8_t i = 1; i < 7; i++) TEST_ASSERT_FALSE(matcher.feed(reply[i]));
+    TEST_ASSERT_TRUE(matcher.feed(reply[7]));
+
+    // Otro nonce no coincide
+    reply[2] ^= 0x01;
+    for (uint8_t byte : reply) TEST_ASSERT_FALSE(matcher.feed(byte));
+}
+
+void test_cold_boot_climbs_to_highest_rate(void) {
+    FakePanel panel;
+    TEST_ASSERT_EQUAL_UINT32(921600, NextionBaud::negotiate(panel, 0));
+    TEST_ASSERT_EQUAL_UINT32(921600, panel.panelBaud);
+    TEST_ASSERT_EQUAL_UINT32(921600, panel.espBaud);
+    TEST_ASSERT_EQUAL_UINT32(1, panel.baudCommands);
+}
+
+void test_unreliable_rates_fall_back(void) {
+    FakePanel panel;
+    panel.maxReliable = 256000;
+    TEST_ASSERT_EQUAL_UINT32(256000, NextionBaud::negotiate(panel, 0));
+    TEST_ASSERT_EQUAL_UINT32(256000, panel.panelBaud);
+    TEST_ASSERT_EQUAL_UINT32(256000, panel.espBaud);
+    TEST_ASSERT_EQUAL_UINT32(921600, panel.highest);
+}
+
+void test_warm_boot_skips_negotiation(void) {
+    FakePanel panel;
+    panel.panelBaud = 512000;  // El panel no se apagó
+    TEST_ASSERT_EQUAL_UINT32(512000, NextionBaud::negotiate(panel, 512000));
+    TEST_ASSERT_EQUAL_UINT32(NextionConfig::BAUD_PROBES, panel.probes);
+    TEST_ASSERT_EQUAL_UINT32(0, panel.baudCommands);
+}
+
+void test_power_cycled_panel_goes_straight_to_saved_rate(void) {
+    FakePanel panel;
+    TEST_ASSERT_EQUAL_UINT32(512000, NextionBaud::negotiate(panel, 512000));
+    TEST_ASSERT_EQUAL_UINT32(1, panel.baudCommands);
+    TEST_ASSERT_EQUAL_UINT32(512000, panel.highest);  // Sin probar 921600
+
+    // Guardada la de arranque: tampoco se sube
+    FakePanel slow;
+    TEST_ASSERT_EQUAL_UINT32(NextionConfig::BAUD_RATE, NextionBaud::negotiate(slow, NextionConfig::BAUD_RATE));
+    TEST_ASSERT_EQUAL_UINT32(0, slow.baudCommands);
+}
+
+void test_saved_rate_no_longer_reliable(void) {
+    FakePanel panel;
+    panel.maxReliable = 230400;
+    TEST_ASSERT_EQUAL_UINT32(230400, NextionBaud::negotiate(panel, 921600));
+    TEST_ASSERT_EQUAL_UINT32(230400, panel.panelBaud);
+    TEST_ASSERT_EQUAL_UINT32(230400, panel.espBaud);
+
+    // Valor guardado inválido: se negocia como sin guardar
+    FakePanel other;
+    TEST_ASSERT_EQUAL_UINT32(921600, NextionBaud::negotiate(other, 12345));
+}
+
+void test_missing_or_lost_panel(void) {
+    FakePanel absent;
+    absent.present = false;
+    TEST_ASSERT_EQUAL_UINT32(0, NextionBaud::negotiate(absent, 0));
+    TEST_ASSERT_EQUAL_UINT32(NextionConfig::BAUD_RATE, absent.espBaud);
+
+    // Panel a una velocidad de una negociación anterior sin guardar
+    FakePanel stale;
+    stale.panelBaud = 256000;
+    TEST_ASSERT_EQUAL_UINT32(921600, NextionBaud::negotiate(stale, 0));
+
+    // Cambió de velocidad y a esa no llega nada: inalcanzable hasta apagarlo
+    FakePanel lost;
+    lost.deadBaud = 921600;
+    TEST_ASSERT_EQUAL_UINT32(0, NextionBaud::negotiate(lost, 0));
+    TEST_ASSERT_EQUAL_UINT32(NextionConfig::BAUD_RATE, lost.espBaud);
+}
+
+// Loop simulado de 1 ms: los bytes del panel pasan por feed() y update()
+// avanza un paso. Guarda lo máximo que hizo una sola llamada.
+struct RecoveryRun {
+    NextionBaud::LinkRecovery::Result result;
+    uint32_t elapsedMs;
+    uint32_t maxBaudChanges;
+    uint32_t maxWrites;
+};
+
+static RecoveryRun runRecovery(NextionBaud::LinkRecovery& recovery, FakePanel& panel, uint32_t baud) {
+    RecoveryRun run = {NextionBaud::LinkRecovery::BUSY, 0, 0, 0};
+    recovery.start(baud, 0);
+    while (run.result == NextionBaud::LinkRecovery::BUSY && run.elapsedMs < 10000) {
+        for (uint8_t i = 0; i < panel.replyLength; i++) recovery.feed(panel.reply[i]);
+        panel.replyLength = 0;
+
+        uint32_t baudChanges = panel.baudChanges;
+        uint32_t writes = panel.writes;
+        run.result = recovery.update(panel, run.elapsedMs++);
+        if (panel.baudChanges - baudChanges > run.maxBaudChanges) run.maxBaudChanges = panel.baudChanges - baudChanges;
+        if (panel.writes - writes > run.maxWrites) run.maxWrites = panel.writes - writes;
+    }
+    return run;
+}
+
+void test_panel_reset_at_runtime_reconnects(void) {
+    FakePanel panel;
+    TEST_ASSERT_EQUAL_UINT32(921600, NextionBaud::negotiate(panel, 0));
+    NextionBaud::LinkRecovery recovery;
+
+    // Enlace sano: un sondeo, sin cambiar de velocidad
+    panel.probes = 0;
+    panel.baudChanges = 0;
+    RecoveryRun run = runRecovery(recovery, panel, 921600);
+    TEST_ASSERT_EQUAL(NextionBaud::LinkRecovery::LINKED, run.result);
+    TEST_ASSERT_EQUAL_UINT32(921600, recovery.getBaud());
+    TEST_ASSERT_EQUAL_UINT32(1, panel.probes);
+    TEST_ASSERT_EQUAL_UINT32(0, panel.baudChanges);
+    TEST_ASSERT_FALSE(recovery.isActive());
+
+    // El panel se reinicia: vuelve a BAUD_RATE y el ESP32 sigue a 921600
+    panel.panelBaud = NextionConfig::BAUD_RATE;
+    panel.probes = 0;
+    panel.baudCommands = 0;
+    run = runRecovery(recovery, panel, 921600);
+    TEST_ASSERT_EQUAL(NextionBaud::LinkRecovery::LINKED, run.result);
+    TEST_ASSERT_EQUAL_UINT32(921600, recovery.getBaud());
+    TEST_ASSERT_EQUAL_UINT32(921600, panel.panelBaud);
+    TEST_ASSERT_EQUAL_UINT32(921600, panel.espBaud);
+    TEST_ASSERT_EQUAL_UINT32(1, panel.baudCommands);
+    // Sondeo fallido y después BAUD_RATE y la negociada, sin la escalera
+    TEST_ASSERT_EQUAL_UINT32(1 + 2 * NextionConfig::BAUD_PROBES, panel.probes);
+    TEST_ASSERT_TRUE(run.elapsedMs < NextionConfig::PROBE_TIMEOUT_MS + 2 * NextionConfig::BAUD_SETTLE_MS + 20);
+
+    // Cada paso es corto: un cambio de velocidad y dos comandos como mucho
+    TEST_ASSERT_TRUE(run.maxBaudChanges <= 1);
+    TEST_ASSERT_TRUE(run.maxWrites <= 2);
+
+    // Panel apagado: se recorre todo sin bloquear y el UART queda en BAUD_RATE
+    panel.present = false;
+    run = runRecovery(recovery, panel, 921600);
+    TEST_ASSERT_EQUAL(NextionBaud::LinkRecovery::LOST, run.result);
+    TEST_ASSERT_EQUAL_UINT32(NextionConfig::BAUD_RATE, panel.espBaud);
+    TEST_ASSERT_TRUE(run.maxBaudChanges <= 1);
+
+    // Nunca respondió (linkBaud = 0): aparece a BAUD_RATE y sube por la escalera
+    FakePanel late;
+    late.maxReliable = 512000;
+    run = runRecovery(recovery, late, 0);
+    TEST_ASSERT_EQUAL(NextionBaud::LinkRecovery::LINKED, run.result);
+    TEST_ASSERT_EQUAL_UINT32(512000, recovery.getBaud());
+    TEST_ASSERT_EQUAL_UINT32(512000, late.espBaud);
+    TEST_ASSERT_EQUAL_UINT32(512000, late.panelBaud);
+    TEST_ASSERT_TRUE(run.maxBaudChanges <= 2);  // Vuelta atrás: pedido a la nueva y sondeo a la anterior
+}
+
+void test_link_recovery_passes_other_bytes_to_parser(void) {
+    FakePanel panel;
+    panel.espBaud = NextionConfig::BAUD_RATE;
+    NextionBaud::LinkRecovery recovery;
+    recovery.start(NextionConfig::BAUD_RATE, 0);
+    recovery.update(panel, 0);  // Envía el sondeo
+    TEST_ASSERT_EQUAL_UINT8(8, panel.replyLength);
+
+    // Un toque que llega antes que la respuesta no es del sondeo
+    const uint8_t touch[] = {0x65, 0x01, 0x02, 0x01, 0xFF, 0xFF, 0xFF};
+    for (uint8_t byte : touch) TEST_ASSERT_FALSE(recovery.feed(byte));
+
+    for (uint8_t i = 0; i < 7; i++) TEST_ASSERT_FALSE(recovery.feed(panel.reply[i]));
+    TEST_ASSERT_TRUE(recovery.feed(panel.reply[7]));
+    TEST_ASSERT_EQUAL(NextionBaud::LinkRecovery::LINKED, recovery.update(panel, 1));
+
+    // Sin revisión en curso nada es del sondeo
+    for (uint8_t byte : panel.reply) TEST_ASSERT_FALSE(recovery.feed(byte));
+}
+
+void test_link_monitor_silence_and_timeouts(void) {
+    NextionBaud::LinkMonitor monitor;
+    monitor.reset(1000);
+    TEST_ASSERT_FALSE(monitor.needsCheck(1000 + NextionConfig::LINK_SILENCE_MS - 1));
+    TEST_ASSERT_TRUE(monitor.needsCheck(1000 + NextionConfig::LINK_SILENCE_MS));
+
+    // Un mensaje reinicia la espera
+    monitor.onMessage(4000);
+    TEST_ASSERT_FALSE(monitor.needsCheck(1000 + NextionConfig::LINK_SILENCE_MS));
+
+    // Timeouts seguidos; un mensaje entre medio los descuenta
+    for (uint8_t i = 0; i < NextionConfig::LINK_LOST_TIMEOUTS - 1; i++) monitor.onTimeout();
+    TEST_ASSERT_FALSE(monitor.needsCheck(4100));
+    monitor.onMessage(4100);
+    monitor.onTimeout();
+    TEST_ASSERT_FALSE(monitor.needsCheck(4200));
+    for (uint8_t i = 0; i < NextionConfig::LINK_LOST_TIMEOUTS - 1; i++) monitor.onTimeout();
+    TEST_ASSERT_TRUE(monitor.needsCheck(4200));
+
+    // Panel sin responder: se reintenta con otra espera
+    monitor.reset(10000, NextionConfig::LINK_RETRY_MS);
+    TEST_ASSERT_FALSE(monitor.needsCheck(10000 + NextionConfig::LINK_SILENCE_MS));
+    TEST_ASSERT_TRUE(monitor.needsCheck(10000 + NextionConfig::LINK_RETRY_MS));
+}
+
+// ========================================
+// Recepción: decodificador y consultas
+// ========================================
+
+static NextionParser parser;
+static uint32_t parsedEvents;
+
+// Devuelve el último evento completo de los bytes dados
+static const NextionParser::Event& feedBytes(const uint8_t* data, size_t len) {
+    parsedEvents = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (parser.feed(data[i])) parsedEvents++;
+    }
+    return parser.event();
+}
+
+template <size_t N>
+static const NextionParser::Event& feedBytes(const uint8_t (&data)[N]) {
+    return feedBytes(data, N);
+}
+
+void test_parser_touch_page_and_coordinates(void) {
+    parser.reset();
+    const uint8_t touch[] = {0x65, 0x02, 0x16, 0x01, 0xFF, 0xFF, 0xFF};
+    const NextionParser::Event& event = feedBytes(touch);
+    TEST_ASSERT_EQUAL_UINT32(1, parsedEvents);
+    TEST_ASSERT_EQUAL(NextionParser::EVENT_TOUCH, event.type);
+    TEST_ASSERT_EQUAL_UINT8(2, event.page);
+    TEST_ASSERT_EQUAL_UINT8(22, event.component);
+    TEST_ASSERT_EQUAL_UINT8(1, event.touch);
+
+    const uint8_t page[] = {0x66, 0x04, 0xFF, 0xFF, 0xFF};
+    TEST_ASSERT_EQUAL(NextionParser::EVENT_PAGE, feedBytes(page).type);
+    TEST_ASSERT_EQUAL_UINT8(4, parser.event().page);
+
+    const uint8_t xy[] = {0x68, 0x01, 0x2C, 0x00, 0xF0, 0x00, 0xFF, 0xFF, 0xFF};
+    TEST_ASSERT_EQUAL(NextionParser::EVENT_SLEEP_COORDINATE, feedBytes(xy).type);
+    TEST_ASSERT_EQUAL_UINT16(300, parser.event().x);
+    TEST_ASSERT_EQUAL_UINT16(240, parser.event().y);
+    TEST_ASSERT_EQUAL_UINT8(0, parser.event().touch);
+}
+
+void test_parser_numeric_data_may_contain_terminator_bytes(void) {
+    parser.reset();
+    const uint8_t minusOne[] = {0x71, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    const NextionParser::Event& event = feedBytes(minusOne);
+    TEST_ASSERT_EQUAL_UINT32(1, parsedEvents);
+    TEST_ASSERT_EQUAL(NextionParser::EVENT_NUMBER, event.type);
+    TEST_ASSERT_EQUAL_INT32(-1, event.number);
+
+    const uint8_t value[] = {0x71, 0x39, 0x30, 0x00, 0x00, 0xFF, 0xFF, 0xFF};
+    TEST_ASSERT_EQUAL_INT32(12345, feedBytes(value).number);
+    TEST_ASSERT_EQUAL_UINT32(0, parser.getStats().malformed);
+}
+
+void test_parser_string_split_across_reads(void) {
+    parser.reset();
+    const uint8_t reply[] = {0x70, 'L', 'a', 'v', 'a', 'd', 'o', 0xFF, 0xFF, 0xFF};
+    for (size_t split = 1; split < sizeof(reply); split++) {
+        feedBytes(reply, split);
+        TEST_ASSERT_EQUAL_UINT32(0, parsedEvents);
+        const NextionParser::Event& event = feedBytes(reply + split, sizeof(reply) - split);
+        TEST_ASSERT_EQUAL_UINT32(1, parsedEvents);
+        TEST_ASSERT_EQUAL(NextionParser::EVENT_STRING, event.type);
+        TEST_ASSERT_EQUAL_STRING("Lavado", event.text);
+        TEST_ASSERT_EQUAL_UINT8(6, event.length);
+    }
+
+    // Un texto vacío no deja restos del anterior
+    const uint8_t empty[] = {0x70, 0xFF, 0xFF, 0xFF};
+    TEST_ASSERT_EQUAL_STRING("", feedBytes(empty).text);
+}
+
+void test_parser_long_string_is_truncated(void) {
+    parser.reset();
+    uint8_t reply[NextionParser::CAPACITY + 20];
+    reply[0] = 0x70;
+    for (size_t i = 1; i < sizeof(reply) - 3; i++) reply[i] = 'a' + i % 26;
+    memset(reply + sizeof(reply) - 3, 0xFF, 3);
+
+    const NextionParser::Event& event = feedBytes(reply);
+    TEST_ASSERT_EQUAL_UINT32(1, parsedEvents);
+    TEST_ASSERT_TRUE(event.truncated);
+    TEST_ASSERT_EQUAL_UINT8(NextionParser::CAPACITY, event.length);
+    TEST_ASSERT_EQUAL(NextionParser::CAPACITY, strlen(event.text));
+    TEST_ASSERT_EQUAL_UINT32(1, parser.getStats().truncated);
+}
+
+void test_parser_status_codes(void) {
+    parser.reset();
+    const uint8_t startup[] = {0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x88, 0xFF, 0xFF, 0xFF};
+    feedBytes(startup, 6);
+    TEST_ASSERT_EQUAL(NextionParser::EVENT_STARTUP, parser.event().type);
+    TEST_ASSERT_EQUAL(NextionParser::EVENT_READY, feedBytes(startup + 6, 4).type);
+
+    const struct { uint8_t code; NextionParser::EventType type; } cases[] = {
+        {0x00, NextionParser::EVENT_RESULT},
+        {0x01, NextionParser::EVENT_RESULT},
+        {0x1A, NextionParser::EVENT_RESULT},
+        {0x24, NextionParser::EVENT_RESULT},
+        {0x86, NextionParser::EVENT_SLEEP},
+        {0x87, NextionParser::EVENT_WAKE},
+        {0xFE, NextionParser::EVENT_OTHER},
+    };
+    for (const auto& c : cases) {
+        const uint8_t message[] = {c.code, 0xFF, 0xFF, 0xFF};
+        const NextionParser::Event& event = feedBytes(message);
+        TEST_ASSERT_EQUAL_UINT32(1, parsedEvents);
+        TEST_ASSERT_EQUAL(c.type, event.type);
+        TEST_ASSERT_EQUAL_UINT8(c.code, event.code);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, parser.getStats().unknown);
+}
+
+void test_parser_resynchronizes(void) {
+    parser.reset();
+    // Touch cortado (falta un byte), basura desconocida y un 0x01 que sigue
+    const uint8_t stream[] = {0x65, 0x01, 0x02, 0xFF, 0xFF, 0xFF,
+                              0x55, 0x10, 0x20, 0xFF, 0xFF, 0xFF,
+                              0x01, 0xFF, 0xFF, 0xFF};
+    const NextionParser::Event& event = feedBytes(stream);
+    TEST_ASSERT_EQUAL(NextionParser::EVENT_RESULT, event.type);
+    TEST_ASSERT_EQUAL_UINT8(0x01, event.code);
+    TEST_ASSERT_EQUAL_UINT32(1, parser.getStats().unknown);
+
+    // Touch sin terminador: el byte siguiente empieza otro mensaje
+    parser.reset();
+    const uint8_t cut[] = {0x65, 0x01, 0x02, 0x01, 0x66, 0x03, 0xFF, 0xFF, 0xFF};
+    TEST_ASSERT_EQUAL(NextionParser::EVENT_PAGE, feedBytes(cut).type);
+    TEST_ASSERT_EQUAL_UINT32(1, parsedEvents);
+    TEST_ASSERT_EQUAL_UINT8(3, parser.event().page);
+    TEST_ASSERT_EQUAL_UINT32(1, parser.getStats().malformed);
+}
+
+static NextionQueryQueue queries;
+static int32_t queryNumber;
+static char queryText[16];
+static int queryCalls;
+static int queryFailures;
+
+static void onNumber(bool ok, int32_t value) {
+    queryCalls++;
+    if (!ok) queryFailures++;
+    queryNumber = value;
+}
+
+static void onText(bool ok, const char* text) {
+    queryCalls++;
+    if (!ok) queryFailures++;
+    strncpy(queryText, text, sizeof(queryText) - 1);
+}
+
+static void resetQueries() {
+    queries.reset();
+    queryNumber = 0;
+    queryText[0] = '\0';
+    queryCalls = 0;
+    queryFailures = 0;
+}
+
+void test_queries_are_answered_in_order(void) {
+    resetQueries();
+    TEST_ASSERT_TRUE(queries.pushNumber(onNumber, 0));
+    TEST_ASSERT_TRUE(queries.pushText(onText, 0));
+
+    TEST_ASSERT_TRUE(queries.onNumber(-42));
+    TEST_ASSERT_EQUAL_INT32(-42, queryNumber);
+    TEST_ASSERT_TRUE(queries.onText("Fria"));
+    TEST_ASSERT_EQUAL_STRING("Fria", queryText);
+    TEST_ASSERT_EQUAL(2, queryCalls);
+    TEST_ASSERT_EQUAL(0, queryFailures);
+
+    // Sin consulta pendiente (prints del HMI): no es de nadie
+    TEST_ASSERT_FALSE(queries.onNumber(7));
+    TEST_ASSERT_EQUAL(2, queryCalls);
+}
+
+void test_query_wrong_type_and_timeout_fail(void) {
+    resetQueries();
+    queries.pushNumber(onNumber, 0);
+    TEST_ASSERT_TRUE(queries.onText("x"));
+    TEST_ASSERT_EQUAL(1, queryFailures);
+
+    queries.pushText(onText, 1000);
+    queries.pushNumber(onNumber, 2000);
+    queries.checkTimeout(1000 + NextionConfig::QUERY_TIMEOUT_US - 1);
+    TEST_ASSERT_EQUAL(1, queryFailures);
+    queries.checkTimeout(2000 + NextionConfig::QUERY_TIMEOUT_US);
+    TEST_ASSERT_EQUAL(3, queryFailures);
+    TEST_ASSERT_FALSE(queries.hasPending());
+    TEST_ASSERT_EQUAL_UINT32(2, queries.getStats().timeouts);
+
+    for (uint8_t i = 0; i < NextionQueryQueue::CAPACITY; i++) {
+        TEST_ASSERT_TRUE(queries.pushNumber(onNumber, 0));
+    }
+    TEST_ASSERT_FALSE(queries.canPush());
+    TEST_ASSERT_FALSE(queries.pushNumber(onNumber, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, queries.getStats().rejected);
+}
+
+// ========================================
+// BENCHMARK: DECODIFICACIÓN DE UNA SESIÓN GRABADA
+// ========================================
+
+// Bytes recibidos del panel en una sesión: arranque, selección de programa,
+// ejecución con consultas get (bkcmd=3), sleep/wake y un error
+static const uint8_t RECORDED[] = {
+    0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF,                          // Encendido
+    0x88, 0xFF, 0xFF, 0xFF,                                      // Listo
+    0x01, 0xFF, 0xFF, 0xFF,                                      // bkcmd=3
+    0x01, 0xFF, 0xFF, 0xFF,                                      // page 1
+    0x65, 0x01, 0x02, 0x01, 0xFF, 0xFF, 0xFF,                    // P23 presionado
+    0x65, 0x01, 0x02, 0x00, 0xFF, 0xFF, 0xFF,                    // P23 soltado
+    0x01, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF,              // bco de programas
+    0x65, 0x01, 0x16, 0x01, 0xFF, 0xFF, 0xFF,                    // Comenzar
+    0x65, 0x01, 0x16, 0x00, 0xFF, 0xFF, 0xFF,
+    0x01, 0xFF, 0xFF, 0xFF,                                      // page 2
+    0x66, 0x02, 0xFF, 0xFF, 0xFF,                                // sendme
+    0x71, 0x2C, 0x01, 0x00, 0x00, 0xFF, 0xFF, 0xFF,              // get n0.val = 300
+    0x71, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,              // get = -1
+    0x70, 'L', 'l', 'e', 'n', 'a', 'd', 'o', 0xFF, 0xFF, 0xFF,   // get fase_ejec.txt
+    0x70, '0', '3', ':', '2', '5', 0xFF, 0xFF, 0xFF,             // get tiempo_ejec.txt
+    0x01, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF,
+    0x01, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF,
+    0x86, 0xFF, 0xFF, 0xFF,                                      // Dormido
+    0x68, 0x00, 0x64, 0x00, 0x50, 0x01, 0xFF, 0xFF, 0xFF,        // Toque dormido
+    0x87, 0xFF, 0xFF, 0xFF,                                      // Despierto
+    0x67, 0x01, 0x2C, 0x00, 0xF0, 0x01, 0xFF, 0xFF, 0xFF,        // Coordenadas
+    0x1A, 0xFF, 0xFF, 0xFF,                                      // Variable inválida
+    0x24, 0xFF, 0xFF, 0xFF,                                      // Buffer lleno
+    0x65, 0x02, 0x15, 0x01, 0xFF, 0xFF, 0xFF,                    // Pausa
+    0x65, 0x02, 0x15, 0x00, 0xFF, 0xFF, 0xFF,
+};
+static constexpr uint32_t RECORDED_MESSAGES = 28;
+
+// Decodificación anterior: copia a un buffer de 32 bytes, memset por
+// mensaje, corte en cualquier FF FF FF y solo eventos touch
+struct LegacyParser {
+    char rxBuffer[32];
+    uint8_t rxIndex = 0;
+    uint8_t ffCount = 0;
+    uint32_t touches = 0;
+
+    LegacyParser() { memset(rxBuffer, 0, sizeof(rxBuffer)); }
+
+    void feed(uint8_t byte) {
+        if (byte == 0xFF) {
+            if (++ffCount >= 3) {
+                if (rxIndex >= 4 && rxBuffer[0] == 0x65) touches += (uint8_t)rxBuffer[2];
+                rxIndex = 0;
+                memset(rxBuffer, 0, sizeof(rxBuffer));
+                ffCount = 0;
+            }
+        } else {
+            ffCount = 0;
+            if (rxIndex < sizeof(rxBuffer) - 1) rxBuffer[rxIndex++] = byte;
+        }
+    }
+};
+
+void test_recorded_stream_decodes(void) {
+    parser.reset();
+    uint32_t counts[NextionParser::EVENT_OTHER + 1] = {};
+    int32_t numbers = 0;
+    for (uint8_t byte : RECORDED) {
+        if (parser.feed(byte)) {
+            const NextionParser::Event& event = parser.event();
+            counts[event.type]++;
+            if (event.type == NextionParser::EVENT_NUMBER) numbers += event.number;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(RECORDED_MESSAGES, parser.getStats().messages);
+    TEST_ASSERT_EQUAL_UINT32(0, parser.getStats().malformed);
+    TEST_ASSERT_EQUAL_UINT32(6, counts[NextionParser::EVENT_TOUCH]);
+    TEST_ASSERT_EQUAL_UINT32(1, counts[NextionParser::EVENT_PAGE]);
+    TEST_ASSERT_EQUAL_UINT32(1, counts[NextionParser::EVENT_COORDINATE]);
+    TEST_ASSERT_EQUAL_UINT32(1, counts[NextionParser::EVENT_SLEEP_COORDINATE]);
+    TEST_ASSERT_EQUAL_UINT32(2, counts[NextionParser::EVENT_STRING]);
+    TEST_ASSERT_EQUAL_UINT32(2, counts[NextionParser::EVENT_NUMBER]);
+    TEST_ASSERT_EQUAL_UINT32(1, counts[NextionParser::EVENT_SLEEP]);
+    TEST_ASSERT_EQUAL_UINT32(1, counts[NextionParser::EVENT_WAKE]);
+    TEST_ASSERT_EQUAL_UINT32(1, counts[NextionParser::EVENT_READY]);
+    TEST_ASSERT_EQUAL_UINT32(1, counts[NextionParser::EVENT_STARTUP]);
+    TEST_ASSERT_EQUAL_UINT32(11, counts[NextionParser::EVENT_RESULT]);
+    TEST_ASSERT_EQUAL_INT32(299, numbers);
+}
+
+void test_benchmark_recorded_stream(void) {
+    static constexpr uint32_t PASSES = 20000;
+    static constexpr double UART_921600_BPS = 921600.0 / 10.0;  // 8N1
+
+    LegacyParser legacy;
+    parser.reset();
+    uint32_t touches = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < PASSES; pass++) {
+        for (uint8_t byte : RECORDED) legacy.feed(byte);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < PASSES; pass++) {
+        for (uint8_t byte : RECORDED) {
+            if (parser.feed(byte) && parser.event().type == NextionParser::EVENT_TOUCH) {
+                touches += parser.event().component;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double bytes = (double)sizeof(RECORDED) * PASSES;
+    double legacyNs = std::chrono::duration<double, std::nano>(middle - start).count() / bytes;
+    double parserNs = std::chrono::duration<double, std::nano>(end - middle).count() / bytes;
+    printf("[BENCH] Sesión grabada (%u B, %u mensajes) x %u:\n",
+           (unsigned)sizeof(RECORDED), RECORDED_MESSAGES, PASSES);
+    printf("  copia + memset, solo touch:     %6.2f ns por byte\n", legacyNs);
+    printf("  incremental, todos los códigos: %6.2f ns por byte (%.0f MB/s, %.4f%% de CPU a 921600)\n",
+           parserNs, 1000.0 / parserNs, parserNs * UART_921600_BPS / 1e7);
+
+    // Mismos touch decodificados; el -1 de la sesión no desarma los siguientes
+    TEST_ASSERT_EQUAL_UINT32(legacy.touches, touches);
+    TEST_ASSERT_EQUAL_UINT32(RECORDED_MESSAGES * PASSES, parser.getStats().messages);
+    TEST_ASSERT_EQUAL_UINT32(0, parser.getStats().malformed);
+
+    // Holgura enorme frente al UART más rápido
+    TEST_ASSERT_TRUE(parserNs * UART_921600_BPS < 1e9 / 100);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_unchanged_value_is_skipped);
+    RUN_TEST(test_changed_value_is_sent);
+    RUN_TEST(test_page_change_clears_shadow);
+    RUN_TEST(test_touch_forgets_only_val_attributes);
+    RUN_TEST(test_commands_without_key_always_sent);
+    RUN_TEST(test_tsw_and_vis_keys);
+    RUN_TEST(test_stats_are_kept_per_page);
+    RUN_TEST(test_full_shadow_still_sends);
+    RUN_TEST(test_edit_keypress_sends_only_changed_field);
+    RUN_TEST(test_frame_packs_terminated_commands);
+    RUN_TEST(test_atomic_frame_wraps_in_ref_stop_star);
+    RUN_TEST(test_empty_atomic_frame_sends_nothing);
+    RUN_TEST(test_full_frame_drains_and_keeps_ref_star);
+    RUN_TEST(test_execution_page_fits_one_frame);
+    RUN_TEST(test_prefixes_are_built_at_compile_time);
+    RUN_TEST(test_integer_writers);
+    RUN_TEST(test_fixed_point_and_time_writers);
+    RUN_TEST(test_writers_match_snprintf);
+    RUN_TEST(test_writer_flags_overflow);
+    RUN_TEST(test_reserved_command_only_kept_on_commit);
+    RUN_TEST(test_benchmark_execution_update);
+    RUN_TEST(test_plain_frames_are_matched_in_order);
+    RUN_TEST(test_acked_command_between_plain_frames);
+    RUN_TEST(test_permanent_error_drops_without_retry);
+    RUN_TEST(test_buffer_overflow_is_retried);
+    RUN_TEST(test_newer_command_supersedes_retry);
+    RUN_TEST(test_timeout_resynchronizes);
+    RUN_TEST(test_full_queue_rejects_acked);
+    RUN_TEST(test_plain_frames_wait_for_room_behind_acked);
+    RUN_TEST(test_latency_percentiles);
+    RUN_TEST(test_probe_reply_matcher);
+    RUN_TEST(test_cold_boot_climbs_to_highest_rate);
+    RUN_TEST(test_unreliable_rates_fall_back);
+    RUN_TEST(test_warm_boot_skips_negotiation);
+    RUN_TEST(test_power_cycled_panel_goes_straight_to_saved_rate);
+    RUN_TEST(test_saved_rate_no_longer_reliable);
+    RUN_TEST(test_missing_or_lost_panel);
+    RUN_TEST(test_panel_reset_at_runtime_reconnects);
+    RUN_TEST(test_link_recovery_passes_other_bytes_to_parser);
+    RUN_TEST(test_link_monitor_silence_and_timeouts);
+    RUN_TEST(test_parser_touch_page_and_coordinates);
+    RUN_TEST(test_parser_numeric_data_may_contain_terminator_bytes);
+    RUN_TEST(test_parser_string_split_across_reads);
+    RUN_TEST(test_parser_long_string_is_truncated);
+    RUN_TEST(test_parser_status_codes);
+    RUN_TEST(test_parser_resynchronizes);
+    RUN_TEST(test_queries_are_answered_in_order);
+    RUN_TEST(test_query_wrong_type_and_timeout_fail);
+    RUN_TEST(test_recorded_stream_decodes);
+    RUN_TEST(test_benchmark_recorded_stream);
+
+    return UNITY_END();
+}
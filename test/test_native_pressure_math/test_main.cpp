@@ -0,0 +1,159 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <HX710B.h>
+#include "PressureMath.h"
+
+// ========================================
+// TESTS NATIVOS: RUTA ENTERA VS RUTA FLOAT
+// ========================================
+
+static constexpr int32_t RAW_MIN = -(1L << 23);
+static constexpr int32_t RAW_MAX = (1L << 23) - 1;
+
+HX710B sensor;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Copia de SensorManager::calculateWaterLevel() anterior (ruta float)
+static uint8_t legacyWaterLevel(long pressure) {
+    float pressureFloat = (float)(pressure - SensorConfig::PRESSURE_OFFSET);
+
+    if (pressureFloat < SensorConfig::PRESSURE_LEVEL_1) {
+        return 0;
+    }
+    if (pressureFloat < SensorConfig::PRESSURE_LEVEL_2) {
+        float p = (pressureFloat - SensorConfig::PRESSURE_LEVEL_1) /
+                  (SensorConfig::PRESSURE_LEVEL_2 - SensorConfig::PRESSURE_LEVEL_1);
+        uint8_t level = (uint8_t)(1 + p);
+        return (level < 1) ? 1 : ((level > 2) ? 2 : level);
+    }
+    if (pressureFloat < SensorConfig::PRESSURE_LEVEL_3) {
+        float p = (pressureFloat - SensorConfig::PRESSURE_LEVEL_2) /
+                  (SensorConfig::PRESSURE_LEVEL_3 - SensorConfig::PRESSURE_LEVEL_2);
+        uint8_t level = (uint8_t)(2 + p);
+        return (level < 2) ? 2 : ((level > 3) ? 3 : level);
+    }
+    if (pressureFloat < SensorConfig::PRESSURE_LEVEL_4) {
+        float p = (pressureFloat - SensorConfig::PRESSURE_LEVEL_3) /
+                  (SensorConfig::PRESSURE_LEVEL_4 - SensorConfig::PRESSURE_LEVEL_3);
+        uint8_t level = (uint8_t)(3 + p);
+        return (level < 3) ? 3 : ((level > 4) ? 4 : level);
+    }
+    return 4;
+}
+
+static long legacyPascal(int32_t raw) {
+    return (long)sensor.to_pascal(raw);
+}
+
+// ========================================
+// TESTS
+// ========================================
+
+void test_reference_matches_library() {
+    // pascalFromRawFloat() debe reproducir HX710B::to_pascal() bit a bit
+    for (int32_t raw = RAW_MIN; raw <= RAW_MAX; raw += 997) {
+        TEST_ASSERT_EQUAL(legacyPascal(raw), PressureMath::pascalFromRawFloat(raw));
+    }
+}
+
+void test_level_matches_float_path_full_range() {
+    const PressureMath::LevelTable& table = PressureMath::DEFAULT_LEVEL_TABLE;
+    uint32_t mismatches = 0;
+    int32_t firstMismatch = 0;
+
+    for (int32_t raw = RAW_MIN; raw <= RAW_MAX; raw++) {
+        uint8_t expected = legacyWaterLevel(legacyPascal(raw));
+        if (PressureMath::levelFromRaw(raw, table) != expected) {
+            if (mismatches++ == 0) firstMismatch = raw;
+        }
+    }
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "%u diferencias de nivel (primera en raw=%ld)",
+             (unsigned)mismatches, (long)firstMismatch);
+    TEST_ASSERT_TRUE_MESSAGE(mismatches == 0, msg);
+}
+
+void test_pascal_within_one_of_float_path() {
+    // En el rango de trabajo (presión positiva) la ruta Q21 difiere como mucho 1 Pa
+    int32_t rawZero = PressureMath::rawThresholdForPascal(1);
+    for (int32_t raw = rawZero; raw <= RAW_MAX; raw++) {
+        long diff = PressureMath::pascalFromRaw(raw) - legacyPascal(raw);
+        if (diff < -1 || diff > 1) {
+            TEST_ASSERT_INT_WITHIN(1, legacyPascal(raw), PressureMath::pascalFromRaw(raw));
+        }
+    }
+}
+
+void test_thresholds_are_exact_boundaries() {
+    const PressureMath::LevelTable& table = PressureMath::DEFAULT_LEVEL_TABLE;
+    for (uint8_t i = 0; i < PressureMath::LEVEL_COUNT; i++) {
+        TEST_ASSERT_EQUAL(i + 1, legacyWaterLevel(legacyPascal(table.raw[i])));
+        TEST_ASSERT_EQUAL(i, legacyWaterLevel(legacyPascal(table.raw[i] - 1)));
+    }
+}
+
+void test_pascal_delta_shifts_pascal() {
+    // La corrección de cero desplaza la presión entera en esos Pa (±1 por redondeo)
+    int32_t raw = PressureMath::DEFAULT_LEVEL_TABLE.raw[0];
+    for (int32_t pa = -60; pa <= 60; pa++) {
+        int32_t shifted = raw + PressureMath::rawFromPascalDelta(pa);
+        TEST_ASSERT_INT_WITHIN(1, PressureMath::pascalFromRaw(raw) + pa,
+                               PressureMath::pascalFromRaw(shifted));
+    }
+}
+
+void test_ads1115_pga_covers_transducer_span() {
+    // 200 mV + 450 mV/kPa x 4 kPa = 2000 mV: PGA ±2.048 V, no ±4.096 V
+    TEST_ASSERT_EQUAL(2000, PressureMath::ADS1115_MAX_MV);
+    TEST_ASSERT_EQUAL(2048, PressureMath::ADS1115_FSR_MV);
+    TEST_ASSERT_EQUAL(512, PressureMath::ads1115FsrMv(300));
+    TEST_ASSERT_EQUAL(4096, PressureMath::ads1115FsrMv(2049));
+
+    // El final del span entra en el ADS1115 y queda en 2^22
+    constexpr int32_t spanCode = (int32_t)PressureMath::ADS1115_MAX_MV * 32768 / PressureMath::ADS1115_FSR_MV;
+    TEST_ASSERT_TRUE(spanCode < INT16_MAX);
+    TEST_ASSERT_INT_WITHIN(300, PressureMath::ADS1115_SPAN_RAW, PressureMath::rawFromAds1115((int16_t)spanCode));
+    TEST_ASSERT_INT_WITHIN(1, PressureMath::PASCAL_ZERO + 250,
+                           PressureMath::pascalFromRaw(PressureMath::rawFromAds1115((int16_t)spanCode)));
+}
+
+void test_ads1115_codes_map_to_hx710b_scale() {
+    // 16 códigos por mV con PGA ±2.048 V; el transductor da ADS1115_ZERO_MV a 0 Pa
+    constexpr int16_t CODES_PER_MV = 32768 / PressureMath::ADS1115_FSR_MV;
+    constexpr int16_t zeroCode = SensorConfig::ADS1115_ZERO_MV * CODES_PER_MV;
+    TEST_ASSERT_EQUAL_INT32(0, PressureMath::rawFromAds1115(zeroCode));
+    TEST_ASSERT_EQUAL_INT32(PressureMath::PASCAL_ZERO,
+                            PressureMath::pascalFromRaw(PressureMath::rawFromAds1115(zeroCode)));
+
+    // +400 Pa = +180 mV con 450 mV/kPa: un décimo del span, 25 Pa en la escala del HX710B
+    int16_t code = zeroCode + 400 * SensorConfig::ADS1115_MV_PER_KPA / 1000 * CODES_PER_MV;
+    TEST_ASSERT_INT_WITHIN(1, PressureMath::PASCAL_ZERO + 25,
+                           PressureMath::pascalFromRaw(PressureMath::rawFromAds1115(code)));
+
+    // Monótona y dentro del rango de 24 bits del HX710B sin saturar
+    int32_t previous = PressureMath::rawFromAds1115(INT16_MIN);
+    TEST_ASSERT_TRUE(previous > -(1L << 23));
+    for (int32_t c = INT16_MIN + 1; c <= INT16_MAX; c++) {
+        int32_t raw = PressureMath::rawFromAds1115((int16_t)c);
+        TEST_ASSERT_TRUE(raw >= previous);
+        previous = raw;
+    }
+    TEST_ASSERT_TRUE(previous < (1L << 23) - 1);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_reference_matches_library);
+    RUN_TEST(test_level_matches_float_path_full_range);
+    RUN_TEST(test_pascal_within_one_of_float_path);
+    RUN_TEST(test_thresholds_are_exact_boundaries);
+    RUN_TEST(test_pascal_delta_shifts_pascal);
+    RUN_TEST(test_ads1115_pga_covers_transducer_span);
+    RUN_TEST(test_ads1115_codes_map_to_hx710b_scale);
+
+    return UNITY_END();
+}